@@ -0,0 +1,67 @@
+// Microbenchmarks for the multi-word arithmetic kernels in
+// src/base/bits/word_arith.h. Prints the time per operation for schoolbook
+// and Karatsuba multiplication, as well as for long division, at a range of
+// operand widths. See README.txt for build instructions and results.
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "src/base/bits/bits.h"
+
+using namespace cascade;
+using namespace std;
+
+using Word = uint64_t;
+using Arith = WordArith<uint64_t, __uint128_t>;
+
+template <typename F>
+double time_ns(F f) {
+  size_t iters = 1;
+  while (true) {
+    const auto begin = chrono::steady_clock::now();
+    for (size_t i = 0; i < iters; ++i) {
+      f();
+    }
+    const auto end = chrono::steady_clock::now();
+    const auto ns = chrono::duration_cast<chrono::nanoseconds>(end-begin).count();
+    if (ns > 100000000) {
+      return double(ns) / iters;
+    }
+    iters *= 2;
+  }
+}
+
+int main() {
+  mt19937_64 rng(0);
+
+  cout << setw(6) << "words" << setw(8) << "bits" 
+       << setw(12) << "mul_sb" << setw(12) << "mul_ka" 
+       << setw(12) << "low_sb" << setw(12) << "low_ka" 
+       << setw(12) << "divmod" << endl;
+
+  for (size_t n : {2, 4, 8, 16, 24, 32, 48, 64, 96, 128, 160, 192, 256}) {
+    vector<Word> a(n), b(n), q(n), r(2*n);
+    for (size_t i = 0; i < n; ++i) {
+      a[i] = rng();
+      b[i] = rng();
+    }
+    vector<Word> d(b.begin(), b.begin() + (n+1)/2);
+    d.resize(n, 0);
+
+    const auto mul_sb = time_ns([&]{Arith::mul_schoolbook(a.data(), b.data(), r.data(), n);});
+    const auto mul_ka = time_ns([&]{Arith::mul_karatsuba(a.data(), b.data(), r.data(), n);});
+    const auto low_sb = time_ns([&]{Arith::mul_low_schoolbook(a.data(), b.data(), r.data(), n);});
+    const auto low_ka = time_ns([&]{Arith::mul_low_karatsuba(a.data(), b.data(), r.data(), n);});
+    const auto div = time_ns([&]{Arith::divmod(a.data(), d.data(), q.data(), r.data(), n);});
+
+    cout << fixed << setprecision(0)
+         << setw(6) << n << setw(8) << 64*n 
+         << setw(12) << mul_sb << setw(12) << mul_ka
+         << setw(12) << low_sb << setw(12) << low_ka 
+         << setw(12) << div << endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,12 @@
+// This march file is identical to minimal, except that the root module is
+// compiled to native code. Only logic is supported by the native compiler, so
+// programs which instantiate standard library components other than the
+// clock should use native_jit instead.
+
+include data/stdlib/stdlib.v;
+
+(*__target="native", __loc="runtime"*)
+Root root();
+
+(*__target="sw", __loc="runtime"*)                    
+Clock clock();
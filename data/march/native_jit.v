@@ -0,0 +1,11 @@
+// This march file uses software logic while native code is being generated
+// for the root module in the background. Native code is produced by the host
+// c++ compiler; modules which can't be lowered stay in software.
+
+include data/stdlib/stdlib.v;
+
+(*__target="sw", __target2="native", __loc="runtime"*)
+Root root();
+
+(*__target="sw", __loc="runtime"*)                    
+Clock clock();
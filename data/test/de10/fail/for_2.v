@@ -0,0 +1,8 @@
+module M(input wire clk, output wire[7:0] y);
+  reg[7:0] r = 0;
+  integer i;
+  always @(posedge clk) begin
+    for (i = 0; i < 4; i = i + 1) r <= r + 1;
+  end
+  assign y = r;
+endmodule
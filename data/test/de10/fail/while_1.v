@@ -0,0 +1,7 @@
+module M(input wire clk, output wire[7:0] y);
+  reg[7:0] r = 0;
+  always @(posedge clk) begin
+    while (r < 4) r = r + 1;
+  end
+  assign y = r;
+endmodule
@@ -0,0 +1,16 @@
+module M(input wire clk, output wire[7:0] y);
+  localparam N = 4;
+  reg[7:0] r = 0;
+  integer i;
+  integer j;
+  always @(posedge clk) begin
+    for (i = 0; i < N; i = i + 1) begin
+      for (j = i; j < N; j = j + 1) begin
+        r = r + j;
+      end
+      repeat (i) r = r + 1;
+    end
+    repeat (N) r = r - 1;
+  end
+  assign y = r;
+endmodule
@@ -0,0 +1,20 @@
+reg[31:0] n = 0;
+reg[31:0] t = 0;
+
+// This process is still waiting on a delay when the jit handoff takes place.
+// If it isn't resumed by the new engine, the clock will end the program.
+initial begin
+  repeat (1000) begin
+    #1000 n = n + 1;
+  end
+  $write(n);
+  $finish;
+end
+
+always @(posedge clock.val) begin
+  t <= t + 1;
+  if (t == 2000000) begin
+    $write("timeout");
+    $finish;
+  end
+end
@@ -0,0 +1,7 @@
+localparam x = 256'h 1234567890abcdeffedcba09876543210f1e2d3c4b5a69788796a5b4c3d2e1f0;
+localparam y = 256'h 3a5a5a5a5a5a5a5a55a5a5a5a5a5a5a5b;
+
+initial begin
+  $write("%h", x%y);
+  $finish;
+end
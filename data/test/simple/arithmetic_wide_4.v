@@ -0,0 +1,7 @@
+localparam x = 256'd 3;
+localparam y = 256'd 200;
+
+initial begin
+  $write("%h", x**y);
+  $finish;
+end
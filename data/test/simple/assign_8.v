@@ -0,0 +1,27 @@
+// Continuous assigns built from a mix of operators, which are re-evaluated
+// as their inputs change from one clock tick to the next.
+
+reg[7:0] a = 8'h0f;
+reg[3:0] b = 4'h3;
+reg[1:0] i = 0;
+reg[7:0] m[3:0];
+reg[3:0] COUNT = 0;
+
+wire[15:0] w1 = (a > b) ? {a, b, 4'h0} : {2{a}};
+wire[7:0] w2 = {2{b}} ^ a;
+wire[3:0] w3 = a[5:2] + b;
+wire[7:0] w4 = m[i] + m[2];
+wire w5 = &a[3:0] | (b == 4'h0);
+
+always @(posedge clock.val) begin
+  m[COUNT[1:0]] <= COUNT + 1;
+  a <= a << 1;
+  b <= b - 1;
+  i <= i + 1;
+  COUNT <= COUNT + 1;
+
+  $write("%h %h %h %h %h ", w1, w2, w3, w4, w5);
+  if (COUNT == 5) begin
+    $finish;
+  end
+end
@@ -0,0 +1,29 @@
+// A continuous assign in one module which drives an always @* block in
+// another. When the modules aren't inlined, the assign has to be settled
+// even if its module has no other work left in the time step.
+
+module P(x, y);
+  input wire[3:0] x;
+  output wire[3:0] y;
+  assign y = x + 1;
+endmodule
+
+module Q(a, b);
+  input wire[3:0] a;
+  input wire[3:0] b;
+  always @(*) begin
+    $write("%h%h ", a, b);
+  end
+endmodule
+
+reg[3:0] COUNT = 0;
+wire[3:0] y;
+P p(COUNT, y);
+Q q(COUNT, y);
+
+always @(posedge clock.val) begin
+  COUNT <= COUNT + 1;
+  if (COUNT == 4) begin
+    $finish;
+  end
+end
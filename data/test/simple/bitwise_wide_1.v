@@ -0,0 +1,7 @@
+localparam x = 256'h 1234567890abcdeffedcba09876543210f1e2d3c4b5a69788796a5b4c3d2e1f0;
+localparam y = 256'h deadbeefcafebabe0123456789abcdeffedcba98765432100badf00ddeadc0de;
+
+initial begin
+  $write("%h %h %h %h", x ~^ y, x << 70, y >> 130, ^y);
+  $finish;
+end
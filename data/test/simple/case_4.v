@@ -0,0 +1,30 @@
+reg[127:0] w = 128'h10000000000000001;
+reg[3:0] x = 3;
+reg[3:0] y = 3;
+
+initial begin
+  // Selectors wider than 64 bits aren't truncated
+  case (w)
+    1: $write("a");
+    128'h10000000000000001: $write("b");
+    default: $write("c");
+  endcase
+  // Default items only match if nothing else does, and non-constant items
+  // take priority over the constant items that follow them
+  case (x)
+    default: $write("d");
+    y: $write("e");
+    3: $write("f");
+  endcase
+  case (x)
+    4'd5, 4'd6: $write("g");
+    y+1: $write("h");
+    4'd3: $write("i");
+  endcase
+  // Nothing happens if nothing matches
+  case (x)
+    4'd7: $write("j");
+  endcase
+  $write("k");
+  $finish;
+end
@@ -0,0 +1,44 @@
+localparam signed[3:0] P = -1;
+reg signed[3:0] s = -1;
+reg signed[7:0] t = -1;
+reg[3:0] u = 4'hf;
+
+initial begin
+  // The selector and items are sign extended to a common width if they're
+  // all signed. This is true whether or not the selector is constant.
+  case (P)
+    8'sb11111111: $write("a");
+    default: $write("b");
+  endcase
+  case (s)
+    8'sb11111111: $write("c");
+    default: $write("d");
+  endcase
+  // A single unsigned item makes the comparison unsigned for every item
+  case (s)
+    8'sb11111111: $write("e");
+    8'b00001111: $write("f");
+    default: $write("g");
+  endcase
+  case (P)
+    8'sb11111111: $write("h");
+    8'b00001111: $write("i");
+    default: $write("j");
+  endcase
+  // And so does an unsigned selector
+  case (u)
+    -1: $write("k");
+    default: $write("l");
+  endcase
+  // Unsized items are 32 bits wide, and non-constant items are extended too
+  case (s)
+    -1: $write("m");
+    default: $write("n");
+  endcase
+  case (s)
+    4'sd7: $write("o");
+    t: $write("p");
+    default: $write("q");
+  endcase
+  $finish;
+end
@@ -0,0 +1,33 @@
+// Expressions which are candidates for constant folding and strength
+// reduction. Rewrites which would change the width or sign of an expression
+// must not be performed.
+
+localparam K = 4;
+localparam[7:0] M = 8'hff;
+
+reg[7:0] a = 8'h93;
+reg signed[7:0] s = -8'sd6;
+
+wire[7:0] w1 = {a * 8'd4};
+wire[31:0] w2 = {a * K};
+wire[7:0] w3 = a / 8'd8;
+wire[7:0] w4 = a % 16;
+wire[7:0] w5 = s % 8'sd4;
+wire[7:0] w6 = (a & M) | 8'h0;
+wire[7:0] w7 = s / 8'sd2;
+wire[7:0] w8 = (s * 8'sd2) >>> 0;
+
+initial begin
+  $write("%h %h %h %h %h %h %h %h ", w1, w2, w3, w4, w5, w6, w7, w8);
+  case (K)
+    2: $write("no");
+    K: begin
+      if (K > 8) 
+        $write("no");
+      else
+        $write("%h", (K * 2) % 3);
+    end
+    default: $write("no");
+  endcase
+  $finish;
+end
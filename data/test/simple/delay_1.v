@@ -0,0 +1,7 @@
+initial begin
+  #0 $write("1");
+  #10 $write("2");
+  #300 $write("3");
+  #1 $write("4");
+  $finish;
+end
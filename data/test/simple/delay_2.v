@@ -0,0 +1,13 @@
+reg[3:0] x = 0;
+always begin
+  #2 x = x + 1;
+end
+initial begin
+  #5 $write(x);
+  #4 $write(x);
+  fork
+    #2 $write(x);
+    #4 $write(x);
+  join
+  $finish;
+end
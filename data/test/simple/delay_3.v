@@ -0,0 +1,5 @@
+initial begin
+  #1000000000 $write("1");
+  #1000000000 $write("2");
+  $finish;
+end
@@ -0,0 +1,9 @@
+initial begin
+  fork
+    #300 $write("3");
+    #600 $write("4");
+    #100 $write("1");
+    #257 $write("2");
+  join
+  $finish;
+end
@@ -0,0 +1,20 @@
+reg[7:0] mem[15:0];
+reg[4:0] i;
+reg[7:0] sum = 0;
+
+// Loops without timing control run to completion in one step
+initial begin
+  for (i = 0; i < 16; i = i + 1) 
+    mem[i] = i;
+  for (i = 0; i < 16; i = i + 1)
+    sum = sum + mem[i];
+  $write("%d", sum);
+end
+
+// Loops with timing control are suspended and resumed
+reg[3:0] j;
+initial begin
+  for (j = 0; j < 3; j = j + 1) 
+    @(posedge clock.val) $write("%d", j);
+  $finish;
+end
@@ -0,0 +1,29 @@
+// Combinational always blocks, declared out of order and chained together
+// through a continuous assign, feeding a clocked counter.
+
+reg[3:0] COUNT = 0;
+reg[3:0] y;
+reg[3:0] z;
+wire[3:0] w = y + 1;
+
+always @* begin
+  case (w)
+    4'd1: z = 4'd9;
+    4'd2: z = 4'd8;
+    default: z = w;
+  endcase
+end
+
+always @* begin
+  if (COUNT[0]) 
+    y = COUNT;
+  else 
+    y = 0;
+end
+
+always @(posedge clock.val) begin
+  $write("%d", z);
+  COUNT <= COUNT + 1;
+  if (COUNT == 5) 
+    $finish;
+end
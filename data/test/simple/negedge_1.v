@@ -0,0 +1,12 @@
+reg[3:0] p = 0;
+reg[3:0] n = 0;
+always @(posedge clock.val) begin
+  p <= p + 1;
+end
+always @(negedge clock.val) begin
+  n <= n + 1;
+  if (n == 3) begin
+    $write("%d%d", p, n);
+    $finish;
+  end
+end
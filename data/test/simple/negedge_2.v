@@ -0,0 +1,9 @@
+wire inv = !clock.val;
+reg[3:0] n = 0;
+always @(posedge inv) begin
+  n <= n + 1;
+  if (n == 3) begin
+    $write("%d", n);
+    $finish;
+  end
+end
@@ -0,0 +1,16 @@
+reg[3:0] x = 0;
+reg[3:0] y = 0;
+reg[3:0] COUNT = 0;
+
+always @(posedge clock.val) begin
+  // The first write is overwritten, the last one is applied on top
+  x[3] <= 0;
+  x <= COUNT;
+  x[3] <= 1;
+  y <= x;
+
+  $write("%d %d ", x, y);
+  COUNT <= COUNT + 1;
+  if (COUNT == 3)
+    $finish;
+end
@@ -0,0 +1,27 @@
+// Several engines which all write in the same time step. However they're
+// scheduled, their output should appear in the same order every time.
+
+module Writer(clk, id, count);
+  input wire clk;
+  input wire[3:0] id;
+  input wire[3:0] count;
+
+  always @(posedge clk) begin
+    $write("%h%h", id, count);
+  end
+endmodule
+
+reg[3:0] COUNT = 0;
+
+Writer w0(clock.val, 4'd0, COUNT);
+Writer w1(clock.val, 4'd1, COUNT);
+Writer w2(clock.val, 4'd2, COUNT);
+Writer w3(clock.val, 4'd3, COUNT);
+
+always @(posedge clock.val) begin
+  COUNT <= COUNT + 1;
+  $write("|");
+  if (COUNT == 7) begin
+    $finish;
+  end
+end
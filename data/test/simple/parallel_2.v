@@ -0,0 +1,50 @@
+// A combinational path through several engines, alongside engines which
+// don't share any variables with the rest of the program and can run in
+// parallel with it. Their output still has to interleave the same way it
+// would if everything ran serially.
+
+module Inc(x, y);
+  input wire[3:0] x;
+  output wire[3:0] y;
+  assign y = x + 1;
+endmodule
+
+module Show(a, b, c);
+  input wire[3:0] a;
+  input wire[3:0] b;
+  input wire[3:0] c;
+  always @(*) begin
+    $write("%h%h%h ", a, b, c);
+  end
+endmodule
+
+module TickA();
+  initial begin
+    repeat (4) begin
+      #3 $write("a ");
+    end
+  end
+endmodule
+
+module TickB();
+  initial begin
+    repeat (4) begin
+      #2 $write("b ");
+    end
+  end
+endmodule
+
+reg[3:0] COUNT = 0;
+wire[3:0] y1, y2;
+Inc i1(COUNT, y1);
+Inc i2(y1, y2);
+Show s(COUNT, y1, y2);
+TickA ta();
+TickB tb();
+
+always @(posedge clock.val) begin
+  COUNT <= COUNT + 1;
+  if (COUNT == 4) begin
+    $finish;
+  end
+end
@@ -0,0 +1,22 @@
+reg[7:0] x = 0;
+reg[3:0] m[1:0];
+wire[3:0] lo = x[3:0];
+wire[3:0] hi = x[7:4];
+reg[3:0] y = 0;
+always @(*) y = m[1] + x[7:4];
+
+reg[2:0] i = 0;
+always @(posedge clock.val) begin
+  i <= i + 1;
+  case (i)
+    0: x <= 8'h12;
+    1: x[7:4] <= 4'h5;
+    2: m[0] <= 4'h3;
+    3: m[1] <= 4'h1;
+    4: x[3:0] <= 4'h7;
+    5: begin 
+      $write("%h%h%h", lo, hi, y); 
+      $finish; 
+    end
+  endcase
+end
@@ -0,0 +1,8 @@
+// More text than fits in the runtime's output buffer in a single step
+reg[15:0] i;
+initial begin
+  for (i = 0; i < 10000; i = i + 1)
+    $write("0123456789");
+  $write("done");
+  $finish;
+end
@@ -40,11 +40,18 @@
 #include <string>
 #include <type_traits>
 #include <vector>
+#include "src/base/bits/word_arith.h"
+#include "src/base/bits/word_logic.h"
+#include "src/base/container/small_vector.h"
 #include "src/base/serial/serializable.h"
 
 namespace cascade {
 
-// This class is the fundamental representation of a bit string. 
+// This class is the fundamental representation of a bit string. Values which
+// fit in one or two words are stored inline; only wide values are allocated on
+// the heap. Most of the operators below provide a fast path for the single
+// word case, which accounts for the overwhelming majority of the values in
+// real programs.
 
 template <typename T, typename BT, typename ST>
 class BitsBase : public Serializable {
@@ -177,7 +184,7 @@ class BitsBase : public Serializable {
 
   private:
     // Bit-string representation
-    std::vector<T> val_;
+    SmallVector<T, 2> val_;
     // Total number of bits in this string
     uint32_t size_;
     // How is this value being interpreted
@@ -191,14 +198,17 @@ class BitsBase : public Serializable {
     void write_2_8_16(std::ostream& os, size_t base) const;
     // Writes a number in base 10
     void write_10(std::ostream& os) const;
-    // Halves a decimal value, stored as a string
-    void dec_halve(std::string& s) const;
-    // Returns true if a decimal value, stored as a string is 0
-    bool dec_zero(const std::string& s) const;
-    // Doubles a decimal value, stored as a string in reverse order
-    void dec_double(std::string& s) const;
-    // Increments a decimal value, stored as a string in reverse order
-    void dec_inc(std::string& s) const;
+
+    // Decimal conversion is performed in chunks of dec_digits() digits, the
+    // largest power of ten, dec_base(), which fits in a word.
+    static constexpr size_t dec_digits();
+    static constexpr T dec_base();
+    // Writes the decimal digits of v to the buffer which ends at end and
+    // returns a pointer to the first digit. Pads with zeros to n digits.
+    static char* write_dec_word(T v, char* end, size_t n);
+
+    // Arithmetic Helpers
+    void divmod(const BitsBase& rhs, BitsBase& q, BitsBase& r) const;
 
     // Shift Helpers 
     void bitwise_sll_const(size_t samt, BitsBase& res) const;
@@ -364,6 +374,9 @@ inline void BitsBase<T, BT, ST>::write_word(size_t n, B b) {
 
 template <typename T, typename BT, typename ST>
 inline bool BitsBase<T, BT, ST>::to_bool() const {
+  if (val_.size() == 1) {
+    return val_[0] != 0;
+  }
   for (const auto& v : val_) {
     if (v) {
       return true;
@@ -406,36 +419,44 @@ template <typename T, typename BT, typename ST>
 inline void BitsBase<T, BT, ST>::bitwise_and(const BitsBase& rhs, BitsBase& res) const {
   assert(size_ == rhs.size_);
   assert(size_ == res.size_);
-  for (size_t i = 0, ie = val_.size(); i < ie; ++i) {
-    res.val_[i] = val_[i] & rhs.val_[i];
+  if (val_.size() == 1) {
+    res.val_[0] = val_[0] & rhs.val_[0];
+    return;
   }
+  WordLogic<T>::bitwise_and(val_.data(), rhs.val_.data(), res.val_.data(), val_.size());
 }
 
 template <typename T, typename BT, typename ST>
 inline void BitsBase<T, BT, ST>::bitwise_or(const BitsBase& rhs, BitsBase& res) const {
   assert(size_ == rhs.size_);
   assert(size_ == res.size_);
-  for (size_t i = 0, ie = val_.size(); i < ie; ++i) {
-    res.val_[i] = val_[i] | rhs.val_[i];
+  if (val_.size() == 1) {
+    res.val_[0] = val_[0] | rhs.val_[0];
+    return;
   }
+  WordLogic<T>::bitwise_or(val_.data(), rhs.val_.data(), res.val_.data(), val_.size());
 }
 
 template <typename T, typename BT, typename ST>
 inline void BitsBase<T, BT, ST>::bitwise_xor(const BitsBase& rhs, BitsBase& res) const {
   assert(size_ == rhs.size_);
   assert(size_ == res.size_);
-  for (size_t i = 0, ie = val_.size(); i < ie; ++i) {
-    res.val_[i] = val_[i] ^ rhs.val_[i];
+  if (val_.size() == 1) {
+    res.val_[0] = val_[0] ^ rhs.val_[0];
+    return;
   }
+  WordLogic<T>::bitwise_xor(val_.data(), rhs.val_.data(), res.val_.data(), val_.size());
 }
 
 template <typename T, typename BT, typename ST>
 inline void BitsBase<T, BT, ST>::bitwise_xnor(const BitsBase& rhs, BitsBase& res) const {
   assert(size_ == rhs.size_);
   assert(size_ == res.size_);
-  for (size_t i = 0, ie = val_.size(); i < ie; ++i) {
-    res.val_[i] = ~(val_[i] ^ rhs.val_[i]);
+  if (val_.size() == 1) {
+    res.val_[0] = ~(val_[0] ^ rhs.val_[0]);
+    return res.trim();
   }
+  WordLogic<T>::bitwise_xnor(val_.data(), rhs.val_.data(), res.val_.data(), val_.size());
   res.trim();
 }
 
@@ -466,15 +487,21 @@ inline void BitsBase<T, BT, ST>::bitwise_sar(const BitsBase& rhs, BitsBase& res)
 template <typename T, typename BT, typename ST>
 inline void BitsBase<T, BT, ST>::bitwise_not(BitsBase& res) const {
   assert(size_ == res.size_);
-  for (size_t i = 0, ie = val_.size(); i < ie; ++i) {
-    res.val_[i] = ~val_[i];
+  if (val_.size() == 1) {
+    res.val_[0] = ~val_[0];
+    return res.trim();
   }
+  WordLogic<T>::bitwise_not(val_.data(), res.val_.data(), val_.size());
   res.trim();
 }
 
 template <typename T, typename BT, typename ST>
 inline void BitsBase<T, BT, ST>::arithmetic_plus(BitsBase& res) const {
   assert(size_ == res.size_);
+  if (val_.size() == 1) {
+    res.val_[0] = val_[0];
+    return;
+  }
   for (size_t i = 0, ie = val_.size(); i < ie; ++i) {
     res.val_[i] = val_[i];
   }
@@ -485,6 +512,12 @@ inline void BitsBase<T, BT, ST>::arithmetic_plus(const BitsBase& rhs, BitsBase&
   assert(size_ == rhs.size_);
   assert(size_ == res.size_);
 
+  // Fast Path: Single word values
+  if (val_.size() == 1) {
+    res.val_[0] = val_[0] + rhs.val_[0];
+    return res.trim();
+  }
+
   T carry = 0;
   for (size_t i = 0, ie = val_.size(); i < ie; ++i) {
     res.val_[i] = val_[i] + rhs.val_[i] + carry;
@@ -501,6 +534,12 @@ template <typename T, typename BT, typename ST>
 inline void BitsBase<T, BT, ST>::arithmetic_minus(BitsBase& res) const {
   assert(size_ == res.size_);
 
+  // Fast Path: Single word values
+  if (val_.size() == 1) {
+    res.val_[0] = -val_[0];
+    return res.trim();
+  }
+
   T carry = 1;
   for (size_t i = 0, ie = val_.size(); i < ie; ++i) {
     res.val_[i] = ~val_[i];
@@ -516,6 +555,12 @@ inline void BitsBase<T, BT, ST>::arithmetic_minus(const BitsBase& rhs, BitsBase&
   assert(size_ == rhs.size_);
   assert(size_ == res.size_);
 
+  // Fast Path: Single word values
+  if (val_.size() == 1) {
+    res.val_[0] = val_[0] - rhs.val_[0];
+    return res.trim();
+  }
+
   T carry = 0;
   for (size_t i = 0, ie = val_.size(); i < ie; ++i) {
     res.val_[i] = val_[i] - rhs.val_[i] - carry;
@@ -533,73 +578,136 @@ inline void BitsBase<T, BT, ST>::arithmetic_multiply(const BitsBase& rhs, BitsBa
   assert(size_ == rhs.size_);
   assert(size_ == res.size_);
 
-  // This is the optimized space algorithm described in wiki's multiplication
-  // algorithm article. The code is simplified here, as we can assume that both
-  // inputs and the result are capped at S words. 
-
-  const auto S = val_.size();
-  BT tot = 0;
-  for (size_t ri = 0; ri < S; ++ri) {
-    for (size_t bi = 0; bi <= ri; ++bi) {
-      size_t ai = ri - bi;
-      tot += BT(val_[ai]) * BT(rhs.val_[bi]);
-    }
-    res.val_[ri] = (T)tot;
-    tot >>= bits_per_word();
+  // Fast Path: Single word values
+  if (val_.size() == 1) {
+    res.val_[0] = val_[0] * rhs.val_[0];
+    return res.trim();
   }
+
+  // Since both inputs and the result are capped at the same number of words,
+  // we only need to compute the low order half of the product.
+  WordArith<T, BT>::mul_low(val_.data(), rhs.val_.data(), res.val_.data(), val_.size());
   res.trim();
 }
 
 template <typename T, typename BT, typename ST>
 inline void BitsBase<T, BT, ST>::arithmetic_divide(const BitsBase& rhs, BitsBase& res) const {
-  // TODO: This only words for single word inputs
-
   assert(size_ == rhs.size_);
   assert(size_ == res.size_);
-  assert(val_.size() == 1);
 
-  if (signed_ && rhs.signed_) {
-    const ST l = is_negative() ? (val_[0] | (BT(-1) << size_)) : val_[0];
-    const ST r = rhs.is_negative() ? (rhs.val_[0] | (BT(-1) << rhs.size_)) : rhs.val_[0]; 
-    res.val_[0] = l / r;
-  } else {
-    res.val_[0] = val_[0] / rhs.val_[0];
+  // Division by zero is undefined. We follow the convention of most two-state
+  // simulators and return zero.
+  if (!rhs.to_bool()) {
+    std::fill(res.val_.begin(), res.val_.end(), T(0));
+    return;
+  }
+  
+  // Fast Path: Single word values
+  if (val_.size() == 1) {
+    if (signed_ && rhs.signed_) {
+      const auto ln = is_negative();
+      const auto rn = rhs.is_negative();
+      const auto l = ln ? T(-signed_get(0)) : val_[0];
+      const auto r = rn ? T(-rhs.signed_get(0)) : rhs.val_[0];
+      res.val_[0] = (ln != rn) ? T(-(l / r)) : (l / r);
+    } else {
+      res.val_[0] = val_[0] / rhs.val_[0];
+    }
+    return res.trim();
   }
 
-  res.trim();
+  BitsBase r(size_, 0);
+  divmod(rhs, res, r);
 }
 
 template <typename T, typename BT, typename ST>
 inline void BitsBase<T, BT, ST>::arithmetic_mod(const BitsBase& rhs, BitsBase& res) const {
-  // TODO: This only words for single word inputs
-
   assert(size_ == rhs.size_);
   assert(size_ == res.size_);
-  assert(val_.size() == 1);
 
-  if (signed_ && rhs.signed_) {
-    const ST l = is_negative() ? (val_[0] | (BT(-1) << size_)) : val_[0];
-    const ST r = rhs.is_negative() ? (rhs.val_[0] | (BT(-1) << rhs.size_)) : rhs.val_[0]; 
-    res.val_[0] = l % r;
-  } else {
-    res.val_[0] = val_[0] % rhs.val_[0];
+  // See the comment in arithmetic_divide()
+  if (!rhs.to_bool()) {
+    std::fill(res.val_.begin(), res.val_.end(), T(0));
+    return;
   }
 
-  res.trim();
+  // Fast Path: Single word values
+  if (val_.size() == 1) {
+    if (signed_ && rhs.signed_) {
+      const auto ln = is_negative();
+      const auto l = ln ? T(-signed_get(0)) : val_[0];
+      const auto r = rhs.is_negative() ? T(-rhs.signed_get(0)) : rhs.val_[0];
+      res.val_[0] = ln ? T(-(l % r)) : (l % r);
+    } else {
+      res.val_[0] = val_[0] % rhs.val_[0];
+    }
+    return res.trim();
+  }
+
+  BitsBase q(size_, 0);
+  divmod(rhs, q, res);
 }
 
 template <typename T, typename BT, typename ST>
 inline void BitsBase<T, BT, ST>::arithmetic_pow(const BitsBase& rhs, BitsBase& res) const {
-  // TODO: There's a lot wrong here:
-  // 1. We're not respecting verilog semantics (wrt sign and result)
-  // 2. This only works for single word inputs
-
   assert(size_ == rhs.size_);
   assert(size_ == res.size_);
-  assert(val_.size() == 1);
 
-  // No resize. This method preserves the bit-width of lhs
-  res.val_[0] = std::pow(val_[0], rhs.val_[0]);
+  // Negative exponents produce integer results for only a handful of bases.
+  // Verilog defines 0 ** -n to be x; we return zero instead.
+  if (rhs.is_negative()) {
+    std::fill(res.val_.begin(), res.val_.end(), T(0));
+    auto one = (val_[0] == 1);
+    auto neg_one = is_negative();
+    for (size_t i = 0, ie = val_.size(); i < ie; ++i) {
+      one = one && (val_[i] == ((i == 0) ? T(1) : T(0)));
+      neg_one = neg_one && (signed_get(i) == T(-1));
+    }
+    if (one || (neg_one && !rhs.get(0))) {
+      res.val_[0] = 1;
+    } else if (neg_one) {
+      std::fill(res.val_.begin(), res.val_.end(), T(-1));
+    }
+    return res.trim();
+  }
+
+  // Fast Path: Single word values
+  if (val_.size() == 1) {
+    T b = val_[0];
+    T r = 1;
+    for (auto e = rhs.val_[0]; e != 0; e >>= 1) {
+      if (e & 1) {
+        r *= b;
+      }
+      b *= b;
+    }
+    res.val_[0] = r;
+    return res.trim();
+  }
+
+  // Exponentiation by squaring. All intermediate products are truncated to
+  // the width of the result, which is equivalent to computing the full
+  // product modulo 2^size_.
+  const auto n = val_.size();
+  std::vector<T> b(val_.begin(), val_.end());
+  std::vector<T> r(n, T(0));
+  std::vector<T> t(n);
+  r[0] = 1;
+  size_t msb = size_;
+  while ((msb > 0) && !rhs.get(msb-1)) {
+    --msb;
+  }
+  for (size_t i = 0; i < msb; ++i) {
+    if (rhs.get(i)) {
+      WordArith<T, BT>::mul_low(r.data(), b.data(), t.data(), n);
+      r.swap(t);
+    }
+    if (i+1 < msb) {
+      WordArith<T, BT>::mul_low(b.data(), b.data(), t.data(), n);
+      b.swap(t);
+    }
+  }
+  std::copy(r.begin(), r.end(), res.val_.begin());
   res.trim();
 }
 
@@ -660,22 +768,11 @@ inline void BitsBase<T, BT, ST>::logical_gte(const BitsBase& rhs, BitsBase& res)
 template <typename T, typename BT, typename ST>
 inline void BitsBase<T, BT, ST>::reduce_and(BitsBase& res) const {
   // Logical operations always yield unsigned results
-  for (size_t i = 0, ie = val_.size()-1; i < ie; ++i) {
-    if (val_[i] != T(-1)) {
-      res.val_[0] = T(0);
-      res.trim();
-      return;
-    }
-  }
-  const auto mask = (T(1) << (size_ % bits_per_word())) - 1;
-  if ((val_.back() & mask) != mask) {
-    res.val_[0] = T(0);
-    res.trim();
-    return; 
-  }
-  res.val_[0] = T(1);
+  const auto trailing = size_ % bits_per_word();
+  const auto mask = (trailing == 0) ? T(-1) : ((T(1) << trailing) - 1);
+  const auto all = (val_.back() == mask) && WordLogic<T>::all_ones(val_.data(), val_.size()-1);
+  res.val_[0] = all ? T(1) : T(0);
   res.trim();
-  return;
 }
 
 template <typename T, typename BT, typename ST>
@@ -686,14 +783,7 @@ inline void BitsBase<T, BT, ST>::reduce_nand(BitsBase& res) const {
 
 template <typename T, typename BT, typename ST>
 inline void BitsBase<T, BT, ST>::reduce_or(BitsBase& res) const {
-  for (size_t i = 0, ie = val_.size(); i < ie; ++i) {
-    if (val_[i]) {
-      res.val_[0] = T(1);
-      res.trim();
-      return;
-    }
-  }
-  res.val_[0] = T(0);
+  res.val_[0] = WordLogic<T>::any(val_.data(), val_.size()) ? T(1) : T(0);
   res.trim();
 }
 
@@ -705,11 +795,7 @@ inline void BitsBase<T, BT, ST>::reduce_nor(BitsBase& res) const {
 
 template <typename T, typename BT, typename ST>
 inline void BitsBase<T, BT, ST>::reduce_xor(BitsBase& res) const {
-  size_t cnt = 0;
-  for (size_t i = 0, ie = val_.size(); i < ie; ++i) {
-    cnt += __builtin_popcount(val_[i]);
-  }
-  res.val_[0] = T(cnt % 2);
+  res.val_[0] = WordLogic<T>::parity(val_.data(), val_.size()) ? T(1) : T(0);
   res.trim();
 }
 
@@ -721,7 +807,12 @@ inline void BitsBase<T, BT, ST>::reduce_xnor(BitsBase& res) const {
 
 template <typename T, typename BT, typename ST>
 inline bool BitsBase<T, BT, ST>::eq(const BitsBase& rhs) const {
-  size_t i = 0;
+  // Words which are below the highest order word of both values can be
+  // compared directly without worrying about sign extension.
+  size_t i = std::min(val_.size(), rhs.val_.size()) - 1;
+  if (!WordLogic<T>::equal(val_.data(), rhs.val_.data(), i)) {
+    return false;
+  }
   for (size_t ie = val_.size()-1; i < ie; ++i) {
     const auto rval = rhs.signed_get(i);
     if (val_[i] != rval) {
@@ -793,6 +884,11 @@ inline bool BitsBase<T, BT, ST>::eq(size_t msb, size_t lsb, const BitsBase& rhs)
 
 template <typename T, typename BT, typename ST>
 inline void BitsBase<T, BT, ST>::assign(const BitsBase& rhs) {
+  // Fast Path: Single word values
+  if (val_.size() == 1) {
+    val_[0] = rhs.signed_get(0);
+    return trim();
+  }
   for (size_t i = 0, ie = val_.size(); i < ie; ++i) {
     val_[i] = rhs.signed_get(i);
   }
@@ -908,9 +1004,7 @@ inline void BitsBase<T, BT, ST>::assign(const BitsBase& rhs, size_t msb, size_t
 template <typename T, typename BT, typename ST>
 inline void BitsBase<T, BT, ST>::concat(const BitsBase& rhs) {
   bitwise_sll_const(rhs.size_, *this);
-  for (size_t i = 0, ie = std::min(val_.size(), rhs.val_.size()); i < ie; ++i) {
-    val_[i] |= rhs.val_[i];
-  }
+  WordLogic<T>::bitwise_or(val_.data(), rhs.val_.data(), val_.data(), std::min(val_.size(), rhs.val_.size()));
 }
 
 template <typename T, typename BT, typename ST>
@@ -954,12 +1048,10 @@ inline BitsBase<T, BT, ST>& BitsBase<T, BT, ST>::flip(size_t idx) {
 template <typename T, typename BT, typename ST>
 inline bool BitsBase<T, BT, ST>::operator==(const BitsBase& rhs) const {
   assert(size_ == rhs.size_);
-  for (size_t i = 0, ie = val_.size(); i < ie; ++i) {
-    if (val_[i] != rhs.val_[i]) {
-      return false;
-    }
+  if (val_.size() == 1) {
+    return val_[0] == rhs.val_[0];
   }
-  return true;
+  return WordLogic<T>::equal(val_.data(), rhs.val_.data(), val_.size());
 }
 
 template <typename T, typename BT, typename ST>
@@ -981,6 +1073,9 @@ inline bool BitsBase<T, BT, ST>::operator<(const BitsBase& rhs) const {
     }
   }
 
+  if (val_.size() == 1) {
+    return val_[0] < rhs.val_[0];
+  }
   for (int i = val_.size()-1; i >= 0; --i) {
     if (val_[i] < rhs.val_[i]) {
       return true;
@@ -1005,6 +1100,9 @@ inline bool BitsBase<T, BT, ST>::operator<=(const BitsBase& rhs) const {
     }
   }
 
+  if (val_.size() == 1) {
+    return val_[0] <= rhs.val_[0];
+  }
   for (int i = val_.size()-1; i >= 0; --i) {
     if (val_[i] < rhs.val_[i]) {
       return true;
@@ -1075,188 +1173,229 @@ inline void BitsBase<T, BT, ST>::read_10(std::istream& is) {
   std::string s;
   is >> s;
 
-  // Reset interal state
+  // Reset interal state. No need to worry about sign extension below;
+  // shrink_to_bool reset signedness.
   shrink_to_bool(false);
 
-  // Halve decimal string until it becomes zero. Add 1s when least significant
-  // digit is odd, 0s otherwise. No need to worry about sign extension;
-  // shrink_to_bool reset signedness
-  for (size_t i = 1; !dec_zero(s); ++i) {
-    extend_to(i);
-    set(i-1, (s.back()-'0') % 2); 
-    dec_halve(s);
+  // Fast Path: Numbers with few enough digits fit in a single word 
+  if (s.length() <= dec_digits()) {
+    T v = 0;
+    for (auto c : s) {
+      v = 10 * v + (c - '0');
+    }
+    if (v != 0) {
+      extend_to(bits_per_word() - WordArith<T, BT>::clz(v));
+      val_[0] = v;
+    }
+    return;
+  }
+
+  // Consume the string in chunks of dec_digits() digits, starting with
+  // whatever is left over at the front. For each chunk, multiply the
+  // accumulated value by the appropriate power of ten and add the chunk.
+  std::vector<T> acc(1, T(0));
+  for (size_t i = 0, n = s.length() % dec_digits(), ie = s.length(); i < ie; i += n, n = dec_digits()) {
+    if (n == 0) {
+      continue;
+    }
+    T chunk = 0;
+    T scale = 1;
+    for (size_t j = i; j < i+n; ++j) {
+      chunk = 10 * chunk + (s[j] - '0');
+      scale *= 10;
+    }
+    T carry = chunk;
+    for (auto& w : acc) {
+      const BT p = BT(w) * scale + carry;
+      w = T(p);
+      carry = T(p >> bits_per_word());
+    }
+    if (carry != 0) {
+      acc.push_back(carry);
+    }
+  }
+
+  const auto n = WordArith<T, BT>::length(acc.data(), acc.size());
+  if (n > 0) {
+    extend_to((n-1) * bits_per_word() + bits_per_word() - WordArith<T, BT>::clz(acc[n-1]));
+    std::copy(acc.begin(), acc.begin()+n, val_.begin());
   }
 }
 
 template <typename T, typename BT, typename ST>
 inline void BitsBase<T, BT, ST>::write_2_8_16(std::ostream& os, size_t base) const {
-  // Output Buffer:
-  std::vector<uint8_t> buf;
+  static constexpr char digits[] = "0123456789abcdef";
 
   // How many bits do we consume per character? Make a mask.
   const auto step = (base == 2) ? 1 : (base == 8) ? 3 : 4;
   const auto mask = (T(1) << step) - 1;
 
-  // Walk over the string from lowest to highest order
-  size_t idx = 0;
-  for (size_t i = 0, ie = val_.size(); i < ie; ++i) {
-    while (true) {
-      // Extract mask bits 
-      buf.push_back((val_[i] >> idx) & mask);
-      idx += step;
-      // Easy case: Step divides words evenly 
-      if (idx == bits_per_word()) {
-        idx = 0;
-        break;
-      } 
-      // Hard case: Look ahead for more bits
-      if (idx > bits_per_word()) {
-        idx %= bits_per_word();
-        if ((i+1) != ie) {
-          buf.back() |= (val_[i+1] & ((T(1) << idx) - 1)) << (step - idx);
-        }
-        break;
-      }
-    }
+  // How many characters do we need to print, ignoring leading zeros?
+  const auto top = WordArith<T, BT>::length(val_.data(), val_.size());
+  if (top == 0) {
+    os.put('0');
+    return;
   }
-
-  // Print the result
-  bool zero = true;
-  for (int i = buf.size()-1; i >= 0; --i) {
-    if (zero && (buf[i] == 0)) {
-      continue;
-    } else {
-      zero = false;
-      if (buf[i] > 9) {
-        os << (char)('a' + buf[i] - 10);
-      } else {
-        os << (int)buf[i];
-      }
+  const auto nbits = top * bits_per_word() - WordArith<T, BT>::clz(val_[top-1]);
+  const auto n = (nbits + step - 1) / step;
+
+  // Output Buffer: Single word values never need more than the stack
+  char sbuf[8*sizeof(T)];
+  std::string hbuf;
+  char* buf = sbuf;
+  if (n > sizeof(sbuf)) {
+    hbuf.resize(n);
+    buf = &hbuf[0];
+  }
+
+  // Walk over the string from lowest to highest order. In base 8, characters
+  // can straddle a word boundary.
+  for (size_t i = 0; i < n; ++i) {
+    const auto idx = i * step;
+    const auto word = idx / bits_per_word();
+    const auto off = idx % bits_per_word();
+    auto bits = val_[word] >> off;
+    if ((off + step > bits_per_word()) && (word+1 < val_.size())) {
+      bits |= val_[word+1] << (bits_per_word() - off);
     }
+    buf[n-1-i] = digits[bits & mask];
   }
-  if (zero) {
-    os << "0";  
-  }
+  os.write(buf, n);
 }
 
-
 template <typename T, typename BT, typename ST>
 inline void BitsBase<T, BT, ST>::write_10(std::ostream& os) const {
-  // If this number is negative, switch to positive value
-  Bits temp = *this;
-  if (temp.is_negative()) {
-    os << "-";
-    arithmetic_minus(temp);
-  }
-
-  // Output Buffer (lsb in index 0):
-  std::string buf = "0";
-  // Walk binary string from highest to lowest.
-  // Double result each time, add 1s as they appear.
-  for (int i = size_-1; i >= 0; --i) {
-    dec_double(buf);
-    if (temp.get(i)) {
-      dec_inc(buf);
-    }
+  // If this number is negative, print its magnitude
+  const auto neg = is_negative();
+  if (neg) {
+    os.put('-');
+  }
+
+  // Fast Path: Single word values are printed from a buffer on the stack
+  if (val_.size() == 1) {
+    char buf[dec_digits() + 1];
+    const auto end = buf + sizeof(buf);
+    const auto begin = write_dec_word(neg ? T(-signed_get(0)) : val_[0], end, 0);
+    os.write(begin, end - begin);
+    return;
+  }
+
+  // Multi-word values are repeatedly divided by dec_base(). The remainders
+  // are the chunks of decimal digits from lowest to highest order.
+  std::vector<T> mag(val_.begin(), val_.end());
+  if (neg) {
+    mag.back() = signed_get(mag.size()-1);
+    WordArith<T, BT>::negate(mag.data(), mag.size());
   }
-  // Print the result in reverse
-  for (int i = buf.length()-1; i >= 0; --i) {
-    os << buf[i];
+  const auto s = WordArith<T, BT>::clz(dec_base());
+  const auto d = T(dec_base() << s);
+  const auto v = WordArith<T, BT>::reciprocal(d);
+  std::vector<T> chunks;
+  for (auto n = WordArith<T, BT>::length(mag.data(), mag.size()); n > 0; n = WordArith<T, BT>::length(mag.data(), n)) {
+    chunks.push_back(WordArith<T, BT>::divmod_word_preinv(mag.data(), n, d, s, v));
   }
+  if (chunks.empty()) {
+    chunks.push_back(T(0));
+  }
+
+  // Every chunk but the highest order one is padded with zeros
+  std::string buf(chunks.size() * dec_digits(), '0');
+  auto end = &buf[0] + buf.size();
+  const char* begin = end;
+  for (size_t i = 0, ie = chunks.size(); i < ie; ++i, end -= dec_digits()) {
+    begin = write_dec_word(chunks[i], end, (i+1 == ie) ? 0 : dec_digits());
+  }
+  os.write(begin, &buf[0] + buf.size() - begin);
 }
 
 template <typename T, typename BT, typename ST>
-inline void BitsBase<T, BT, ST>::dec_halve(std::string& s) const {
-  auto next_carry = 0;
-  for (size_t i = 0, ie = s.length(); i < ie; ++i) {
-    const auto val = s[i] - '0';
-    auto carry = next_carry;
-    next_carry = (val % 2) ? 5 : 0;
-    s[i] = (val / 2 + carry) + '0';
-  }
+constexpr size_t BitsBase<T, BT, ST>::dec_digits() {
+  return (sizeof(T) == 8) ? 19 : (sizeof(T) == 4) ? 9 : (sizeof(T) == 2) ? 4 : 2;
 }
 
 template <typename T, typename BT, typename ST>
-inline bool BitsBase<T, BT, ST>::dec_zero(const std::string& s) const {
-  for (auto c : s) {
-    if (c != '0') {
-      return false;
-    }
+constexpr T BitsBase<T, BT, ST>::dec_base() {
+  T res = 1;
+  for (size_t i = 0; i < dec_digits(); ++i) {
+    res *= 10;
   }
-  return true;
+  return res;
 }
 
 template <typename T, typename BT, typename ST>
-inline void BitsBase<T, BT, ST>::dec_double(std::string& s) const {
-  auto carry = 0;
-  for (size_t i = 0, ie = s.size(); i < ie; ++i) {
-    auto val = s[i] - '0';
-    val = 2 * val + carry;
-    if (val >= 10) {
-      s[i] = '0' + (val - 10);
-      carry = 1;
-    } else {
-      s[i] = '0' + val;
-      carry = 0;
-    }
+inline char* BitsBase<T, BT, ST>::write_dec_word(T v, char* end, size_t n) {
+  static constexpr char pairs[] = 
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+  // Emit two digits at a time. Dividing by a constant compiles to a multiply
+  // and a shift.
+  auto p = end;
+  while (v >= 100) {
+    const auto r = 2 * (v % 100);
+    v /= 100;
+    *--p = pairs[r+1];
+    *--p = pairs[r];
+  }
+  if (v >= 10) {
+    *--p = pairs[2*v+1];
+    *--p = pairs[2*v];
+  } else {
+    *--p = char('0' + v);
   }
-  if (carry) {
-    s.push_back('1');
+  // Pad to n digits
+  while (p > end - n) {
+    *--p = '0';
   }
+  return p;
 }
 
 template <typename T, typename BT, typename ST>
-inline void BitsBase<T, BT, ST>::dec_inc(std::string& s) const {
-  for (size_t i = 0, ie = s.size(); i < ie; ++i) {
-    if (++s[i] == ('0'+10)) {
-      s[i] = '0';
-    } else {
-      return;
-    }
+inline void BitsBase<T, BT, ST>::divmod(const BitsBase& rhs, BitsBase& q, BitsBase& r) const {
+  // Signed division is performed on magnitudes. The magnitude of the most
+  // negative value still fits in size_ bits, so no additional words are
+  // required. The sign of the quotient is the xor of the signs of the
+  // operands and the sign of the remainder is the sign of the dividend.
+  const auto n = val_.size();
+  const auto ln = signed_ && rhs.signed_ && is_negative();
+  const auto rn = signed_ && rhs.signed_ && rhs.is_negative();
+
+  std::vector<T> u(n);
+  std::vector<T> v(n);
+  for (size_t i = 0; i < n; ++i) {
+    u[i] = ln ? signed_get(i) : val_[i];
+    v[i] = rn ? rhs.signed_get(i) : rhs.val_[i];
+  }
+  if (ln) {
+    WordArith<T, BT>::negate(u.data(), n);
   }
-  s.push_back('1');
+  if (rn) {
+    WordArith<T, BT>::negate(v.data(), n);
+  }
+
+  WordArith<T, BT>::divmod(u.data(), v.data(), q.val_.data(), r.val_.data(), n);
+  if (ln != rn) {
+    WordArith<T, BT>::negate(q.val_.data(), n);
+  }
+  if (ln) {
+    WordArith<T, BT>::negate(r.val_.data(), n);
+  }
+  q.trim();
+  r.trim();
 }
 
 template <typename T, typename BT, typename ST>
 inline void BitsBase<T, BT, ST>::bitwise_sll_const(size_t samt, BitsBase& res) const {
   assert(size_ == res.size_);
-  
-  // Easy Case: We're not actually shifting
-  if (samt == 0) {
-    for (size_t i = 0, ie = val_.size(); i < ie; ++i) {
-      res.val_[i] = val_[i];
-    }
-    return;
-  }
 
-  // This algorithm works from highest to lowest order, one word at a time
-  // word: The current word we're looking at
-  // top/bottom: The words that will be shifted into word; word can equal top
-
-  // How many words ahead is bottom?
-  const auto delta = (samt + bits_per_word() - 1) / bits_per_word();
-  // How many bits are we taking from bottom and shifting top?
-  const auto bamt = samt % bits_per_word();
-  // Create a mask for extracting the highest bamt bits from bottom
-  const auto mamt = bits_per_word() - bamt;
-  const auto mask = ((T(1) << bamt) - 1) << mamt;
-
-  // Work our way down until bottom hits zero
-  int w = val_.size() - 1;
-  for (int b = w-delta; b >= 0; --w, --b) {
-    if (bamt == 0) {
-      res.val_[w] = val_[b];
-    } else {
-      res.val_[w] = (val_[b+1] << bamt) | ((val_[b] & mask) >> mamt);
-    }
+  // Fast Path: Single word values
+  if (val_.size() == 1) {
+    res.val_[0] = (samt < bits_per_word()) ? (val_[0] << samt) : T(0);
+    return res.trim();
   }
-  // There's one more block to build where bottom is implicitly zero
-  res.val_[w--] = (bamt == 0) ? T(0) : (val_[0] << bamt);
-  // Everything else is zero
-  for (; w >= 0; --w) {
-    res.val_[w] = T(0);
-  }
-  // Trim the top and we're done
+
+  WordLogic<T>::shift_left(val_.data(), res.val_.data(), val_.size(), samt);
   res.trim();
 }
 
@@ -1264,48 +1403,26 @@ template <typename T, typename BT, typename ST>
 inline void BitsBase<T, BT, ST>::bitwise_sxr_const(size_t samt, bool arith, BitsBase& res) const {
   assert(size_ == res.size_);
 
-  // Easy Case: We're not actually shifting
-  if (samt == 0) {
-    for (size_t i = 0, ie = val_.size(); i < ie; ++i) {
-      res.val_[i] = val_[i];
-    }
-    return;
-  }
-
-  // This algorithm works from lowest to highest order, one word at a time
-  // word: The current word we're looking at
-  // top/bottom: The words that will be shifted into word; word can equal bottom
-
-  // Is the highest order bit a 1 and do we care?
+  // Is the highest order bit a 1 and do we care? If so, the highest order
+  // word needs to be sign extended before we shift it.
   const auto idx = (size_-1) % bits_per_word();
   const auto hob = arith && (val_.back() & (T(1) << idx)); 
-  // How many words ahead is top?
-  const auto delta = (samt + bits_per_word() - 1) / bits_per_word();
-  // How many bits are we taking from top and shifting bottom?
-  const auto bamt = samt % bits_per_word();
-  // Create a mask for extracting the lowest bamt bits from top
-  const auto mamt = bits_per_word() - bamt;
-  const auto mask = (T(1) << bamt) - 1;
-
-  // Work our way up until top goes out of range
-  size_t w = 0;
-  for (size_t t = w+delta, te = val_.size(); t < te; ++w, ++t) {
-    if (bamt == 0) {
-      res.val_[w] = val_[t];
+  const auto top = (hob && (idx+1 < bits_per_word())) ? (val_.back() | (T(-1) << (idx+1))) : val_.back();
+  const auto fill = hob ? T(-1) : T(0);
+
+  // Fast Path: Single word values
+  if (val_.size() == 1) {
+    if (samt == 0) {
+      res.val_[0] = top;
+    } else if (samt < bits_per_word()) {
+      res.val_[0] = (top >> samt) | (fill << (bits_per_word() - samt));
     } else {
-      res.val_[w] = (val_[t-1] >> bamt) | ((val_[t] & mask) << mamt);
+      res.val_[0] = fill;
     }
+    return res.trim();
   }
-  // There's one more block to build where top is implicitly zero
-  if (hob) {
-    res.val_[w++] = (bamt == 0) ? T(-1) : ((val_.back() >> bamt) | (mask << mamt));
-  } else {
-    res.val_[w++] = (bamt == 0) ? T(0) : (val_.back() >> bamt);
-  }
-  // Everything else is zero or padded 1s
-  for (size_t we = val_.size(); w < we; ++w) {
-    res.val_[w] = hob ? T(-1) : T(0);
-  }
+
+  WordLogic<T>::shift_right(val_.data(), res.val_.data(), val_.size(), samt, top, fill);
   // Trim since we could have introduced trailing 1s
   res.trim();
 }
@@ -1327,7 +1444,10 @@ template <typename T, typename BT, typename ST>
 void BitsBase<T, BT, ST>::extend_to(size_t n) {
   const auto words = (n + bits_per_word() - 1) / bits_per_word();
   if (is_negative()) {
-    val_.back() |= (T(-1) << (size_ % bits_per_word()));
+    const auto trailing = size_ % bits_per_word();
+    if (trailing != 0) {
+      val_.back() |= (T(-1) << trailing);
+    }
     val_.resize(words, T(-1));
     size_ = n;
     trim();
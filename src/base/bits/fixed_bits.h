@@ -0,0 +1,718 @@
+// Copyright 2017-2018 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CASCADE_SRC_BASE_BITS_FIXED_BITS_H
+#define CASCADE_SRC_BASE_BITS_FIXED_BITS_H
+
+#include <algorithm>
+#include <cassert>
+#include <stddef.h>
+#include <stdint.h>
+#include "src/base/bits/bits.h"
+#include "src/base/bits/word_arith.h"
+
+namespace cascade {
+
+// This class is a bit string whose width and signedness are known at compile
+// time. It implements the same verilog semantics as BitsBase, but storage is
+// a fixed size array and all of the masking and sign extension logic is
+// resolved statically, so there are no runtime size checks. It's intended
+// for use by generated or specialized engines, and converts to and from
+// BitsBase so that it can be passed across the State, Input, and DataPlane
+// boundaries.
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+class FixedBitsBase {
+  public:
+    static_assert(W > 0, "FixedBits must be at least one bit wide");
+
+    // Constructors:
+    FixedBitsBase();
+    explicit FixedBitsBase(T val);
+    explicit FixedBitsBase(const BitsBase<T, BT, ST>& rhs);
+    FixedBitsBase(const FixedBitsBase& rhs) = default;
+    FixedBitsBase& operator=(const FixedBitsBase& rhs) = default;
+    ~FixedBitsBase() = default;
+
+    // Conversion:
+    //
+    // Read assigns from a dynamically sized value, sign extending or
+    // truncating as necessary. Write resizes and overwrites its argument.
+    void read(const BitsBase<T, BT, ST>& rhs);
+    void write(BitsBase<T, BT, ST>& rhs) const;
+    BitsBase<T, BT, ST> to_bits() const;
+
+    // Casts:
+    bool to_bool() const;
+    T to_int() const;
+
+    // Size:
+    static constexpr size_t size();
+
+    // Type:
+    static constexpr bool is_signed();
+
+    // Bitwise Operators: 
+    //
+    // Apply a bitwise operator to this and rhs and store the result in res.
+    void bitwise_and(const FixedBitsBase& rhs, FixedBitsBase& res) const;
+    void bitwise_or(const FixedBitsBase& rhs, FixedBitsBase& res) const;
+    void bitwise_xor(const FixedBitsBase& rhs, FixedBitsBase& res) const;
+    void bitwise_xnor(const FixedBitsBase& rhs, FixedBitsBase& res) const;
+    void bitwise_sll(size_t samt, FixedBitsBase& res) const;
+    void bitwise_sal(size_t samt, FixedBitsBase& res) const;
+    void bitwise_slr(size_t samt, FixedBitsBase& res) const;
+    void bitwise_sar(size_t samt, FixedBitsBase& res) const;
+    void bitwise_not(FixedBitsBase& res) const;
+
+    // Arithmetic Operators:
+    //
+    // Apply an arithmetic operator to this and rhs and store the result in
+    // res. Division or modulo by zero produces zero.
+    void arithmetic_plus(FixedBitsBase& res) const;
+    void arithmetic_plus(const FixedBitsBase& rhs, FixedBitsBase& res) const;
+    void arithmetic_minus(FixedBitsBase& res) const;
+    void arithmetic_minus(const FixedBitsBase& rhs, FixedBitsBase& res) const;
+    void arithmetic_multiply(const FixedBitsBase& rhs, FixedBitsBase& res) const;
+    void arithmetic_divide(const FixedBitsBase& rhs, FixedBitsBase& res) const;
+    void arithmetic_mod(const FixedBitsBase& rhs, FixedBitsBase& res) const;
+    void arithmetic_pow(const FixedBitsBase& rhs, FixedBitsBase& res) const;
+
+    // Logical and Reduction Operators:
+    //
+    // Apply a logical or reduction operator and return a single bit.
+    bool logical_and(const FixedBitsBase& rhs) const;
+    bool logical_or(const FixedBitsBase& rhs) const;
+    bool logical_not() const;
+    bool reduce_and() const;
+    bool reduce_nand() const;
+    bool reduce_or() const;
+    bool reduce_nor() const;
+    bool reduce_xor() const;
+    bool reduce_xnor() const;
+
+    // Assignment Operators:
+    //
+    // Assign bits. These methods follow the same conventions as their
+    // counterparts in BitsBase and handle sign-extension for rhs as
+    // necessary.
+    template <size_t W2, bool S2>
+    void assign(const FixedBitsBase<W2, S2, T, BT, ST>& rhs);
+    template <size_t W2, bool S2>
+    void assign(size_t msb, size_t lsb, const FixedBitsBase<W2, S2, T, BT, ST>& rhs);
+    template <size_t W2, bool S2>
+    void assign(const FixedBitsBase<W2, S2, T, BT, ST>& rhs, size_t msb, size_t lsb);
+
+    // Concatenation Operations:
+    template <size_t W2, bool S2>
+    FixedBitsBase<W+W2, false, T, BT, ST> concat(const FixedBitsBase<W2, S2, T, BT, ST>& rhs) const;
+
+    // Bitwise Operators:
+    bool get(size_t idx) const;
+    FixedBitsBase& set(size_t idx, bool b);
+    FixedBitsBase& flip(size_t idx);
+
+    // Built-in Operators:
+    // Logical comparison, signed if S is true
+    bool operator==(const FixedBitsBase& rhs) const;
+    bool operator!=(const FixedBitsBase& rhs) const;
+    bool operator<(const FixedBitsBase& rhs) const;
+    bool operator<=(const FixedBitsBase& rhs) const;
+    bool operator>(const FixedBitsBase& rhs) const;
+    bool operator>=(const FixedBitsBase& rhs) const;
+
+  private:
+    template <size_t W2, bool S2, typename T2, typename BT2, typename ST2>
+    friend class FixedBitsBase;
+
+    // Number of bits in a word
+    static constexpr size_t bits_per_word_ = 8 * sizeof(T);
+    // Number of words in this value
+    static constexpr size_t words_ = (W + bits_per_word_ - 1) / bits_per_word_;
+    // Number of bits in use in the top word, or zero if all of them are
+    static constexpr size_t trailing_ = W % bits_per_word_;
+    // Mask for the bits in use in the top word
+    static constexpr T mask_ = (trailing_ == 0) ? T(-1) : ((T(1) << (trailing_ % bits_per_word_)) - 1);
+
+    // Bit-string representation
+    T val_[words_];
+
+    // Trims additional bits down to W
+    void trim();
+    // Returns true if this is a signed number with high order bit set
+    bool is_negative() const;
+    // Returns the nth (possibly greater than words_th) word of this value.
+    // Performs sign extension as necessary.
+    T signed_get(size_t n) const;
+    // Stores the magnitude of this value in res and returns true if negative
+    bool magnitude(T* res) const;
+    // Unsigned comparison, returns -1, 0, or 1
+    int compare(const FixedBitsBase& rhs) const;
+};
+
+#ifdef __LP64__
+template <size_t W, bool S = false>
+using FixedBits = FixedBitsBase<W, S, uint64_t, __uint128_t, int64_t>;
+#else
+template <size_t W, bool S = false>
+using FixedBits = FixedBitsBase<W, S, uint32_t, uint64_t, int32_t>;
+#endif
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline FixedBitsBase<W, S, T, BT, ST>::FixedBitsBase() {
+  for (size_t i = 0; i < words_; ++i) {
+    val_[i] = T(0);
+  }
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline FixedBitsBase<W, S, T, BT, ST>::FixedBitsBase(T val) : FixedBitsBase() {
+  val_[0] = val;
+  trim();
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline FixedBitsBase<W, S, T, BT, ST>::FixedBitsBase(const BitsBase<T, BT, ST>& rhs) {
+  read(rhs);
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline void FixedBitsBase<W, S, T, BT, ST>::read(const BitsBase<T, BT, ST>& rhs) {
+  const auto n = (rhs.size() + bits_per_word_ - 1) / bits_per_word_;
+  const auto neg = rhs.is_signed() && rhs.get(rhs.size()-1);
+  for (size_t i = 0; i < words_; ++i) {
+    val_[i] = (i < n) ? rhs.template read_word<T>(i) : (neg ? T(-1) : T(0));
+  }
+  // Sign extend the highest order word of rhs if we read all of it
+  const auto rtrail = rhs.size() % bits_per_word_;
+  if (neg && (rtrail != 0) && (n <= words_)) {
+    val_[n-1] |= (T(-1) << rtrail);
+  }
+  trim();
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline void FixedBitsBase<W, S, T, BT, ST>::write(BitsBase<T, BT, ST>& rhs) const {
+  rhs.resize(W);
+  rhs.set_signed(S);
+  for (size_t i = 0; i < words_; ++i) {
+    rhs.template write_word<T>(i, val_[i]);
+  }
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline BitsBase<T, BT, ST> FixedBitsBase<W, S, T, BT, ST>::to_bits() const {
+  BitsBase<T, BT, ST> res(W, 0);
+  write(res);
+  return res;
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline bool FixedBitsBase<W, S, T, BT, ST>::to_bool() const {
+  return reduce_or();
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline T FixedBitsBase<W, S, T, BT, ST>::to_int() const {
+  return val_[0];
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+constexpr size_t FixedBitsBase<W, S, T, BT, ST>::size() {
+  return W;
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+constexpr bool FixedBitsBase<W, S, T, BT, ST>::is_signed() {
+  return S;
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline void FixedBitsBase<W, S, T, BT, ST>::bitwise_and(const FixedBitsBase& rhs, FixedBitsBase& res) const {
+  for (size_t i = 0; i < words_; ++i) {
+    res.val_[i] = val_[i] & rhs.val_[i];
+  }
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline void FixedBitsBase<W, S, T, BT, ST>::bitwise_or(const FixedBitsBase& rhs, FixedBitsBase& res) const {
+  for (size_t i = 0; i < words_; ++i) {
+    res.val_[i] = val_[i] | rhs.val_[i];
+  }
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline void FixedBitsBase<W, S, T, BT, ST>::bitwise_xor(const FixedBitsBase& rhs, FixedBitsBase& res) const {
+  for (size_t i = 0; i < words_; ++i) {
+    res.val_[i] = val_[i] ^ rhs.val_[i];
+  }
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline void FixedBitsBase<W, S, T, BT, ST>::bitwise_xnor(const FixedBitsBase& rhs, FixedBitsBase& res) const {
+  for (size_t i = 0; i < words_; ++i) {
+    res.val_[i] = ~(val_[i] ^ rhs.val_[i]);
+  }
+  res.trim();
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline void FixedBitsBase<W, S, T, BT, ST>::bitwise_sll(size_t samt, FixedBitsBase& res) const {
+  // Word w is built from words w-delta and w-delta-1. Working from highest to
+  // lowest order makes it safe for res to alias this.
+  const auto delta = samt / bits_per_word_;
+  const auto bamt = samt % bits_per_word_;
+  for (size_t w = words_; w-- > 0; ) {
+    const auto hi = (w >= delta) ? val_[w-delta] : T(0);
+    const auto lo = (w >= delta+1) ? val_[w-delta-1] : T(0);
+    res.val_[w] = (bamt == 0) ? hi : ((hi << bamt) | (lo >> (bits_per_word_-bamt)));
+  }
+  res.trim();
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline void FixedBitsBase<W, S, T, BT, ST>::bitwise_sal(size_t samt, FixedBitsBase& res) const {
+  // Equivalent to sll
+  bitwise_sll(samt, res);
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline void FixedBitsBase<W, S, T, BT, ST>::bitwise_slr(size_t samt, FixedBitsBase& res) const {
+  // Word w is built from words w+delta and w+delta+1. Working from lowest to
+  // highest order makes it safe for res to alias this.
+  const auto delta = samt / bits_per_word_;
+  const auto bamt = samt % bits_per_word_;
+  for (size_t w = 0; w < words_; ++w) {
+    const auto lo = (w+delta < words_) ? val_[w+delta] : T(0);
+    const auto hi = (w+delta+1 < words_) ? val_[w+delta+1] : T(0);
+    res.val_[w] = (bamt == 0) ? lo : ((lo >> bamt) | (hi << (bits_per_word_-bamt)));
+  }
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline void FixedBitsBase<W, S, T, BT, ST>::bitwise_sar(size_t samt, FixedBitsBase& res) const {
+  // Like BitsBase, this fills with the high order bit regardless of
+  // signedness. The only difference with slr is that signed_get() pads with
+  // copies of that bit.
+  const auto neg = get(W-1);
+  const auto delta = samt / bits_per_word_;
+  const auto bamt = samt % bits_per_word_;
+  const auto fill = neg ? T(-1) : T(0);
+  const auto word = [this, neg, fill](size_t i) {
+    if (i >= words_) {
+      return fill;
+    }
+    return (neg && (i == words_-1)) ? T(val_[i] | ~mask_) : val_[i];
+  };
+  for (size_t w = 0; w < words_; ++w) {
+    const auto lo = word(w+delta);
+    const auto hi = word(w+delta+1);
+    res.val_[w] = (bamt == 0) ? lo : ((lo >> bamt) | (hi << (bits_per_word_-bamt)));
+  }
+  res.trim();
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline void FixedBitsBase<W, S, T, BT, ST>::bitwise_not(FixedBitsBase& res) const {
+  for (size_t i = 0; i < words_; ++i) {
+    res.val_[i] = ~val_[i];
+  }
+  res.trim();
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline void FixedBitsBase<W, S, T, BT, ST>::arithmetic_plus(FixedBitsBase& res) const {
+  res = *this;
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline void FixedBitsBase<W, S, T, BT, ST>::arithmetic_plus(const FixedBitsBase& rhs, FixedBitsBase& res) const {
+  T carry = 0;
+  for (size_t i = 0; i < words_; ++i) {
+    const BT sum = BT(val_[i]) + rhs.val_[i] + carry;
+    res.val_[i] = T(sum);
+    carry = T(sum >> bits_per_word_);
+  }
+  res.trim();
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline void FixedBitsBase<W, S, T, BT, ST>::arithmetic_minus(FixedBitsBase& res) const {
+  T carry = 1;
+  for (size_t i = 0; i < words_; ++i) {
+    const BT sum = BT(T(~val_[i])) + carry;
+    res.val_[i] = T(sum);
+    carry = T(sum >> bits_per_word_);
+  }
+  res.trim();
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline void FixedBitsBase<W, S, T, BT, ST>::arithmetic_minus(const FixedBitsBase& rhs, FixedBitsBase& res) const {
+  T borrow = 0;
+  for (size_t i = 0; i < words_; ++i) {
+    const BT diff = BT(val_[i]) - rhs.val_[i] - borrow;
+    res.val_[i] = T(diff);
+    borrow = T(diff >> bits_per_word_) & T(1);
+  }
+  res.trim();
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline void FixedBitsBase<W, S, T, BT, ST>::arithmetic_multiply(const FixedBitsBase& rhs, FixedBitsBase& res) const {
+  if (words_ == 1) {
+    res.val_[0] = val_[0] * rhs.val_[0];
+  } else {
+    T r[words_];
+    WordArith<T, BT>::mul_low(val_, rhs.val_, r, words_);
+    std::copy(r, r+words_, res.val_);
+  }
+  res.trim();
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline void FixedBitsBase<W, S, T, BT, ST>::arithmetic_divide(const FixedBitsBase& rhs, FixedBitsBase& res) const {
+  T u[words_];
+  T v[words_];
+  T q[words_] = {};
+  T r[words_] = {};
+  const auto ln = magnitude(u);
+  const auto rn = rhs.magnitude(v);
+  if (!WordArith<T, BT>::divmod(u, v, q, r, words_)) {
+    res = FixedBitsBase();
+    return;
+  }
+  if (ln != rn) {
+    WordArith<T, BT>::negate(q, words_);
+  }
+  std::copy(q, q+words_, res.val_);
+  res.trim();
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline void FixedBitsBase<W, S, T, BT, ST>::arithmetic_mod(const FixedBitsBase& rhs, FixedBitsBase& res) const {
+  T u[words_];
+  T v[words_];
+  T q[words_] = {};
+  T r[words_] = {};
+  const auto ln = magnitude(u);
+  rhs.magnitude(v);
+  if (!WordArith<T, BT>::divmod(u, v, q, r, words_)) {
+    res = FixedBitsBase();
+    return;
+  }
+  if (ln) {
+    WordArith<T, BT>::negate(r, words_);
+  }
+  std::copy(r, r+words_, res.val_);
+  res.trim();
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline void FixedBitsBase<W, S, T, BT, ST>::arithmetic_pow(const FixedBitsBase& rhs, FixedBitsBase& res) const {
+  // Negative exponents produce integer results for only a handful of bases.
+  // See the comment in BitsBase::arithmetic_pow().
+  if (rhs.is_negative()) {
+    auto one = true;
+    auto neg_one = is_negative();
+    for (size_t i = 0; i < words_; ++i) {
+      one = one && (val_[i] == ((i == 0) ? T(1) : T(0)));
+      neg_one = neg_one && (signed_get(i) == T(-1));
+    }
+    res = FixedBitsBase();
+    if (one || (neg_one && !rhs.get(0))) {
+      res.val_[0] = 1;
+    } else if (neg_one) {
+      res = *this;
+    }
+    return;
+  }
+
+  // Exponentiation by squaring, truncated to W bits
+  T b[words_];
+  T r[words_];
+  T t[words_];
+  std::copy(val_, val_+words_, b);
+  std::fill(r, r+words_, T(0));
+  r[0] = 1;
+  size_t msb = W;
+  while ((msb > 0) && !rhs.get(msb-1)) {
+    --msb;
+  }
+  for (size_t i = 0; i < msb; ++i) {
+    if (rhs.get(i)) {
+      WordArith<T, BT>::mul_low(r, b, t, words_);
+      std::copy(t, t+words_, r);
+    }
+    if (i+1 < msb) {
+      WordArith<T, BT>::mul_low(b, b, t, words_);
+      std::copy(t, t+words_, b);
+    }
+  }
+  std::copy(r, r+words_, res.val_);
+  res.trim();
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline bool FixedBitsBase<W, S, T, BT, ST>::logical_and(const FixedBitsBase& rhs) const {
+  return to_bool() && rhs.to_bool();
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline bool FixedBitsBase<W, S, T, BT, ST>::logical_or(const FixedBitsBase& rhs) const {
+  return to_bool() || rhs.to_bool();
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline bool FixedBitsBase<W, S, T, BT, ST>::logical_not() const {
+  return !to_bool();
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline bool FixedBitsBase<W, S, T, BT, ST>::reduce_and() const {
+  for (size_t i = 0; i+1 < words_; ++i) {
+    if (val_[i] != T(-1)) {
+      return false;
+    }
+  }
+  return val_[words_-1] == mask_;
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline bool FixedBitsBase<W, S, T, BT, ST>::reduce_nand() const {
+  return !reduce_and();
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline bool FixedBitsBase<W, S, T, BT, ST>::reduce_or() const {
+  T acc = 0;
+  for (size_t i = 0; i < words_; ++i) {
+    acc |= val_[i];
+  }
+  return acc != 0;
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline bool FixedBitsBase<W, S, T, BT, ST>::reduce_nor() const {
+  return !reduce_or();
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline bool FixedBitsBase<W, S, T, BT, ST>::reduce_xor() const {
+  T acc = 0;
+  for (size_t i = 0; i < words_; ++i) {
+    acc ^= val_[i];
+  }
+  return __builtin_popcountll(static_cast<unsigned long long>(acc)) & 1;
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline bool FixedBitsBase<W, S, T, BT, ST>::reduce_xnor() const {
+  return !reduce_xor();
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+template <size_t W2, bool S2>
+inline void FixedBitsBase<W, S, T, BT, ST>::assign(const FixedBitsBase<W2, S2, T, BT, ST>& rhs) {
+  for (size_t i = 0; i < words_; ++i) {
+    val_[i] = rhs.signed_get(i);
+  }
+  trim();
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+template <size_t W2, bool S2>
+inline void FixedBitsBase<W, S, T, BT, ST>::assign(size_t msb, size_t lsb, const FixedBitsBase<W2, S2, T, BT, ST>& rhs) {
+  assert(msb < W);
+  assert(msb >= lsb);
+
+  // Only the words which overlap [msb, lsb] are touched. Each one is merged
+  // with the corresponding word of rhs, sign extended and shifted up by lsb.
+  const auto delta = lsb / bits_per_word_;
+  const auto bamt = lsb % bits_per_word_;
+  for (size_t w = delta, we = msb / bits_per_word_; w <= we; ++w) {
+    const auto hi = rhs.signed_get(w-delta);
+    const auto lo = (w > delta) ? rhs.signed_get(w-delta-1) : T(0);
+    const auto v = (bamt == 0) ? hi : T((hi << bamt) | (lo >> (bits_per_word_-bamt)));
+
+    const auto base = w * bits_per_word_;
+    const auto l = std::max(lsb, base) - base;
+    const auto n = std::min(msb, base+bits_per_word_-1) - base - l + 1;
+    const auto m = T(((n == bits_per_word_) ? T(-1) : T((T(1) << n) - 1)) << l);
+    val_[w] = (val_[w] & ~m) | (v & m);
+  }
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+template <size_t W2, bool S2>
+inline void FixedBitsBase<W, S, T, BT, ST>::assign(const FixedBitsBase<W2, S2, T, BT, ST>& rhs, size_t msb, size_t lsb) {
+  assert(msb < W2);
+  assert(msb >= lsb);
+
+  // Word i of the result is built from the two words of rhs which straddle
+  // bit lsb+i*bits_per_word_. The result is unsigned, so anything above the
+  // slice is cleared rather than sign extended.
+  const auto n = msb-lsb+1;
+  const auto delta = lsb / bits_per_word_;
+  const auto bamt = lsb % bits_per_word_;
+  for (size_t i = 0; i < words_; ++i) {
+    const auto base = i * bits_per_word_;
+    if (base >= n) {
+      val_[i] = 0;
+      continue;
+    }
+    const auto lo = (i+delta < rhs.words_) ? rhs.val_[i+delta] : T(0);
+    const auto hi = (i+delta+1 < rhs.words_) ? rhs.val_[i+delta+1] : T(0);
+    val_[i] = (bamt == 0) ? lo : T((lo >> bamt) | (hi << (bits_per_word_-bamt)));
+    if (n-base < bits_per_word_) {
+      val_[i] &= (T(1) << (n-base)) - 1;
+    }
+  }
+  trim();
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+template <size_t W2, bool S2>
+inline FixedBitsBase<W+W2, false, T, BT, ST> FixedBitsBase<W, S, T, BT, ST>::concat(const FixedBitsBase<W2, S2, T, BT, ST>& rhs) const {
+  // Both operands are treated as unsigned, so neither is sign extended.
+  FixedBitsBase<W+W2, false, T, BT, ST> res;
+  std::copy(val_, val_+words_, res.val_);
+  res.bitwise_sll(W2, res);
+  for (size_t i = 0; i < rhs.words_; ++i) {
+    res.val_[i] |= rhs.val_[i];
+  }
+  return res;
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline bool FixedBitsBase<W, S, T, BT, ST>::get(size_t idx) const {
+  assert(idx < W);
+  return (val_[idx / bits_per_word_] >> (idx % bits_per_word_)) & T(1);
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline FixedBitsBase<W, S, T, BT, ST>& FixedBitsBase<W, S, T, BT, ST>::set(size_t idx, bool b) {
+  assert(idx < W);
+  const auto mask = T(1) << (idx % bits_per_word_);
+  if (b) {
+    val_[idx / bits_per_word_] |= mask;
+  } else {
+    val_[idx / bits_per_word_] &= ~mask;
+  }
+  return *this;
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline FixedBitsBase<W, S, T, BT, ST>& FixedBitsBase<W, S, T, BT, ST>::flip(size_t idx) {
+  assert(idx < W);
+  val_[idx / bits_per_word_] ^= (T(1) << (idx % bits_per_word_));
+  return *this;
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline bool FixedBitsBase<W, S, T, BT, ST>::operator==(const FixedBitsBase& rhs) const {
+  return compare(rhs) == 0;
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline bool FixedBitsBase<W, S, T, BT, ST>::operator!=(const FixedBitsBase& rhs) const {
+  return compare(rhs) != 0;
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline bool FixedBitsBase<W, S, T, BT, ST>::operator<(const FixedBitsBase& rhs) const {
+  // Two's complement values with the same sign compare the same way as
+  // unsigned values. Otherwise, the negative value is the smaller one.
+  const auto ln = is_negative();
+  const auto rn = rhs.is_negative();
+  return (ln != rn) ? ln : (compare(rhs) < 0);
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline bool FixedBitsBase<W, S, T, BT, ST>::operator<=(const FixedBitsBase& rhs) const {
+  return !(rhs < *this);
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline bool FixedBitsBase<W, S, T, BT, ST>::operator>(const FixedBitsBase& rhs) const {
+  return rhs < *this;
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline bool FixedBitsBase<W, S, T, BT, ST>::operator>=(const FixedBitsBase& rhs) const {
+  return !(*this < rhs);
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline void FixedBitsBase<W, S, T, BT, ST>::trim() {
+  val_[words_-1] &= mask_;
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline bool FixedBitsBase<W, S, T, BT, ST>::is_negative() const {
+  return S && get(W-1);
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline T FixedBitsBase<W, S, T, BT, ST>::signed_get(size_t n) const {
+  if (n >= words_) {
+    return is_negative() ? T(-1) : T(0);
+  } else if ((n == words_-1) && is_negative()) {
+    return val_[n] | ~mask_;
+  } else {
+    return val_[n];
+  }
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline bool FixedBitsBase<W, S, T, BT, ST>::magnitude(T* res) const {
+  const auto neg = is_negative();
+  for (size_t i = 0; i < words_; ++i) {
+    res[i] = signed_get(i);
+  }
+  if (neg) {
+    WordArith<T, BT>::negate(res, words_);
+  }
+  return neg;
+}
+
+template <size_t W, bool S, typename T, typename BT, typename ST>
+inline int FixedBitsBase<W, S, T, BT, ST>::compare(const FixedBitsBase& rhs) const {
+  for (size_t i = words_; i-- > 0; ) {
+    if (val_[i] != rhs.val_[i]) {
+      return (val_[i] < rhs.val_[i]) ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+} // namespace cascade
+
+#endif
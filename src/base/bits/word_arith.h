@@ -0,0 +1,428 @@
+// Copyright 2017-2018 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CASCADE_SRC_BASE_BITS_WORD_ARITH_H
+#define CASCADE_SRC_BASE_BITS_WORD_ARITH_H
+
+#include <algorithm>
+#include <cassert>
+#include <stddef.h>
+#include <vector>
+
+namespace cascade {
+
+// Kernels for arithmetic on multi-word unsigned integers. Values are stored
+// least significant word first, as arrays of T. BT must be a type which is
+// twice as wide as T. Unless otherwise noted, output arrays may not alias
+// input arrays. These methods are used by BitsBase to implement arithmetic on
+// values which are wider than a single word.
+
+template <typename T, typename BT>
+class WordArith {
+  public:
+    // Operand widths, in words, at and above which full and truncated
+    // multiplication switch from the schoolbook algorithm to Karatsuba's
+    // algorithm. Truncated schoolbook multiplication only does half the work
+    // of full multiplication, so its crossover point is much higher. See
+    // data/benchmark/wide_arith for the measurements behind these values.
+    static constexpr size_t karatsuba_threshold = 32;
+    static constexpr size_t karatsuba_low_threshold = 96;
+
+    // Returns the number of words in a, ignoring leading zeros
+    static size_t length(const T* a, size_t n);
+
+    // Adds a into r and returns the carry out. an must be no greater than rn.
+    static T add(T* r, size_t rn, const T* a, size_t an);
+    // Subtracts a from r and returns the borrow out. an must be no greater
+    // than rn.
+    static T sub(T* r, size_t rn, const T* a, size_t an);
+    // Replaces a with its two's complement. 
+    static void negate(T* a, size_t n);
+
+    // Full Multiplication:
+    //
+    // Stores the 2n word product of two n word values in r.
+    static void mul(const T* a, const T* b, T* r, size_t n);
+    static void mul_schoolbook(const T* a, const T* b, T* r, size_t n);
+    static void mul_karatsuba(const T* a, const T* b, T* r, size_t n);
+
+    // Truncated Multiplication:
+    //
+    // Stores the low order n words of the product of two n word values in r.
+    static void mul_low(const T* a, const T* b, T* r, size_t n);
+    static void mul_low_schoolbook(const T* a, const T* b, T* r, size_t n);
+    static void mul_low_karatsuba(const T* a, const T* b, T* r, size_t n);
+
+    // Division:
+    //
+    // Divides the n word value u by the n word value v and stores the n word
+    // quotient and remainder in q and r. Returns false and leaves q and r
+    // untouched if v is zero.
+    static bool divmod(const T* u, const T* v, T* q, T* r, size_t n);
+
+    // Division by an Invariant Word:
+    //
+    // Divides the n word value a in place by the single word d and returns
+    // the remainder. Rather than using a hardware divide for each word, this
+    // multiplies by a reciprocal of d which is computed ahead of time by
+    // reciprocal() (see Moller and Granlund, "Improved Division by Invariant
+    // Integers"). Both methods take d shifted left by s so that its high
+    // order bit is set.
+    static T reciprocal(T d);
+    static T divmod_word_preinv(T* a, size_t n, T d, size_t s, T v);
+
+    // Returns the number of leading zeros in a non-zero word
+    static size_t clz(T t);
+
+  private:
+    // Returns the number of bits in a word
+    static constexpr size_t bits_per_word();
+    // Divides the m word value u by the single word d
+    static T divmod_word(const T* u, size_t m, T d, T* q);
+    // Knuth's algorithm D: Divides the m word value u by the n word value v,
+    // with m >= n >= 2 and a non-zero high order word in v.
+    static void divmod_knuth(const T* u, size_t m, const T* v, size_t n, T* q, T* r);
+};
+
+template <typename T, typename BT>
+inline size_t WordArith<T, BT>::length(const T* a, size_t n) {
+  while ((n > 0) && (a[n-1] == 0)) {
+    --n;
+  }
+  return n;
+}
+
+template <typename T, typename BT>
+inline T WordArith<T, BT>::add(T* r, size_t rn, const T* a, size_t an) {
+  assert(an <= rn);
+
+  T carry = 0;
+  size_t i = 0;
+  for (; i < an; ++i) {
+    const BT sum = BT(r[i]) + a[i] + carry;
+    r[i] = T(sum);
+    carry = T(sum >> bits_per_word());
+  }
+  for (; carry && (i < rn); ++i) {
+    carry = (++r[i] == 0) ? T(1) : T(0);
+  }
+  return carry;
+}
+
+template <typename T, typename BT>
+inline T WordArith<T, BT>::sub(T* r, size_t rn, const T* a, size_t an) {
+  assert(an <= rn);
+
+  T borrow = 0;
+  size_t i = 0;
+  for (; i < an; ++i) {
+    const T d = r[i] - a[i];
+    const T b = (r[i] < a[i]) ? T(1) : T(0);
+    r[i] = d - borrow;
+    borrow = b | ((d < borrow) ? T(1) : T(0));
+  }
+  for (; borrow && (i < rn); ++i) {
+    borrow = (r[i]-- == 0) ? T(1) : T(0);
+  }
+  return borrow;
+}
+
+template <typename T, typename BT>
+inline void WordArith<T, BT>::negate(T* a, size_t n) {
+  T carry = 1;
+  for (size_t i = 0; i < n; ++i) {
+    a[i] = ~a[i] + carry;
+    carry = (carry && (a[i] == 0)) ? T(1) : T(0);
+  }
+}
+
+template <typename T, typename BT>
+inline void WordArith<T, BT>::mul(const T* a, const T* b, T* r, size_t n) {
+  if (n < karatsuba_threshold) {
+    mul_schoolbook(a, b, r, n);
+  } else {
+    mul_karatsuba(a, b, r, n);
+  }
+}
+
+template <typename T, typename BT>
+inline void WordArith<T, BT>::mul_schoolbook(const T* a, const T* b, T* r, size_t n) {
+  std::fill(r, r+2*n, T(0));
+  for (size_t i = 0; i < n; ++i) {
+    // The largest value computed here is (2^w-1)^2 + 2(2^w-1) = 2^2w-1, so
+    // there's no risk of overflowing BT.
+    T carry = 0;
+    for (size_t j = 0; j < n; ++j) {
+      const BT p = BT(a[i]) * b[j] + r[i+j] + carry;
+      r[i+j] = T(p);
+      carry = T(p >> bits_per_word());
+    }
+    r[i+n] = carry;
+  }
+}
+
+template <typename T, typename BT>
+inline void WordArith<T, BT>::mul_karatsuba(const T* a, const T* b, T* r, size_t n) {
+  // Small inputs aren't worth splitting
+  if (n < 4) {
+    return mul_schoolbook(a, b, r, n);
+  }
+
+  // Split a and b into a low order half of h words and a high order half of l
+  // <= h words: a = a1*B^h + a0 and b = b1*B^h + b0. The product is z2*B^2h +
+  // z1*B^h + z0, where z0 = a0*b0, z2 = a1*b1, and z1 = (a0+a1)(b0+b1)-z0-z2.
+  const auto h = (n + 1) / 2;
+  const auto l = n - h;
+
+  // z0 and z2 can be written directly into the low and high halves of r,
+  // since 2h + 2l = 2n. 
+  std::fill(r, r+2*n, T(0));
+  mul(a, b, r, h);
+  mul(a+h, b+h, r+2*h, l);
+
+  // The sums a0+a1 and b0+b1 can require h+1 words, which means their product
+  // requires 2h+2 words.
+  std::vector<T> sa(a, a+h);
+  sa.push_back(add(sa.data(), h, a+h, l));
+  std::vector<T> sb(b, b+h);
+  sb.push_back(add(sb.data(), h, b+h, l));
+  std::vector<T> z1(2*h+2);
+  mul(sa.data(), sb.data(), z1.data(), h+1);
+  sub(z1.data(), z1.size(), r, 2*h);
+  sub(z1.data(), z1.size(), r+2*h, 2*l);
+
+  // z1 = a0*b1 + a1*b0 < 2*B^n, so anything above r's upper bound is zero.
+  const auto zn = std::min(z1.size(), 2*n-h);
+  add(r+h, 2*n-h, z1.data(), length(z1.data(), zn));
+}
+
+template <typename T, typename BT>
+inline void WordArith<T, BT>::mul_low(const T* a, const T* b, T* r, size_t n) {
+  if (n < karatsuba_low_threshold) {
+    mul_low_schoolbook(a, b, r, n);
+  } else {
+    mul_low_karatsuba(a, b, r, n);
+  }
+}
+
+template <typename T, typename BT>
+inline void WordArith<T, BT>::mul_low_schoolbook(const T* a, const T* b, T* r, size_t n) {
+  std::fill(r, r+n, T(0));
+  for (size_t i = 0; i < n; ++i) {
+    T carry = 0;
+    for (size_t j = 0, je = n-i; j < je; ++j) {
+      const BT p = BT(a[i]) * b[j] + r[i+j] + carry;
+      r[i+j] = T(p);
+      carry = T(p >> bits_per_word());
+    }
+  }
+}
+
+template <typename T, typename BT>
+inline void WordArith<T, BT>::mul_low_karatsuba(const T* a, const T* b, T* r, size_t n) {
+  // Small inputs aren't worth splitting
+  if (n < 4) {
+    return mul_low_schoolbook(a, b, r, n);
+  }
+
+  // Using the same split as in mul_karatsuba(), the low order n words of the
+  // product are z0 + (a1*b0 + a0*b1)*B^h mod B^n. Only the low order l words
+  // of the two cross terms matter, and those only depend on the low order l
+  // words of b0 and a0.
+  const auto h = (n + 1) / 2;
+  const auto l = n - h;
+
+  std::vector<T> z0(2*h);
+  mul(a, b, z0.data(), h);
+  for (size_t i = 0; i < n; ++i) {
+    r[i] = z0[i];
+  }
+
+  std::vector<T> z1(l);
+  mul_low(a+h, b, z1.data(), l);
+  add(r+h, l, z1.data(), l);
+  mul_low(a, b+h, z1.data(), l);
+  add(r+h, l, z1.data(), l);
+}
+
+template <typename T, typename BT>
+inline bool WordArith<T, BT>::divmod(const T* u, const T* v, T* q, T* r, size_t n) {
+  const auto vn = length(v, n);
+  if (vn == 0) {
+    return false;
+  }
+  const auto un = length(u, n);
+
+  std::fill(q, q+n, T(0));
+  std::fill(r, r+n, T(0));
+  if (un < vn) {
+    std::copy(u, u+n, r);
+  } else if (vn == 1) {
+    r[0] = divmod_word(u, un, v[0], q);
+  } else {
+    divmod_knuth(u, un, v, vn, q, r);
+  }
+  return true;
+}
+
+template <typename T, typename BT>
+inline T WordArith<T, BT>::reciprocal(T d) {
+  assert(clz(d) == 0);
+  // v = floor((B^2-1) / d) - B, where B = 2^bits_per_word()
+  return T(~BT(0) / d);
+}
+
+template <typename T, typename BT>
+inline T WordArith<T, BT>::divmod_word_preinv(T* a, size_t n, T d, size_t s, T v) {
+  const auto W = bits_per_word();
+
+  // We divide a << s by d << s, which yields the same quotient and a
+  // remainder which is shifted left by s. The shifted dividend is produced on
+  // the fly, one word at a time from highest to lowest order. Its highest
+  // order word is less than d, so it can be used as the initial remainder.
+  T r = (s == 0) ? T(0) : T(a[n-1] >> (W-s));
+  for (size_t i = n; i-- > 0; ) {
+    const T u0 = (a[i] << s) | (((s == 0) || (i == 0)) ? T(0) : T(a[i-1] >> (W-s)));
+    // Estimate the quotient word and then adjust it, at most twice.
+    const BT p = BT(v) * r + ((BT(r) << W) | u0);
+    T q = T(p >> W) + 1;
+    T rem = u0 - q * d;
+    if (rem > T(p)) {
+      --q;
+      rem += d;
+    }
+    if (rem >= d) {
+      ++q;
+      rem -= d;
+    }
+    a[i] = q;
+    r = rem;
+  }
+  return r >> s;
+}
+
+template <typename T, typename BT>
+constexpr size_t WordArith<T, BT>::bits_per_word() {
+  return 8 * sizeof(T);
+}
+
+template <typename T, typename BT>
+inline size_t WordArith<T, BT>::clz(T t) {
+  assert(t != 0);
+  size_t n = 0;
+  for (auto mask = T(1) << (bits_per_word()-1); (t & mask) == 0; mask >>= 1) {
+    ++n;
+  }
+  return n;
+}
+
+template <typename T, typename BT>
+inline T WordArith<T, BT>::divmod_word(const T* u, size_t m, T d, T* q) {
+  BT rem = 0;
+  for (size_t i = m; i-- > 0; ) {
+    const BT num = (rem << bits_per_word()) | u[i];
+    q[i] = T(num / d);
+    rem = num % d;
+  }
+  return T(rem);
+}
+
+template <typename T, typename BT>
+inline void WordArith<T, BT>::divmod_knuth(const T* u, size_t m, const T* v, size_t n, T* q, T* r) {
+  // This is Algorithm D from Knuth Vol. 2, 4.3.1. The structure follows the
+  // presentation in Hacker's Delight, 9-2, but avoids signed intermediates so
+  // that it works with a double-word type that has no signed counterpart.
+  const auto W = bits_per_word();
+  const BT base = BT(1) << W;
+
+  // D1: Normalize so that the high order bit of v is set. This guarantees
+  // that each estimate of a quotient digit is off by at most two.
+  const auto s = clz(v[n-1]);
+  std::vector<T> vn(n);
+  for (size_t i = n-1; i > 0; --i) {
+    vn[i] = (s == 0) ? v[i] : ((v[i] << s) | (v[i-1] >> (W-s)));
+  }
+  vn[0] = v[0] << s;
+  std::vector<T> un(m+1);
+  un[m] = (s == 0) ? T(0) : (u[m-1] >> (W-s));
+  for (size_t i = m-1; i > 0; --i) {
+    un[i] = (s == 0) ? u[i] : ((u[i] << s) | (u[i-1] >> (W-s)));
+  }
+  un[0] = u[0] << s;
+
+  // D2-D7: Compute one quotient word at a time
+  for (size_t j = m-n+1; j-- > 0; ) {
+    // D3: Estimate the quotient word and refine the estimate using the second
+    // highest word of v. The product is only evaluated once qhat < base.
+    const BT num = (BT(un[j+n]) << W) | un[j+n-1];
+    BT qhat = num / vn[n-1];
+    BT rhat = num % vn[n-1];
+    while ((qhat >= base) || (qhat * vn[n-2] > ((rhat << W) | un[j+n-2]))) {
+      --qhat;
+      rhat += vn[n-1];
+      if (rhat >= base) {
+        break;
+      }
+    }
+
+    // D4: Multiply and subtract
+    T carry = 0;
+    T borrow = 0;
+    for (size_t i = 0; i < n; ++i) {
+      const BT p = qhat * vn[i] + carry;
+      carry = T(p >> W);
+      const T d = un[i+j] - T(p);
+      const T b = (un[i+j] < T(p)) ? T(1) : T(0);
+      un[i+j] = d - borrow;
+      borrow = b | ((d < borrow) ? T(1) : T(0));
+    }
+    const T d = un[j+n] - carry;
+    const T b = (un[j+n] < carry) ? T(1) : T(0);
+    un[j+n] = d - borrow;
+    borrow = b | ((d < borrow) ? T(1) : T(0));
+
+    // D5-D6: If we subtracted too much, add one copy of v back in. This is
+    // rare (probability on the order of 2/base).
+    if (borrow) {
+      --qhat;
+      un[j+n] += add(un.data()+j, n, vn.data(), n);
+    }
+    q[j] = T(qhat);
+  }
+
+  // D8: Unnormalize the remainder
+  for (size_t i = 0; i < n; ++i) {
+    r[i] = (s == 0) ? un[i] : ((un[i] >> s) | (un[i+1] << (W-s)));
+  }
+}
+
+} // namespace cascade
+
+#endif
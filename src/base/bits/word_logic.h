@@ -0,0 +1,573 @@
+// Copyright 2017-2018 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CASCADE_SRC_BASE_BITS_WORD_LOGIC_H
+#define CASCADE_SRC_BASE_BITS_WORD_LOGIC_H
+
+#include <cassert>
+#include <stddef.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace cascade {
+
+// Kernels for bitwise operations on multi-word values. Values are stored least
+// significant word first, as arrays of T. On x86 targets, these methods
+// dispatch at runtime to AVX2 or SSE4.1 implementations, depending on what
+// the host supports. On all other targets, or on hosts without either
+// extension, they fall back on scalar loops. Unless otherwise noted, outputs
+// may alias inputs. These methods are used by BitsBase to implement bitwise
+// operations on values which are wider than a single word.
+
+template <typename T>
+class WordLogic {
+  public:
+    // Bitwise Operators:
+    //
+    // Apply a bitwise operator to the n word values a and b and store the
+    // result in r. 
+    static void bitwise_and(const T* a, const T* b, T* r, size_t n);
+    static void bitwise_or(const T* a, const T* b, T* r, size_t n);
+    static void bitwise_xor(const T* a, const T* b, T* r, size_t n);
+    static void bitwise_xnor(const T* a, const T* b, T* r, size_t n);
+    static void bitwise_not(const T* a, T* r, size_t n);
+
+    // Reduction Operators:
+    //
+    // Returns true if every bit, any bit, or an odd number of bits in the n
+    // word value a is set.
+    static bool all_ones(const T* a, size_t n);
+    static bool any(const T* a, size_t n);
+    static bool parity(const T* a, size_t n);
+
+    // Comparison Operators:
+    //
+    // Returns true if the n word values a and b are equal.
+    static bool equal(const T* a, const T* b, size_t n);
+
+    // Shift Operators:
+    //
+    // Shifts the n word value a left or right by samt bits and stores the
+    // result in r. Left shifts fill with zeros. Right shifts read the highest
+    // order word of a as top, and fill with copies of fill. 
+    static void shift_left(const T* a, T* r, size_t n, size_t samt);
+    static void shift_right(const T* a, T* r, size_t n, size_t samt, T top, T fill);
+
+  private:
+    enum Op {
+      AND = 0,
+      OR,
+      XOR,
+      XNOR,
+      NOT
+    };
+
+    // Returns the number of bits in a word
+    static constexpr size_t bits_per_word();
+    // Returns the number of words in a vector of w bits
+    static constexpr size_t words_per(size_t w);
+
+    // Scalar implementations. Each of these methods operates on words [i, n).
+    template <Op op>
+    static void bitwise_scalar(const T* a, const T* b, T* r, size_t i, size_t n);
+    static T fold_scalar(const T* a, size_t i, size_t n, T init, Op op);
+
+#if defined(__x86_64__) || defined(__i386__)
+    // Runtime Feature Detection:
+    static bool has_avx2();
+    static bool has_sse41();
+
+    // Vector implementations. Each of these methods operates on as many
+    // whole vectors as fit in n words and returns the number of words it
+    // processed. Any remaining words are left for the scalar implementations.
+    template <Op op>
+    __attribute__((target("avx2"))) 
+    static size_t bitwise_avx2(const T* a, const T* b, T* r, size_t n);
+    template <Op op>
+    __attribute__((target("sse4.1"))) 
+    static size_t bitwise_sse41(const T* a, const T* b, T* r, size_t n);
+    __attribute__((target("avx2"))) 
+    static size_t all_ones_avx2(const T* a, size_t n, bool& res);
+    __attribute__((target("sse4.1"))) 
+    static size_t all_ones_sse41(const T* a, size_t n, bool& res);
+    __attribute__((target("avx2"))) 
+    static size_t any_avx2(const T* a, size_t n, bool& res);
+    __attribute__((target("sse4.1"))) 
+    static size_t any_sse41(const T* a, size_t n, bool& res);
+    __attribute__((target("avx2"))) 
+    static size_t parity_avx2(const T* a, size_t n, T& res);
+    __attribute__((target("sse4.1"))) 
+    static size_t parity_sse41(const T* a, size_t n, T& res);
+    __attribute__((target("avx2"))) 
+    static size_t equal_avx2(const T* a, const T* b, size_t n, bool& res);
+    __attribute__((target("sse4.1"))) 
+    static size_t equal_sse41(const T* a, const T* b, size_t n, bool& res);
+    __attribute__((target("avx2"))) 
+    static size_t shift_left_avx2(const T* a, T* r, size_t n, size_t delta, size_t bamt);
+    __attribute__((target("avx2"))) 
+    static size_t shift_right_avx2(const T* a, T* r, size_t n, size_t delta, size_t bamt);
+#endif
+};
+
+template <typename T>
+inline void WordLogic<T>::bitwise_and(const T* a, const T* b, T* r, size_t n) {
+  size_t i = 0;
+#if defined(__x86_64__) || defined(__i386__)
+  if (has_avx2()) {
+    i = bitwise_avx2<AND>(a, b, r, n);
+  } else if (has_sse41()) {
+    i = bitwise_sse41<AND>(a, b, r, n);
+  }
+#endif
+  bitwise_scalar<AND>(a, b, r, i, n);
+}
+
+template <typename T>
+inline void WordLogic<T>::bitwise_or(const T* a, const T* b, T* r, size_t n) {
+  size_t i = 0;
+#if defined(__x86_64__) || defined(__i386__)
+  if (has_avx2()) {
+    i = bitwise_avx2<OR>(a, b, r, n);
+  } else if (has_sse41()) {
+    i = bitwise_sse41<OR>(a, b, r, n);
+  }
+#endif
+  bitwise_scalar<OR>(a, b, r, i, n);
+}
+
+template <typename T>
+inline void WordLogic<T>::bitwise_xor(const T* a, const T* b, T* r, size_t n) {
+  size_t i = 0;
+#if defined(__x86_64__) || defined(__i386__)
+  if (has_avx2()) {
+    i = bitwise_avx2<XOR>(a, b, r, n);
+  } else if (has_sse41()) {
+    i = bitwise_sse41<XOR>(a, b, r, n);
+  }
+#endif
+  bitwise_scalar<XOR>(a, b, r, i, n);
+}
+
+template <typename T>
+inline void WordLogic<T>::bitwise_xnor(const T* a, const T* b, T* r, size_t n) {
+  size_t i = 0;
+#if defined(__x86_64__) || defined(__i386__)
+  if (has_avx2()) {
+    i = bitwise_avx2<XNOR>(a, b, r, n);
+  } else if (has_sse41()) {
+    i = bitwise_sse41<XNOR>(a, b, r, n);
+  }
+#endif
+  bitwise_scalar<XNOR>(a, b, r, i, n);
+}
+
+template <typename T>
+inline void WordLogic<T>::bitwise_not(const T* a, T* r, size_t n) {
+  // Not is implemented as xnor with a second operand that we ignore.
+  size_t i = 0;
+#if defined(__x86_64__) || defined(__i386__)
+  if (has_avx2()) {
+    i = bitwise_avx2<NOT>(a, a, r, n);
+  } else if (has_sse41()) {
+    i = bitwise_sse41<NOT>(a, a, r, n);
+  }
+#endif
+  bitwise_scalar<NOT>(a, a, r, i, n);
+}
+
+template <typename T>
+inline bool WordLogic<T>::all_ones(const T* a, size_t n) {
+  size_t i = 0;
+  bool res = true;
+#if defined(__x86_64__) || defined(__i386__)
+  if (has_avx2()) {
+    i = all_ones_avx2(a, n, res);
+  } else if (has_sse41()) {
+    i = all_ones_sse41(a, n, res);
+  }
+#endif
+  return res && (fold_scalar(a, i, n, T(-1), AND) == T(-1));
+}
+
+template <typename T>
+inline bool WordLogic<T>::any(const T* a, size_t n) {
+  size_t i = 0;
+  bool res = false;
+#if defined(__x86_64__) || defined(__i386__)
+  if (has_avx2()) {
+    i = any_avx2(a, n, res);
+  } else if (has_sse41()) {
+    i = any_sse41(a, n, res);
+  }
+#endif
+  return res || (fold_scalar(a, i, n, T(0), OR) != T(0));
+}
+
+template <typename T>
+inline bool WordLogic<T>::parity(const T* a, size_t n) {
+  // The parity of a multi-word value is the parity of the xor of its words,
+  // so we only need to count the bits in a single word.
+  size_t i = 0;
+  T res = 0;
+#if defined(__x86_64__) || defined(__i386__)
+  if (has_avx2()) {
+    i = parity_avx2(a, n, res);
+  } else if (has_sse41()) {
+    i = parity_sse41(a, n, res);
+  }
+#endif
+  res = fold_scalar(a, i, n, res, XOR);
+  return __builtin_popcountll(static_cast<unsigned long long>(res)) & 1;
+}
+
+template <typename T>
+inline bool WordLogic<T>::equal(const T* a, const T* b, size_t n) {
+  size_t i = 0;
+#if defined(__x86_64__) || defined(__i386__)
+  bool res = true;
+  if (has_avx2()) {
+    i = equal_avx2(a, b, n, res);
+  } else if (has_sse41()) {
+    i = equal_sse41(a, b, n, res);
+  }
+  if (!res) {
+    return false;
+  }
+#endif
+  for (; i < n; ++i) {
+    if (a[i] != b[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename T>
+inline void WordLogic<T>::shift_left(const T* a, T* r, size_t n, size_t samt) {
+  // Word r[w] is built from a[w-delta] and a[w-delta-1]. We work from highest
+  // to lowest order, so it's safe for r to alias a.
+  const auto delta = samt / bits_per_word();
+  const auto bamt = samt % bits_per_word();
+  if (delta >= n) {
+    for (size_t w = 0; w < n; ++w) {
+      r[w] = T(0);
+    }
+    return;
+  }
+
+  size_t w = n;
+#if defined(__x86_64__) || defined(__i386__)
+  if (has_avx2()) {
+    w -= shift_left_avx2(a, r, n, delta, bamt);
+  } 
+#endif
+  for (; w > delta+1; --w) {
+    const auto hi = a[w-1-delta];
+    const auto lo = a[w-2-delta];
+    r[w-1] = (bamt == 0) ? hi : ((hi << bamt) | (lo >> (bits_per_word()-bamt)));
+  }
+  if (w > delta) {
+    r[--w] = a[0] << bamt;
+  }
+  while (w > 0) {
+    r[--w] = T(0);
+  }
+}
+
+template <typename T>
+inline void WordLogic<T>::shift_right(const T* a, T* r, size_t n, size_t samt, T top, T fill) {
+  // Word r[w] is built from a[w+delta] and a[w+delta+1]. We work from lowest
+  // to highest order, so it's safe for r to alias a.
+  const auto delta = samt / bits_per_word();
+  const auto bamt = samt % bits_per_word();
+  if (delta >= n) {
+    for (size_t w = 0; w < n; ++w) {
+      r[w] = fill;
+    }
+    return;
+  }
+
+  size_t w = 0;
+#if defined(__x86_64__) || defined(__i386__)
+  // The vector implementation never touches the highest order word of a.
+  if (has_avx2() && (n > 1)) {
+    w = shift_right_avx2(a, r, n-1, delta, bamt);
+  } 
+#endif
+  for (; w+delta < n; ++w) {
+    const auto lo = (w+delta+1 < n) ? a[w+delta] : top;
+    const auto hi = (w+delta+2 < n) ? a[w+delta+1] : (w+delta+2 == n) ? top : fill;
+    r[w] = (bamt == 0) ? lo : ((lo >> bamt) | (hi << (bits_per_word()-bamt)));
+  }
+  for (; w < n; ++w) {
+    r[w] = fill;
+  }
+}
+
+template <typename T>
+constexpr size_t WordLogic<T>::bits_per_word() {
+  return 8 * sizeof(T);
+}
+
+template <typename T>
+constexpr size_t WordLogic<T>::words_per(size_t w) {
+  return w / bits_per_word();
+}
+
+template <typename T>
+template <typename WordLogic<T>::Op op>
+inline void WordLogic<T>::bitwise_scalar(const T* a, const T* b, T* r, size_t i, size_t n) {
+  for (; i < n; ++i) {
+    switch (op) {
+      case AND:  r[i] = a[i] & b[i]; break;
+      case OR:   r[i] = a[i] | b[i]; break;
+      case XOR:  r[i] = a[i] ^ b[i]; break;
+      case XNOR: r[i] = ~(a[i] ^ b[i]); break;
+      case NOT:  r[i] = ~a[i]; break;
+    }
+  }
+}
+
+template <typename T>
+inline T WordLogic<T>::fold_scalar(const T* a, size_t i, size_t n, T init, Op op) {
+  for (; i < n; ++i) {
+    switch (op) {
+      case AND: init &= a[i]; break;
+      case OR:  init |= a[i]; break;
+      case XOR: init ^= a[i]; break;
+      default:  assert(false);
+    }
+  }
+  return init;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+template <typename T>
+inline bool WordLogic<T>::has_avx2() {
+  static const bool res = (__builtin_cpu_init(), __builtin_cpu_supports("avx2"));
+  return res;
+}
+
+template <typename T>
+inline bool WordLogic<T>::has_sse41() {
+  static const bool res = (__builtin_cpu_init(), __builtin_cpu_supports("sse4.1"));
+  return res;
+}
+
+template <typename T>
+template <typename WordLogic<T>::Op op>
+inline size_t WordLogic<T>::bitwise_avx2(const T* a, const T* b, T* r, size_t n) {
+  const auto vw = words_per(256);
+  const auto ones = _mm256_set1_epi32(-1);
+  size_t i = 0;
+  for (; i+vw <= n; i += vw) {
+    const auto x = _mm256_loadu_si256((const __m256i*)(a+i));
+    const auto y = _mm256_loadu_si256((const __m256i*)(b+i));
+    switch (op) {
+      case AND:  _mm256_storeu_si256((__m256i*)(r+i), _mm256_and_si256(x, y)); break;
+      case OR:   _mm256_storeu_si256((__m256i*)(r+i), _mm256_or_si256(x, y)); break;
+      case XOR:  _mm256_storeu_si256((__m256i*)(r+i), _mm256_xor_si256(x, y)); break;
+      case XNOR: _mm256_storeu_si256((__m256i*)(r+i), _mm256_xor_si256(_mm256_xor_si256(x, y), ones)); break;
+      case NOT:  _mm256_storeu_si256((__m256i*)(r+i), _mm256_xor_si256(x, ones)); break;
+    }
+  }
+  return i;
+}
+
+template <typename T>
+template <typename WordLogic<T>::Op op>
+inline size_t WordLogic<T>::bitwise_sse41(const T* a, const T* b, T* r, size_t n) {
+  const auto vw = words_per(128);
+  const auto ones = _mm_set1_epi32(-1);
+  size_t i = 0;
+  for (; i+vw <= n; i += vw) {
+    const auto x = _mm_loadu_si128((const __m128i*)(a+i));
+    const auto y = _mm_loadu_si128((const __m128i*)(b+i));
+    switch (op) {
+      case AND:  _mm_storeu_si128((__m128i*)(r+i), _mm_and_si128(x, y)); break;
+      case OR:   _mm_storeu_si128((__m128i*)(r+i), _mm_or_si128(x, y)); break;
+      case XOR:  _mm_storeu_si128((__m128i*)(r+i), _mm_xor_si128(x, y)); break;
+      case XNOR: _mm_storeu_si128((__m128i*)(r+i), _mm_xor_si128(_mm_xor_si128(x, y), ones)); break;
+      case NOT:  _mm_storeu_si128((__m128i*)(r+i), _mm_xor_si128(x, ones)); break;
+    }
+  }
+  return i;
+}
+
+template <typename T>
+inline size_t WordLogic<T>::all_ones_avx2(const T* a, size_t n, bool& res) {
+  const auto vw = words_per(256);
+  const auto ones = _mm256_set1_epi32(-1);
+  auto acc = ones;
+  size_t i = 0;
+  for (; i+vw <= n; i += vw) {
+    acc = _mm256_and_si256(acc, _mm256_loadu_si256((const __m256i*)(a+i)));
+  }
+  res = _mm256_testc_si256(acc, ones);
+  return i;
+}
+
+template <typename T>
+inline size_t WordLogic<T>::all_ones_sse41(const T* a, size_t n, bool& res) {
+  const auto vw = words_per(128);
+  const auto ones = _mm_set1_epi32(-1);
+  auto acc = ones;
+  size_t i = 0;
+  for (; i+vw <= n; i += vw) {
+    acc = _mm_and_si128(acc, _mm_loadu_si128((const __m128i*)(a+i)));
+  }
+  res = _mm_testc_si128(acc, ones);
+  return i;
+}
+
+template <typename T>
+inline size_t WordLogic<T>::any_avx2(const T* a, size_t n, bool& res) {
+  const auto vw = words_per(256);
+  auto acc = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i+vw <= n; i += vw) {
+    acc = _mm256_or_si256(acc, _mm256_loadu_si256((const __m256i*)(a+i)));
+  }
+  res = !_mm256_testz_si256(acc, acc);
+  return i;
+}
+
+template <typename T>
+inline size_t WordLogic<T>::any_sse41(const T* a, size_t n, bool& res) {
+  const auto vw = words_per(128);
+  auto acc = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i+vw <= n; i += vw) {
+    acc = _mm_or_si128(acc, _mm_loadu_si128((const __m128i*)(a+i)));
+  }
+  res = !_mm_testz_si128(acc, acc);
+  return i;
+}
+
+template <typename T>
+inline size_t WordLogic<T>::parity_avx2(const T* a, size_t n, T& res) {
+  const auto vw = words_per(256);
+  auto acc = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i+vw <= n; i += vw) {
+    acc = _mm256_xor_si256(acc, _mm256_loadu_si256((const __m256i*)(a+i)));
+  }
+  T words[vw];
+  _mm256_storeu_si256((__m256i*)words, acc);
+  res = fold_scalar(words, 0, vw, T(0), XOR);
+  return i;
+}
+
+template <typename T>
+inline size_t WordLogic<T>::parity_sse41(const T* a, size_t n, T& res) {
+  const auto vw = words_per(128);
+  auto acc = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i+vw <= n; i += vw) {
+    acc = _mm_xor_si128(acc, _mm_loadu_si128((const __m128i*)(a+i)));
+  }
+  T words[vw];
+  _mm_storeu_si128((__m128i*)words, acc);
+  res = fold_scalar(words, 0, vw, T(0), XOR);
+  return i;
+}
+
+template <typename T>
+inline size_t WordLogic<T>::equal_avx2(const T* a, const T* b, size_t n, bool& res) {
+  const auto vw = words_per(256);
+  auto acc = _mm256_setzero_si256();
+  size_t i = 0;
+  for (; i+vw <= n; i += vw) {
+    const auto x = _mm256_loadu_si256((const __m256i*)(a+i));
+    const auto y = _mm256_loadu_si256((const __m256i*)(b+i));
+    acc = _mm256_or_si256(acc, _mm256_xor_si256(x, y));
+  }
+  res = _mm256_testz_si256(acc, acc);
+  return i;
+}
+
+template <typename T>
+inline size_t WordLogic<T>::equal_sse41(const T* a, const T* b, size_t n, bool& res) {
+  const auto vw = words_per(128);
+  auto acc = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i+vw <= n; i += vw) {
+    const auto x = _mm_loadu_si128((const __m128i*)(a+i));
+    const auto y = _mm_loadu_si128((const __m128i*)(b+i));
+    acc = _mm_or_si128(acc, _mm_xor_si128(x, y));
+  }
+  res = _mm_testz_si128(acc, acc);
+  return i;
+}
+
+template <typename T>
+inline size_t WordLogic<T>::shift_left_avx2(const T* a, T* r, size_t n, size_t delta, size_t bamt) {
+  // The funnel shift below operates on 64-bit lanes. Shifts by the lane width
+  // or more produce zero, so we don't need to special case bamt == 0.
+  if (sizeof(T) != 8) {
+    return 0;
+  }
+  const auto vw = words_per(256);
+  const auto lcnt = _mm_set_epi64x(0, bamt);
+  const auto rcnt = _mm_set_epi64x(0, 64 - bamt);
+  size_t w = n;
+  for (; w >= delta+1+vw; w -= vw) {
+    const auto hi = _mm256_loadu_si256((const __m256i*)(a+w-vw-delta));
+    const auto lo = _mm256_loadu_si256((const __m256i*)(a+w-vw-delta-1));
+    _mm256_storeu_si256((__m256i*)(r+w-vw), _mm256_or_si256(_mm256_sll_epi64(hi, lcnt), _mm256_srl_epi64(lo, rcnt)));
+  }
+  return n-w;
+}
+
+template <typename T>
+inline size_t WordLogic<T>::shift_right_avx2(const T* a, T* r, size_t n, size_t delta, size_t bamt) {
+  // See the comment in shift_left_avx2(). 
+  if (sizeof(T) != 8) {
+    return 0;
+  }
+  const auto vw = words_per(256);
+  const auto rcnt = _mm_set_epi64x(0, bamt);
+  const auto lcnt = _mm_set_epi64x(0, 64 - bamt);
+  size_t w = 0;
+  for (; w+delta+vw+1 <= n; w += vw) {
+    const auto lo = _mm256_loadu_si256((const __m256i*)(a+w+delta));
+    const auto hi = _mm256_loadu_si256((const __m256i*)(a+w+delta+1));
+    _mm256_storeu_si256((__m256i*)(r+w), _mm256_or_si256(_mm256_srl_epi64(lo, rcnt), _mm256_sll_epi64(hi, lcnt)));
+  }
+  return w;
+}
+
+#endif
+
+} // namespace cascade
+
+#endif
@@ -0,0 +1,298 @@
+// Copyright 2017-2018 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CASCADE_SRC_BASE_CONTAINER_SMALL_VECTOR_H
+#define CASCADE_SRC_BASE_CONTAINER_SMALL_VECTOR_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <stdint.h>
+#include <type_traits>
+
+namespace cascade {
+
+// A resizable array of trivially copyable values which keeps its first N
+// elements inline and only spills to the heap when it grows beyond that.
+// The interface is the subset of std::vector that we actually use. Storage is
+// never released on shrinking, so repeatedly assigning values of similar size
+// to the same object never touches the allocator.
+
+template <typename T, size_t N>
+class SmallVector {
+  public:
+    // Iterators:
+    typedef T* iterator;
+    typedef const T* const_iterator;
+
+    // Constructors:
+    SmallVector();
+    SmallVector(const SmallVector& rhs);
+    SmallVector(SmallVector&& rhs);
+    SmallVector& operator=(const SmallVector& rhs);
+    SmallVector& operator=(SmallVector&& rhs);
+    ~SmallVector();
+
+    // Size:
+    bool empty() const;
+    size_t size() const;
+    size_t capacity() const;
+    bool is_inline() const;
+    void resize(size_t n, T t = T());
+    void reserve(size_t n);
+    void clear();
+
+    // Element Access:
+    T& operator[](size_t n);
+    const T& operator[](size_t n) const;
+    T& front();
+    const T& front() const;
+    T& back();
+    const T& back() const;
+    T* data();
+    const T* data() const;
+    void push_back(T t);
+
+    // Iterator Interface:
+    iterator begin();
+    const_iterator begin() const;
+    iterator end();
+    const_iterator end() const;
+
+  private:
+    static_assert(std::is_trivially_copyable<T>::value, "SmallVector requires trivially copyable elements");
+    static_assert(N > 0, "SmallVector requires at least one inline element");
+
+    T* data_;
+    uint32_t size_;
+    uint32_t capacity_;
+    T inline_[N];
+
+    // Moves to a heap buffer with room for at least n elements
+    void grow(size_t n);
+    // Returns heap storage to the allocator and resets to inline storage
+    void release();
+};
+
+template <typename T, size_t N>
+inline SmallVector<T, N>::SmallVector() {
+  data_ = inline_;
+  size_ = 0;
+  capacity_ = N;
+}
+
+template <typename T, size_t N>
+inline SmallVector<T, N>::SmallVector(const SmallVector& rhs) : SmallVector() {
+  *this = rhs;
+}
+
+template <typename T, size_t N>
+inline SmallVector<T, N>::SmallVector(SmallVector&& rhs) : SmallVector() {
+  *this = std::move(rhs);
+}
+
+template <typename T, size_t N>
+inline SmallVector<T, N>& SmallVector<T, N>::operator=(const SmallVector& rhs) {
+  if (this == &rhs) {
+    return *this;
+  }
+  // Common Case: Everything fits in the storage we already have
+  if (rhs.size_ > capacity_) {
+    grow(rhs.size_);
+  }
+  std::memcpy(data_, rhs.data_, rhs.size_ * sizeof(T));
+  size_ = rhs.size_;
+  return *this;
+}
+
+template <typename T, size_t N>
+inline SmallVector<T, N>& SmallVector<T, N>::operator=(SmallVector&& rhs) {
+  if (this == &rhs) {
+    return *this;
+  }
+  // Inline values have to be copied, heap values can be stolen outright
+  if (rhs.is_inline()) {
+    *this = static_cast<const SmallVector&>(rhs);
+  } else {
+    release();
+    data_ = rhs.data_;
+    size_ = rhs.size_;
+    capacity_ = rhs.capacity_;
+    rhs.data_ = rhs.inline_;
+    rhs.capacity_ = N;
+  }
+  rhs.size_ = 0;
+  return *this;
+}
+
+template <typename T, size_t N>
+inline SmallVector<T, N>::~SmallVector() {
+  release();
+}
+
+template <typename T, size_t N>
+inline bool SmallVector<T, N>::empty() const {
+  return size_ == 0;
+}
+
+template <typename T, size_t N>
+inline size_t SmallVector<T, N>::size() const {
+  return size_;
+}
+
+template <typename T, size_t N>
+inline size_t SmallVector<T, N>::capacity() const {
+  return capacity_;
+}
+
+template <typename T, size_t N>
+inline bool SmallVector<T, N>::is_inline() const {
+  return data_ == inline_;
+}
+
+template <typename T, size_t N>
+inline void SmallVector<T, N>::resize(size_t n, T t) {
+  if (n > capacity_) {
+    grow(std::max(n, 2 * (size_t)capacity_));
+  }
+  for (size_t i = size_; i < n; ++i) {
+    data_[i] = t;
+  }
+  size_ = n;
+}
+
+template <typename T, size_t N>
+inline void SmallVector<T, N>::reserve(size_t n) {
+  if (n > capacity_) {
+    grow(n);
+  }
+}
+
+template <typename T, size_t N>
+inline void SmallVector<T, N>::clear() {
+  size_ = 0;
+}
+
+template <typename T, size_t N>
+inline T& SmallVector<T, N>::operator[](size_t n) {
+  assert(n < size_);
+  return data_[n];
+}
+
+template <typename T, size_t N>
+inline const T& SmallVector<T, N>::operator[](size_t n) const {
+  assert(n < size_);
+  return data_[n];
+}
+
+template <typename T, size_t N>
+inline T& SmallVector<T, N>::front() {
+  assert(size_ > 0);
+  return data_[0];
+}
+
+template <typename T, size_t N>
+inline const T& SmallVector<T, N>::front() const {
+  assert(size_ > 0);
+  return data_[0];
+}
+
+template <typename T, size_t N>
+inline T& SmallVector<T, N>::back() {
+  assert(size_ > 0);
+  return data_[size_-1];
+}
+
+template <typename T, size_t N>
+inline const T& SmallVector<T, N>::back() const {
+  assert(size_ > 0);
+  return data_[size_-1];
+}
+
+template <typename T, size_t N>
+inline T* SmallVector<T, N>::data() {
+  return data_;
+}
+
+template <typename T, size_t N>
+inline const T* SmallVector<T, N>::data() const {
+  return data_;
+}
+
+template <typename T, size_t N>
+inline void SmallVector<T, N>::push_back(T t) {
+  if (size_ == capacity_) {
+    grow(2 * (size_t)capacity_);
+  }
+  data_[size_++] = t;
+}
+
+template <typename T, size_t N>
+inline typename SmallVector<T, N>::iterator SmallVector<T, N>::begin() {
+  return data_;
+}
+
+template <typename T, size_t N>
+inline typename SmallVector<T, N>::const_iterator SmallVector<T, N>::begin() const {
+  return data_;
+}
+
+template <typename T, size_t N>
+inline typename SmallVector<T, N>::iterator SmallVector<T, N>::end() {
+  return data_ + size_;
+}
+
+template <typename T, size_t N>
+inline typename SmallVector<T, N>::const_iterator SmallVector<T, N>::end() const {
+  return data_ + size_;
+}
+
+template <typename T, size_t N>
+inline void SmallVector<T, N>::grow(size_t n) {
+  assert(n > capacity_);
+  auto buf = new T[n];
+  std::memcpy(buf, data_, size_ * sizeof(T));
+  release();
+  data_ = buf;
+  capacity_ = n;
+}
+
+template <typename T, size_t N>
+inline void SmallVector<T, N>::release() {
+  if (!is_inline()) {
+    delete[] data_;
+    data_ = inline_;
+    capacity_ = N;
+  }
+}
+
+} // namespace cascade
+
+#endif
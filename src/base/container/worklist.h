@@ -0,0 +1,137 @@
+// Copyright 2017-2018 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CASCADE_SRC_BASE_CONTAINER_WORKLIST_H
+#define CASCADE_SRC_BASE_CONTAINER_WORKLIST_H
+
+#include <cassert>
+#include <stdint.h>
+#include <vector>
+
+namespace cascade {
+
+// A set of pending work items, identified by index and stored as a bitset.
+// Marking an item is constant time and visiting the marked items takes time
+// proportional to the number of items divided by 64 rather than to the
+// number of items.
+
+class Worklist {
+  public:
+    // Constructors:
+    Worklist();
+
+    // Size:
+    bool empty() const;
+    size_t size() const;
+    // Resizes the worklist to hold n items and unmarks all of them
+    void resize(size_t n);
+
+    // Marking Interface:
+    void mark(size_t i);
+    void mark_all();
+    void unmark(size_t i);
+
+    // Visits each marked item in ascending order, unmarking it first. Items
+    // which are marked during the visit are also visited, as long as their
+    // index is greater than the one being visited. Everything else is left
+    // for the next call. If f returns true, the item is marked again.
+    template <typename F>
+    void drain(F f);
+
+  private:
+    std::vector<uint64_t> words_;
+    size_t size_;
+    size_t count_;
+};
+
+inline Worklist::Worklist() {
+  size_ = 0;
+  count_ = 0;
+}
+
+inline bool Worklist::empty() const {
+  return count_ == 0;
+}
+
+inline size_t Worklist::size() const {
+  return size_;
+}
+
+inline void Worklist::resize(size_t n) {
+  words_.assign((n+63)/64, 0);
+  size_ = n;
+  count_ = 0;
+}
+
+inline void Worklist::mark(size_t i) {
+  assert(i < size_);
+  auto& w = words_[i/64];
+  const auto mask = uint64_t(1) << (i%64);
+  if ((w & mask) == 0) {
+    w |= mask;
+    ++count_;
+  }
+}
+
+inline void Worklist::mark_all() {
+  for (size_t i = 0; i < size_; ++i) {
+    mark(i);
+  }
+}
+
+inline void Worklist::unmark(size_t i) {
+  assert(i < size_);
+  auto& w = words_[i/64];
+  const auto mask = uint64_t(1) << (i%64);
+  if ((w & mask) != 0) {
+    w &= ~mask;
+    --count_;
+  }
+}
+
+template <typename F>
+inline void Worklist::drain(F f) {
+  for (size_t i = 0, ie = words_.size(); (i < ie) && (count_ > 0); ++i) {
+    for (auto bits = words_[i]; bits != 0; ) {
+      const auto b = __builtin_ctzll(bits);
+      const auto mask = uint64_t(1) << b;
+      words_[i] &= ~mask;
+      --count_;
+      if (f(64*i + b)) {
+        mark(64*i + b);
+      }
+      bits = words_[i] & ~((mask << 1) - 1);
+    }
+  }
+}
+
+} // namespace cascade
+
+#endif
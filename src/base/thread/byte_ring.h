@@ -0,0 +1,175 @@
+// Copyright 2017-2018 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CASCADE_SRC_BASE_THREAD_BYTE_RING_H
+#define CASCADE_SRC_BASE_THREAD_BYTE_RING_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace cascade {
+
+// A fixed-size, lock-free, multi-producer single-consumer ring of byte
+// strings. Producers reserve space by bumping the head and then commit their
+// record by publishing its length. Pushes never block; if there isn't enough
+// room they fail and the caller is expected to fall back on something else.
+// The consumer drains records in reservation order, and stops at the first
+// record which hasn't been committed yet. Positions are 64-bit byte offsets
+// which never wrap, so they can be used to order records against other
+// events.
+
+class ByteRing {
+  public:
+    // Constructors:
+    explicit ByteRing(size_t capacity);
+    ByteRing(const ByteRing& rhs) = delete;
+    ByteRing& operator=(const ByteRing& rhs) = delete;
+    ~ByteRing() = default;
+
+    // Producer Interface:
+    //
+    // Appends n bytes starting at s as a single record. Returns false if there
+    // isn't enough room.
+    bool push(const char* s, size_t n);
+    // Returns the position at which the next record will be reserved.
+    uint64_t head() const;
+
+    // Consumer Interface:
+    //
+    // Returns true if no records have been reserved since the last drain.
+    bool empty() const;
+    // Appends the contents of every record reserved before pos to res.
+    void drain(uint64_t pos, std::string& res);
+    // Appends the contents of every record to res.
+    void drain(std::string& res);
+    // Discards every record.
+    void clear();
+
+  private:
+    // Record data. Records are aligned to 8 byte boundaries, and each 8 byte
+    // block has a corresponding length. A length of zero means that no
+    // record starts there or that it hasn't been committed yet. Otherwise
+    // it's one more than the number of bytes in the record.
+    std::vector<char> buf_;
+    std::vector<std::atomic<uint32_t>> lens_;
+    uint64_t mask_;
+
+    std::atomic<uint64_t> head_;
+    std::atomic<uint64_t> tail_;
+
+    // Rounds capacity up to the nearest power of two, no smaller than 8
+    static size_t round(size_t capacity);
+    // Returns the number of bytes that a record of length n occupies
+    static uint64_t stride(size_t n);
+};
+
+inline ByteRing::ByteRing(size_t capacity) : buf_(round(capacity)), lens_(buf_.size()/8) {
+  for (auto& l : lens_) {
+    l.store(0, std::memory_order_relaxed);
+  }
+  mask_ = buf_.size()-1;
+  head_.store(0, std::memory_order_relaxed);
+  tail_.store(0, std::memory_order_relaxed);
+}
+
+inline bool ByteRing::push(const char* s, size_t n) {
+  const auto sz = stride(n);
+  if ((sz > buf_.size()) || (n >= UINT32_MAX)) {
+    return false;
+  }
+  auto h = head_.load(std::memory_order_relaxed);
+  do {
+    if (h + sz - tail_.load(std::memory_order_acquire) > buf_.size()) {
+      return false;
+    }
+  } while (!head_.compare_exchange_weak(h, h + sz, std::memory_order_relaxed));
+
+  const auto off = h & mask_;
+  const auto first = std::min<uint64_t>(n, buf_.size() - off);
+  memcpy(buf_.data() + off, s, first);
+  memcpy(buf_.data(), s + first, n - first);
+  lens_[off/8].store(n+1, std::memory_order_release);
+  return true;
+}
+
+inline uint64_t ByteRing::head() const {
+  return head_.load(std::memory_order_acquire);
+}
+
+inline bool ByteRing::empty() const {
+  return tail_.load(std::memory_order_relaxed) == head_.load(std::memory_order_acquire);
+}
+
+inline void ByteRing::drain(uint64_t pos, std::string& res) {
+  auto t = tail_.load(std::memory_order_relaxed);
+  while (t < pos) {
+    const auto off = t & mask_;
+    const auto len = lens_[off/8].load(std::memory_order_acquire);
+    if (len == 0) {
+      break;
+    }
+    const auto n = len-1;
+    const auto first = std::min<uint64_t>(n, buf_.size() - off);
+    res.append(buf_.data() + off, first);
+    res.append(buf_.data(), n - first);
+    lens_[off/8].store(0, std::memory_order_relaxed);
+    t += stride(n);
+  }
+  tail_.store(t, std::memory_order_release);
+}
+
+inline void ByteRing::drain(std::string& res) {
+  drain(UINT64_MAX, res);
+}
+
+inline void ByteRing::clear() {
+  std::string res;
+  drain(res);
+}
+
+inline size_t ByteRing::round(size_t capacity) {
+  size_t res = 8;
+  while (res < capacity) {
+    res <<= 1;
+  }
+  return res;
+}
+
+inline uint64_t ByteRing::stride(size_t n) {
+  return std::max<uint64_t>(8, (n + 7) & ~uint64_t(7));
+}
+
+} // namespace cascade
+
+#endif
@@ -0,0 +1,187 @@
+// Copyright 2017-2018 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CASCADE_SRC_BASE_THREAD_FORK_JOIN_POOL_H
+#define CASCADE_SRC_BASE_THREAD_FORK_JOIN_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cascade {
+
+// This class represents a fixed set of threads which can be used to run the
+// same job over a range of indices and block until it's done. The thread
+// which calls run() takes part in the work. Indices are handed out one at a
+// time, so threads which finish early keep taking work from the rest.
+
+class ForkJoinPool {
+  public:
+    // Job Typedef:
+    typedef std::function<void(size_t)> Job;
+
+    // Constructors:
+    ForkJoinPool();
+    ForkJoinPool(const ForkJoinPool& rhs) = delete;
+    ForkJoinPool& operator=(const ForkJoinPool& rhs) = delete;
+    ~ForkJoinPool();
+
+    // Parameter Interface:
+    //
+    // Sets the total number of threads which run jobs, including the caller
+    // of run(). Blocks until any existing threads have exited.
+    ForkJoinPool& set_num_threads(size_t n);
+    size_t get_num_threads() const;
+
+    // Invokes job on every index in [0, n) and blocks until every invocation
+    // has returned.
+    void run(size_t n, const Job& job);
+
+  private:
+    std::mutex lock_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;
+    std::vector<std::thread> threads_;
+    bool stop_;
+
+    // The current job. Threads which wake up after a job is done see n_ = 0
+    // and go back to sleep.
+    size_t generation_;
+    const Job* job_;
+    size_t n_;
+    std::atomic<size_t> next_;
+    size_t active_;
+
+    // Runs indices of job until there aren't any left
+    void work(const Job* job, size_t n);
+    // Asks every thread to exit and joins them
+    void shutdown();
+};
+
+inline ForkJoinPool::ForkJoinPool() {
+  stop_ = false;
+  generation_ = 0;
+  job_ = nullptr;
+  n_ = 0;
+  next_ = 0;
+  active_ = 0;
+}
+
+inline ForkJoinPool::~ForkJoinPool() {
+  shutdown();
+}
+
+inline ForkJoinPool& ForkJoinPool::set_num_threads(size_t n) {
+  shutdown();
+  stop_ = false;
+  for (size_t i = 1; i < n; ++i) {
+    threads_.push_back(std::thread([this, g = generation_]{
+      for (auto seen = g; ; ) {
+        const Job* job = nullptr;
+        size_t n = 0;
+        {
+          std::unique_lock<std::mutex> ul(lock_);
+          work_cv_.wait(ul, [this, seen]{return stop_ || (generation_ != seen);});
+          if (stop_) {
+            return;
+          }
+          seen = generation_;
+          job = job_;
+          n = n_;
+          ++active_;
+        }
+        work(job, n);
+        {
+          std::lock_guard<std::mutex> lg(lock_);
+          if (--active_ == 0) {
+            done_cv_.notify_one();
+          }
+        }
+      }
+    }));
+  }
+  return *this;
+}
+
+inline size_t ForkJoinPool::get_num_threads() const {
+  return threads_.size() + 1;
+}
+
+inline void ForkJoinPool::run(size_t n, const Job& job) {
+  if (threads_.empty() || (n <= 1)) {
+    for (size_t i = 0; i < n; ++i) {
+      job(i);
+    }
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lg(lock_);
+    job_ = &job;
+    n_ = n;
+    next_ = 0;
+    ++generation_;
+  }
+  work_cv_.notify_all();
+  work(&job, n);
+
+  std::unique_lock<std::mutex> ul(lock_);
+  done_cv_.wait(ul, [this]{return active_ == 0;});
+  job_ = nullptr;
+  n_ = 0;
+}
+
+inline void ForkJoinPool::work(const Job* job, size_t n) {
+  if (n == 0) {
+    return;
+  }
+  for (auto i = next_.fetch_add(1); i < n; i = next_.fetch_add(1)) {
+    (*job)(i);
+  }
+}
+
+inline void ForkJoinPool::shutdown() {
+  {
+    std::lock_guard<std::mutex> lg(lock_);
+    stop_ = true;
+  }
+  work_cv_.notify_all();
+  for (auto& t : threads_) {
+    t.join();
+  }
+  threads_.clear();
+}
+
+} // namespace cascade
+
+#endif
@@ -53,6 +53,10 @@ void DataPlane::register_id(const VId id) {
   }
 }
 
+size_t DataPlane::size() const {
+  return readers_.size();
+}
+
 void DataPlane::register_reader(Engine* e, VId id) {
   assert(id < readers_.size());
   if (reader_find(e, id) == reader_end(id)) {
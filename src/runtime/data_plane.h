@@ -55,6 +55,8 @@ class DataPlane {
 
     // Id Interface:
     void register_id(VId id);
+    // Returns one more than the largest id which has been registered
+    size_t size() const;
 
     // Reader Interface:
     void register_reader(Engine* e, VId id);
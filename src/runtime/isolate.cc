@@ -237,6 +237,11 @@ ModuleDeclaration* Isolate::get_shell() {
     const auto r = info.is_read(p);
     const auto w = info.is_write(p);
     const auto width = Evaluate().get_width(p);
+    // Ports which belong to a child may have been declared as output regs.
+    const auto rd = dynamic_cast<const RegDeclaration*>(p->get_parent());
+    const auto is_signed = (rd != nullptr) ? 
+      rd->get_signed() : 
+      dynamic_cast<const NetDeclaration*>(p->get_parent())->get_signed();
 
     // TODO: Is this logic correct? When should a global read/write be promoted
     // to a register and when should it remain a net?
@@ -244,20 +249,20 @@ ModuleDeclaration* Isolate::get_shell() {
     auto pd = new PortDeclaration(
       new Attributes(new Many<AttrSpec>()), 
       r && w ? PortDeclaration::INOUT : r ? PortDeclaration::INPUT : PortDeclaration::OUTPUT,
-      (info.is_local(p) && dynamic_cast<const RegDeclaration*>(p->get_parent())) ? 
+      (info.is_local(p) && (rd != nullptr)) ? 
         (Declaration*) new RegDeclaration(
           new Attributes(new Many<AttrSpec>()),
           to_global_id(p),
-          dynamic_cast<const RegDeclaration*>(p->get_parent())->get_signed(), 
+          is_signed,
           width == 1 ? new Maybe<RangeExpression>() : new Maybe<RangeExpression>(new RangeExpression(width)),
-          dynamic_cast<RegDeclaration*>(p->get_parent())->get_val()->clone()
+          rd->get_val()->clone()
         ) : 
         (Declaration*) new NetDeclaration(
           new Attributes(new Many<AttrSpec>()),
           NetDeclaration::WIRE,
           new Maybe<DelayControl>(),
           to_global_id(p),
-          dynamic_cast<const NetDeclaration*>(p->get_parent())->get_signed(),
+          is_signed,
           width == 1 ? new Maybe<RangeExpression>() : new Maybe<RangeExpression>(new RangeExpression(width))
         )
     );
@@ -30,11 +30,14 @@
 
 #include "src/runtime/runtime.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cctype>
+#include <chrono>
 #include <iostream>
 #include <limits>
 #include <sstream>
+#include <unordered_map>
 #include "src/base/stream/incstream.h"
 #include "src/base/stream/indstream.h"
 #include "src/runtime/data_plane.h"
@@ -52,7 +55,12 @@ using namespace std;
 
 namespace cascade {
 
-Runtime::Runtime(View* view) : Asynchronous() {
+// The runtime whose interrupt queue is being drained by this thread, if any
+static thread_local Runtime* draining = nullptr;
+
+thread_local Runtime::Log* Runtime::log_ = nullptr;
+
+Runtime::Runtime(View* view) : Asynchronous(), text_(1 << 16) {
   view_ = view;
 
   parser_ = new Parser();
@@ -64,8 +72,13 @@ Runtime::Runtime(View* view) : Asynchronous() {
   root_ = nullptr;
 
   enable_open_loop_ = false;
+  enable_coscheduling_ = false;
   open_loop_itrs_ = 2;
-  open_loop_target_ = 1;
+  open_loop_target_ = 1000;
+  open_loop_rate_ = 0;
+
+  int_pending_ = false;
+  sim_threads_ = 1;
   disable_inlining_ = false;
   disable_warnings_ = false;
 
@@ -110,6 +123,12 @@ Runtime& Runtime::set_open_loop_target(size_t olt) {
   return *this;
 }
 
+Runtime& Runtime::set_sim_threads(size_t n) {
+  sim_threads_ = max<size_t>(n, 1);
+  pool_.set_num_threads(sim_threads_);
+  return *this;
+}
+
 Runtime& Runtime::disable_inlining(bool di) {
   disable_inlining_ = di;
   return *this;
@@ -141,15 +160,11 @@ void Runtime::eval(istream& is, bool is_term) {
 }
 
 void Runtime::display(const string& s) {
-  schedule_interrupt(Interrupt([this, s]{
-    view_->print(logical_time_, s + "\n");
-  }));
+  buffer_text(s + "\n");
 }
 
 void Runtime::write(const string& s) {
-  schedule_interrupt(Interrupt([this, s]{
-    view_->print(logical_time_, s);
-  }));
+  buffer_text(s);
 }
 
 void Runtime::finish(int arg) {
@@ -187,8 +202,22 @@ void Runtime::fatal(int arg, const string& s) {
 }
 
 void Runtime::schedule_interrupt(Interrupt int_) {
-  lock_guard<recursive_mutex> lg(int_lock_);
-  ints_.push_back(int_);
+  if (log_ != nullptr) {
+    log_->tasks.push_back([this, int_]{
+      schedule_interrupt(int_);
+    });
+    return;
+  }
+  if (draining == this) {
+    int_batch_.push_back(make_pair(text_.head(), move(int_)));
+    return;
+  } 
+  ints_.push(make_pair(text_.head(), move(int_)));
+  int_pending_ = true;
+}
+
+bool Runtime::pending_interrupt() const {
+  return int_pending_.load(memory_order_relaxed);
 }
 
 void Runtime::write(VId id, const Bits* bits) {
@@ -225,6 +254,8 @@ void Runtime::run_logic() {
   while (!stop_requested()) {
     if (enable_open_loop_ && !schedule_all_) {
       open_loop_scheduler();
+    } else if (enable_coscheduling_ && !schedule_all_) {
+      coscheduler();
     } else {
       reference_scheduler();
     }
@@ -358,11 +389,15 @@ void Runtime::rebuild() {
   } 
 
   // Clear scheduling state
+  for (auto m : logic_) {
+    m->engine()->set_worklists(nullptr, nullptr, 0);
+  }
   logic_.clear();
   done_logic_.clear();
   clock_ = nullptr;
   inlined_logic_ = nullptr;
   // Reconfigure scheduling state and determine whether optimizations are possible
+  size_t num_logic = 0;
   for (auto m : *root_) {
     if (m->engine()->is_stub()) {
       continue;
@@ -373,39 +408,226 @@ void Runtime::rebuild() {
     }
     if (m->engine()->is_logic()) {
       inlined_logic_ = m;
+      ++num_logic;
     }
     if (m->engine()->overrides_done_step()) {
       done_logic_.push_back(m);
     }
   }
+  if (sim_threads_ > 1) {
+    build_groups();
+  } else {
+    reads_.resize(logic_.size());
+    updates_.resize(logic_.size());
+    for (size_t i = 0, ie = logic_.size(); i < ie; ++i) {
+      logic_[i]->engine()->set_worklists(&reads_, &updates_, i);
+      if (logic_[i]->engine()->there_are_reads()) {
+        reads_.mark(i);
+      }
+    }
+    updates_.mark_all();
+  }
   schedule_all_ = true;
-  enable_open_loop_ = (logic_.size() == 2) && (clock_ != nullptr) && (inlined_logic_ != nullptr);
+  enable_open_loop_ = (inlined_logic_ != nullptr) && ((logic_.size() == 1) || ((logic_.size() == 2) && (clock_ != nullptr)));
+  // If the program has been inlined into a single logic core, but that core
+  // is connected to standard library components, we can still avoid going
+  // back to the runtime between time steps.
+  enable_coscheduling_ = !enable_open_loop_ && (num_logic == 1) && (clock_ != nullptr);
+}
+
+void Runtime::build_groups() {
+  // Engines which read or write the same variable belong to the same group.
+  // Groups are numbered by the first engine they contain, and engines are
+  // numbered within their group in the same order as in logic_.
+  unordered_map<const Engine*, size_t> idx;
+  vector<size_t> parent(logic_.size());
+  for (size_t i = 0, ie = logic_.size(); i < ie; ++i) {
+    idx[logic_[i]->engine()] = i;
+    parent[i] = i;
+  }
+  const auto find = [&parent](size_t i) {
+    while (parent[i] != i) {
+      i = parent[i] = parent[parent[i]];
+    }
+    return i;
+  };
+  const auto join = [&idx, &parent, &find](const Engine* e, size_t& root) {
+    const auto itr = idx.find(e);
+    if (itr == idx.end()) {
+      return;
+    }
+    const auto r = find(itr->second);
+    if (root == size_t(-1)) {
+      root = r;
+    } else if (r != root) {
+      parent[max(r, root)] = min(r, root);
+      root = min(r, root);
+    }
+  };
+  for (VId id = 0, ie = dp_->size(); id < ie; ++id) {
+    auto root = size_t(-1);
+    for (auto i = dp_->reader_begin(id), ie = dp_->reader_end(id); i != ie; ++i) {
+      join(*i, root);
+    }
+    for (auto i = dp_->writer_begin(id), ie = dp_->writer_end(id); i != ie; ++i) {
+      join(*i, root);
+    }
+  }
+
+  groups_.clear();
+  vector<size_t> group(logic_.size());
+  for (size_t i = 0, ie = logic_.size(); i < ie; ++i) {
+    const auto r = find(i);
+    if (r == i) {
+      group[i] = groups_.size();
+      groups_.emplace_back();
+      groups_.back().thread_safe = true;
+    } else {
+      group[i] = group[r];
+    }
+    auto& g = groups_[group[i]];
+    g.engines.push_back(i);
+    g.thread_safe &= logic_[i]->engine()->is_thread_safe();
+  }
+  for (auto& g : groups_) {
+    g.reads.resize(g.engines.size());
+    g.updates.resize(g.engines.size());
+    for (size_t j = 0, je = g.engines.size(); j < je; ++j) {
+      const auto e = logic_[g.engines[j]]->engine();
+      e->set_worklists(&g.reads, &g.updates, j);
+      if (e->there_are_reads()) {
+        g.reads.mark(j);
+      }
+    }
+    g.updates.mark_all();
+  }
+  logs_.resize(logic_.size());
 }
 
 void Runtime::drain_active() {
-  for (auto done = false; !done; ) {
-    done = true;
+  if (sim_threads_ > 1) {
+    return drain_active_groups();
+  }
+  if (schedule_all_) {
     for (auto m : logic_) {
-      if (schedule_all_ || m->engine()->there_are_reads()) {
-        m->engine()->evaluate();
-        done = false;
-      }
+      m->engine()->evaluate();
     }
     schedule_all_ = false;
   }
+  // Engines may still be on the worklist after they've had their reads
+  // cleared by an update. There's no harm in skipping them.
+  while (!reads_.empty()) {
+    reads_.drain([this](size_t i) {
+      logic_[i]->engine()->conditional_evaluate();
+      return false;
+    });
+  }
 }
 
 bool Runtime::drain_updates() {
+  if (sim_threads_ > 1) {
+    return drain_updates_groups();
+  }
+  // Engines stay on the update worklist until they report that they have
+  // nothing left to do.
   auto performed_update = false;
-  for (auto m : logic_) {
-    performed_update |= m->engine()->conditional_update();
+  updates_.drain([this, &performed_update](size_t i) {
+    const auto res = logic_[i]->engine()->conditional_update();
+    performed_update |= res;
+    return res;
+  });
+  if (!performed_update) {
+    return false;
+  }
+  auto performed_evaluate = false;
+  reads_.drain([this, &performed_evaluate](size_t i) {
+    performed_evaluate |= logic_[i]->engine()->conditional_evaluate();
+    return false;
+  });
+  return performed_evaluate;
+}
+
+void Runtime::drain_active_groups() {
+  // Same as drain_active(), except that each pass over the worklists runs
+  // every group at once. Since no two groups share a variable, the engines in
+  // each group see exactly what they would have seen serially.
+  if (schedule_all_) {
+    batch_.clear();
+    for (size_t i = 0, ie = groups_.size(); i < ie; ++i) {
+      batch_.push_back(i);
+    }
+    run_batch([this](Group& g) {
+      for (auto i : g.engines) {
+        log_ = &logs_[i];
+        logic_[i]->engine()->evaluate();
+      }
+    });
+    schedule_all_ = false;
+  }
+  while (true) {
+    batch_.clear();
+    for (size_t i = 0, ie = groups_.size(); i < ie; ++i) {
+      if (!groups_[i].reads.empty()) {
+        batch_.push_back(i);
+      }
+    }
+    if (batch_.empty()) {
+      return;
+    }
+    run_batch([this](Group& g) {
+      g.reads.drain([this, &g](size_t j) {
+        log_ = &logs_[g.engines[j]];
+        logic_[g.engines[j]]->engine()->conditional_evaluate();
+        return false;
+      });
+    });
+  }
+}
+
+bool Runtime::drain_updates_groups() {
+  // Same as drain_updates(), except that each pass over the worklists runs
+  // every group at once. Groups record whether they did anything in their
+  // result flag.
+  batch_.clear();
+  for (size_t i = 0, ie = groups_.size(); i < ie; ++i) {
+    if (!groups_[i].updates.empty()) {
+      batch_.push_back(i);
+    }
+  }
+  run_batch([this](Group& g) {
+    g.result = false;
+    g.updates.drain([this, &g](size_t j) {
+      log_ = &logs_[g.engines[j]];
+      const auto res = logic_[g.engines[j]]->engine()->conditional_update();
+      g.result |= res;
+      return res;
+    });
+  });
+  auto performed_update = false;
+  for (auto i : batch_) {
+    performed_update |= groups_[i].result;
   }
   if (!performed_update) {
     return false;
   }
+
+  batch_.clear();
+  for (size_t i = 0, ie = groups_.size(); i < ie; ++i) {
+    if (!groups_[i].reads.empty()) {
+      batch_.push_back(i);
+    }
+  }
+  run_batch([this](Group& g) {
+    g.result = false;
+    g.reads.drain([this, &g](size_t j) {
+      log_ = &logs_[g.engines[j]];
+      g.result |= logic_[g.engines[j]]->engine()->conditional_evaluate();
+      return false;
+    });
+  });
   auto performed_evaluate = false;
-  for (auto m : logic_) {
-    performed_evaluate |= m->engine()->conditional_evaluate();
+  for (auto i : batch_) {
+    performed_evaluate |= groups_[i].result;
   }
   return performed_evaluate;
 }
@@ -418,39 +640,115 @@ void Runtime::done_step() {
 
 void Runtime::drain_interrupts() {
   // Performance Note:
-  // This is an inner loop method, so we shouldn't be grabbing a lock here
-  // unless we absolutely have to. This method is only ever called between
-  // logical time steps, so there's no reason to worry about an engine
-  // scheduling a system task interrupt here. What we do have to worry about
-  // are things like asynchronous jit handoffs.
+  // This is an inner loop method. Both the interrupt queue and the text
+  // buffer are lock-free and this is the only thread which ever drains them,
+  // so checking whether there's anything to do here is cheap. 
   
   // Fast Path: 
-  // Leave immediately if there are no interrupts scheduled. This isn't thread
-  // safe, but the only asynchronous events we need to consider here are jit
-  // handoffs. Since the only thing we risk is a false negative, and whether we
-  // handle the handoff now or during next timestep doesn't really matter, this
-  // is fine. 
-  if (ints_.empty()) {
+  // Leave immediately if there's nothing to do. We might miss an interrupt
+  // which is in the middle of being scheduled by another thread, for instance
+  // a jit handoff. Since the only thing we risk is a false negative, and
+  // whether we handle the handoff now or during next timestep doesn't really
+  // matter, this is fine. 
+  if (ints_.empty() && text_.empty()) {
     return;
   }
 
   // Slow Path: 
-  // We have at least one interrupt. System tasks are benign, but what could be
-  // here is an eval event (which will require a code rebuild) or a jit handoff
-  // (which in addition to the eval event, could trigger a fatal compiler
-  // error). Since we're already on the slow path here, schedule a call at the
-  // very end of the interrupt queue to first check whether the compiler is in
-  // a sound state (ie, jit handoff hasn't failed) and then to rebuild the
-  // codebase.
-  lock_guard<recursive_mutex> lg(int_lock_);
-  item_evals_ = 0;
-  schedule_interrupt(Interrupt([this]{
-    rebuild();
-  }));
-  for (size_t i = 0; i < ints_.size() && !stop_requested(); ++i) {
-    ints_[i]();
+  // We have at least one interrupt or some text to print. System tasks are
+  // benign, but what could be here is an eval event (which will require a
+  // code rebuild) or a jit handoff (which in addition to the eval event, could
+  // trigger a fatal compiler error). Since we're already on the slow path
+  // here, schedule a call at the very end of the batch to first check whether
+  // the compiler is in a sound state (ie, jit handoff hasn't failed) and then
+  // to rebuild the codebase. Interrupts which are scheduled by interrupts are
+  // appended to the end of the batch. Interrupts which are scheduled by other
+  // threads while we're doing this (say, a jit handoff for the code we're
+  // about to rebuild) are left in the queue until the next time step.
+  int_pending_ = false;
+  for (pair<uint64_t, Interrupt> i; ints_.pop(i); ) {
+    int_batch_.push_back(move(i));
+  }
+  if (!int_batch_.empty()) {
+    item_evals_ = 0;
+    int_batch_.push_back(make_pair(text_.head(), Interrupt([this]{
+      rebuild();
+    })));
+  }
+  draining = this;
+  for (size_t i = 0; i < int_batch_.size() && !stop_requested(); ++i) {
+    flush_text(int_batch_[i].first);
+    auto int_ = move(int_batch_[i].second);
+    int_();
+  }
+  draining = nullptr;
+  int_batch_.clear();
+
+  // Print whatever text is left. Just like interrupts, any text which was
+  // produced after a call to $finish is dropped.
+  if (stop_requested()) {
+    text_.clear();
+  } else {
+    flush_text(text_.head());
+  }
+}
+
+void Runtime::run_batch(const function<void(Group&)>& f) {
+  // Groups which contain an engine that isn't thread safe are run one at a
+  // time on this thread once the others are done.
+  parallel_.clear();
+  serial_.clear();
+  for (auto i : batch_) {
+    (groups_[i].thread_safe ? parallel_ : serial_).push_back(i);
+  }
+  pool_.run(parallel_.size(), [this, &f](size_t j) {
+    f(groups_[parallel_[j]]);
+    log_ = nullptr;
+  });
+  for (auto i : serial_) {
+    f(groups_[i]);
+    log_ = nullptr;
+  }
+
+  // Replay the logs in the same order that the engines would have run in.
+  // Every engine runs at most once per pass, so sorting by index is enough.
+  replay_.clear();
+  for (auto i : batch_) {
+    for (auto e : groups_[i].engines) {
+      if (!logs_[e].tasks.empty()) {
+        replay_.push_back(e);
+      }
+    }
+  }
+  sort(replay_.begin(), replay_.end());
+  for (auto e : replay_) {
+    for (const auto& t : logs_[e].tasks) {
+      t();
+    }
+    logs_[e].tasks.clear();
+  }
+}
+
+void Runtime::buffer_text(const string& s) {
+  if (log_ != nullptr) {
+    log_->tasks.push_back([this, s]{
+      buffer_text(s);
+    });
+    return;
+  }
+  if (!text_.push(s.data(), s.length())) {
+    schedule_interrupt(Interrupt([this, s]{
+      view_->print(logical_time_, s);
+    }));
+  }
+}
+
+void Runtime::flush_text(uint64_t pos) {
+  text_batch_.clear();
+  text_.drain(pos, text_batch_);
+  if (!text_batch_.empty()) {
+    view_->print(logical_time_, text_batch_);
   }
-  ints_.clear();
 }
 
 void Runtime::done_simulation() {
@@ -461,28 +759,63 @@ void Runtime::done_simulation() {
 
 void Runtime::open_loop_scheduler() {
   // Record the current time, go open loop, and then record how long we were gone for
-  const size_t then = ::time(nullptr);
-  const auto val = clock_->engine()->get_bit(1);
+  const auto then = chrono::steady_clock::now();
+  const auto val = (clock_ != nullptr) ? clock_->engine()->get_bit(1) : false;
   const auto itrs = inlined_logic_->engine()->open_loop(1, val, open_loop_itrs_);
-  const size_t now = ::time(nullptr);
+  const auto now = chrono::steady_clock::now();
 
   // If we ran for an odd number of iterations, flip the clock
-  if (itrs % 2) {
+  if ((clock_ != nullptr) && (itrs % 2)) {
     clock_->engine()->set_bit(1, !val);
   }
   // Drain the interrupt queue and fix up the logical time
   drain_interrupts();
   logical_time_ += itrs;
 
-  // Update open loop iterations based on our target
-  const auto delta = now - then;
-  auto next = open_loop_itrs_;
-  if ((delta < open_loop_target_) && (open_loop_itrs_ == itrs)) {
-    next <<= 1;
-  } else if (delta > open_loop_target_) {
-    next >>= 1;
+  update_open_loop_itrs(chrono::duration<double, micro>(now - then).count(), itrs);
+}
+
+void Runtime::coscheduler() {
+  // Record the current time, and then run the reference scheduler without
+  // draining the interrupt queue until either we time out or something is
+  // placed there or in the text buffer.
+  const auto then = chrono::steady_clock::now();
+  size_t itrs = 1;
+  for (; ; ++itrs, ++logical_time_) {
+    while (drain_updates()) {
+      drain_active();
+    }
+    done_step();
+    if ((itrs == open_loop_itrs_) || pending_interrupt() || !text_.empty() || stop_requested()) {
+      break;
+    }
+  }
+  const auto now = chrono::steady_clock::now();
+
+  // Drain the interrupt queue and finish the last time step
+  drain_interrupts();
+  ++logical_time_;
+
+  update_open_loop_itrs(chrono::duration<double, micro>(now - then).count(), itrs);
+}
+
+void Runtime::update_open_loop_itrs(double delta, size_t itrs) {
+  // Keep a running estimate of how many iterations we can run per
+  // microsecond. Quanta which were cut short by an interrupt still give us
+  // a sample, as long as they ran long enough to measure.
+  if ((itrs > 0) && (delta > 0)) {
+    const auto rate = itrs / delta;
+    open_loop_rate_ = (open_loop_rate_ == 0) ? rate : (0.75 * open_loop_rate_ + 0.25 * rate);
+  }
+  if (open_loop_rate_ == 0) {
+    return;
   }
-  open_loop_itrs_ = next > 0 ? next : open_loop_itrs_;
+  // Aim for the target latency, but never more than double the quantum at
+  // once. A run of cheap iterations (say, while nothing is sensitive to the
+  // clock) shouldn't commit us to an enormous quantum all at once.
+  const auto next = open_loop_rate_ * open_loop_target_;
+  const auto limit = 2.0 * open_loop_itrs_;
+  open_loop_itrs_ = max<size_t>(1, (size_t) min(next, limit));
 }
 
 void Runtime::reference_scheduler() {
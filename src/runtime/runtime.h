@@ -31,14 +31,19 @@
 #ifndef CASCADE_SRC_RUNTIME_RUNTIME_H
 #define CASCADE_SRC_RUNTIME_RUNTIME_H
 
+#include <atomic>
 #include <ctime>
 #include <functional>
 #include <iosfwd>
-#include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 #include "src/base/bits/bits.h"
+#include "src/base/container/worklist.h"
 #include "src/base/thread/asynchronous.h"
+#include "src/base/thread/byte_ring.h"
+#include "src/base/thread/fork_join_pool.h"
+#include "src/base/thread/mpsc_queue.h"
 #include "src/runtime/ids.h"
 #include "src/verilog/ast/ast_fwd.h"
 
@@ -71,6 +76,7 @@ class Runtime : public Asynchronous {
     Runtime& set_compiler(Compiler* c);
     Runtime& set_include_dirs(const std::string& s);
     Runtime& set_open_loop_target(size_t olt);
+    Runtime& set_sim_threads(size_t n);
     Runtime& disable_inlining(bool di);
     Runtime& disable_warnings(bool dw);
 
@@ -124,6 +130,9 @@ class Runtime : public Asynchronous {
     //
     // Schedules an intterupt on the interrupt queue
     void schedule_interrupt(Interrupt int_);
+    // Returns true if there is at least one interrupt waiting to be
+    // handled. This is cheap enough to call once per open loop iteration.
+    bool pending_interrupt() const;
     // Writes a value to the dataplane. Invoking this method to insert
     // arbitrary values may be useful for simulating noisy circuits. However in
     // general, the use of this method is probably best left to modules which
@@ -165,22 +174,67 @@ class Runtime : public Asynchronous {
     // Optimization State:
     bool disable_inlining_;
     bool enable_open_loop_;
+    bool enable_coscheduling_;
     size_t open_loop_itrs_;
     size_t open_loop_target_;
+    double open_loop_rate_;
 
     // Generic Scheduling State:
+    // The worklists are indexed by position in logic_. Engines mark
+    // themselves when they're sent a value or might have updates, so that we
+    // only ever touch the engines which have something to do.
     std::vector<Module*> logic_;
     std::vector<Module*> done_logic_;
+    Worklist reads_;
+    Worklist updates_;
     bool schedule_all_;
 
+    // Parallel Scheduling State:
+    // When more than one thread is available, engines are partitioned into
+    // groups which don't share any variables, according to the data plane's
+    // reader and writer registries. Each group has its own worklists, and the
+    // groups with something to do in each phase of a time step are run at
+    // once. The engines within a group are run one at a time, in exactly the
+    // order the serial scheduler would run them. Text and interrupts which
+    // engines send to the runtime while they're running are logged, one log
+    // per engine, and replayed in engine order once the phase is over.
+    struct Group {
+      std::vector<size_t> engines;
+      Worklist reads;
+      Worklist updates;
+      bool thread_safe;
+      bool result;
+    };
+    struct Log {
+      std::vector<Interrupt> tasks;
+    };
+    size_t sim_threads_;
+    ForkJoinPool pool_;
+    std::vector<Group> groups_;
+    std::vector<Log> logs_;
+    std::vector<size_t> batch_;
+    std::vector<size_t> parallel_;
+    std::vector<size_t> serial_;
+    std::vector<size_t> replay_;
+    static thread_local Log* log_;
+
     // Optimized Scheduling State:
     Module* clock_;
     Module* inlined_logic_;
 
     // Interrupt Queue:
+    // Interrupts are tagged with the position of the text buffer at the time
+    // they were scheduled, so that text output and interrupts are handled in
+    // the order they were produced. The batch holds the interrupts that are
+    // currently being drained.
     size_t item_evals_;
-    std::vector<Interrupt> ints_;
-    std::recursive_mutex int_lock_;
+    MpscQueue<std::pair<uint64_t, Interrupt>> ints_;
+    std::vector<std::pair<uint64_t, Interrupt>> int_batch_;
+    std::atomic<bool> int_pending_;
+
+    // Text Output Buffer:
+    ByteRing text_;
+    std::string text_batch_;
 
     // Time Keeping:
     time_t begin_time_;
@@ -227,11 +281,30 @@ class Runtime : public Asynchronous {
     void done_step();
     // Drains the interrupt queue
     void drain_interrupts();
+    // Partitions logic_ into groups of engines which share variables
+    void build_groups();
+    // Parallel versions of drain_active() and drain_updates()
+    void drain_active_groups();
+    bool drain_updates_groups();
+    // Invokes f on every group in batch_, concurrently for those that are
+    // thread safe, and then replays their engines' logs in order
+    void run_batch(const std::function<void(Group&)>& f);
+    // Appends text to the output buffer, or schedules an interrupt to print it
+    // if there's no room left
+    void buffer_text(const std::string& s);
+    // Prints the contents of the output buffer up to position pos
+    void flush_text(uint64_t pos);
     // Invokes done_simulation on every module, completing the simulation
     void done_simulation();
 
     // Runs in open loop until timeout or a system task is triggered
     void open_loop_scheduler();
+    // Runs the reference scheduling algorithm in a tight loop until timeout or
+    // an interrupt is scheduled
+    void coscheduler();
+    // Adjusts the number of open loop iterations based on how many
+    // microseconds the last call to either of the above took
+    void update_open_loop_itrs(double delta, size_t itrs);
     // Runs a single iteration of the reference scheduling algoirthm
     void reference_scheduler();
 
@@ -34,6 +34,7 @@
 #include "src/runtime/data_plane.h"
 #include "src/runtime/runtime.h"
 #include "src/target/core/de10/de10_compiler.h"
+#include "src/target/core/native/native_compiler.h"
 #include "src/target/core/proxy/proxy_compiler.h"
 #include "src/target/core/sw/sw_compiler.h"
 #include "src/target/engine.h"
@@ -48,6 +49,7 @@ namespace cascade {
 
 Compiler::Compiler() {
   de10_compiler_ = nullptr;
+  native_compiler_ = nullptr;
   proxy_compiler_ = nullptr;
   sw_compiler_ = nullptr;
 
@@ -67,6 +69,9 @@ Compiler::~Compiler() {
   if (de10_compiler_ != nullptr) {
     de10_compiler_->abort();
   }
+  if (native_compiler_ != nullptr) {
+    native_compiler_->abort();
+  }
   if (proxy_compiler_ != nullptr) {
     proxy_compiler_->abort();
   }
@@ -85,6 +90,9 @@ Compiler::~Compiler() {
   if (de10_compiler_ != nullptr) {
     delete de10_compiler_;
   }
+  if (native_compiler_ != nullptr) {
+    delete native_compiler_;
+  }
   if (proxy_compiler_ != nullptr) {
     delete proxy_compiler_;
   }
@@ -107,6 +115,14 @@ Compiler& Compiler::set_de10_compiler(De10Compiler* c) {
   return *this;
 }
 
+Compiler& Compiler::set_native_compiler(NativeCompiler* c) {
+  assert(native_compiler_ == nullptr);
+  assert(c != nullptr);
+  native_compiler_ = c;
+  native_compiler_->set_compiler(this);
+  return *this;
+}
+
 Compiler& Compiler::set_proxy_compiler(ProxyCompiler* c) {
   assert(proxy_compiler_ == nullptr);
   assert(c != nullptr);
@@ -160,6 +176,8 @@ Engine* Compiler::compile(ModuleDeclaration* md) {
     cc = proxy_compiler_;      
   } else if (target->eq("de10")) {
     cc = de10_compiler_; 
+  } else if (target->eq("native")) {
+    cc = native_compiler_;
   } else if (target->eq("sw")) {
     cc = sw_compiler_;
   } else {
@@ -45,6 +45,7 @@ class De10Compiler;
 class Engine;
 class InterfaceCompiler;
 class LocalCompiler;
+class NativeCompiler;
 class ProxyCompiler;
 class RemoteCompiler;
 class Runtime;
@@ -61,6 +62,7 @@ class Compiler {
     // compile() and they cannot be called more than once. Once you configure a
     // compiler, you're stuck with it.
     Compiler& set_de10_compiler(De10Compiler* c);
+    Compiler& set_native_compiler(NativeCompiler* c);
     Compiler& set_proxy_compiler(ProxyCompiler* c);
     Compiler& set_sw_compiler(SwCompiler* c);
 
@@ -95,6 +97,7 @@ class Compiler {
   private:
     // Core Compilers:
     De10Compiler* de10_compiler_;
+    NativeCompiler* native_compiler_;
     ProxyCompiler* proxy_compiler_;
     SwCompiler* sw_compiler_;
 
@@ -33,12 +33,12 @@
 
 #include "src/base/bits/bits.h"
 #include "src/runtime/ids.h"
+#include "src/target/interface.h"
 
 namespace cascade {
 
 // This class encapsulates the target-specific implementation of module logic.
 
-class Interface;
 class Input;
 class State;
 
@@ -62,6 +62,11 @@ class Core {
     // Target-specific implementations may override this method to perform
     // last minute initialization prior to beginning execution.
     virtual void resync();
+    // Overriding this method to return true allows the runtime to call the
+    // evaluate() and update() methods of this core concurrently with those of
+    // other cores. This is only safe if this core shares no unsynchronized
+    // state with any other core. The default implementation returns false.
+    virtual bool is_thread_safe() const;
 
     // Overriding this method to return true will cause the runtime to call the
     // done_step() method at the end of each logical time step. The default
@@ -113,9 +118,11 @@ class Core {
     // performance-specific advantage to doing so. This method is only called
     // in a state where the entire program has been inlined into this core such
     // that the only input clk, is the runtime's clock, it has value val, and
-    // there are no outputs. This method must run for up to itr iterations, or
-    // until a system task is generated before returning control. On return it
-    // must report the number of iterations that it ran for. 
+    // there are no outputs. If the program doesn't use the clock, clk isn't
+    // an input at all. This method must run for up to itr iterations, or
+    // until a system task is generated or the interface reports a pending
+    // interrupt before returning control. On return it must report the number
+    // of iterations that it ran for. 
     virtual size_t open_loop(VId clk, bool val, size_t itr);
 
   protected:
@@ -185,6 +192,10 @@ inline void Core::resync() {
   // Does nothing.
 }
 
+inline bool Core::is_thread_safe() const {
+  return false;
+}
+
 inline bool Core::overrides_done_step() const {
   return false;
 }
@@ -226,6 +237,9 @@ inline size_t Core::open_loop(VId clk, bool val, size_t itr) {
       tasks |= there_were_tasks();
     }
     done_step();
+    // Pending interrupts are treated just like tasks. Either way, the runtime
+    // needs control back.
+    tasks |= interface()->pending_interrupt();
   }
   return res;  
 }
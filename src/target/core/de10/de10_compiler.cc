@@ -30,12 +30,16 @@
 
 #include "src/target/core/de10/de10_compiler.h"
 
+#include <algorithm>
 #include <fcntl.h>
 #include <sys/mman.h>
 #include <unistd.h>
 #include "src/base/socket/socket.h"
+#include "src/verilog/analyze/constant.h"
 #include "src/verilog/analyze/evaluate.h"
 #include "src/verilog/analyze/module_info.h"
+#include "src/verilog/analyze/read_set.h"
+#include "src/verilog/analyze/resolve.h"
 #include "src/verilog/ast/ast.h"
 
 using namespace std;
@@ -173,6 +177,18 @@ De10Pad* De10Compiler::compile_pad(Interface* interface, ModuleDeclaration* md)
 }
 
 De10Logic* De10Compiler::compile_logic(Interface* interface, ModuleDeclaration* md) {
+  // Check that quartus can synthesize this module. This isn't an error if
+  // we're jit compiling, the module will just stay where it is.
+  SynthCheck sc;
+  if (!sc.check(md)) {
+    const auto t2 = md->get_attrs()->get<String>("__target2");
+    if ((t2 == nullptr) || !t2->eq("de10")) {
+      error(sc.what());
+    }
+    delete md;
+    return nullptr;
+  }
+
   ModuleInfo info(md);
 
   // Check range on mid 
@@ -269,4 +285,102 @@ De10Logic* De10Compiler::compile_logic(Interface* interface, ModuleDeclaration*
   }
 }
 
+bool De10Compiler::SynthCheck::check(const ModuleDeclaration* md) {
+  what_ = "";
+  vars_.clear();
+  loops_ = 0;
+  md->accept(this);
+  return what_ == "";
+}
+
+const string& De10Compiler::SynthCheck::what() const {
+  return what_;
+}
+
+void De10Compiler::SynthCheck::fail(const string& what) {
+  what_ = (what_ == "") ? what : what_;
+}
+
+bool De10Compiler::SynthCheck::is_static(const Expression* e) {
+  // An expression is static if it only depends on constants and the variables
+  // of the loops which enclose it.
+  for (auto i : ReadSet(e)) {
+    const auto r = Resolve().get_resolution(i);
+    if ((find(vars_.begin(), vars_.end(), r) == vars_.end()) && !Constant().is_constant(i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void De10Compiler::SynthCheck::visit(const BlockingAssign* ba) {
+  const auto r = Resolve().get_resolution(ba->get_assign()->get_lhs());
+  if (find(vars_.begin(), vars_.end(), r) != vars_.end()) {
+    fail("Unable to compile a module which assigns to a for loop variable inside of its loop");
+  }
+  Visitor::visit(ba);
+}
+
+void De10Compiler::SynthCheck::visit(const NonblockingAssign* na) {
+  if (loops_ > 0) {
+    fail("Unable to compile a module with a nonblocking assign inside of a loop");
+  }
+  Visitor::visit(na);
+}
+
+void De10Compiler::SynthCheck::visit(const ForStatement* fs) {
+  const auto r = Resolve().get_resolution(fs->get_init()->get_lhs());
+  if ((r == nullptr) || (Resolve().get_resolution(fs->get_update()->get_lhs()) != r) || !is_static(fs->get_init()->get_rhs())) {
+    return fail("Unable to compile a module with a for loop whose bounds aren't static");
+  }
+  vars_.push_back(r);
+  ++loops_;
+  if (!is_static(fs->get_cond()) || !is_static(fs->get_update()->get_rhs())) {
+    fail("Unable to compile a module with a for loop whose bounds aren't static");
+  }
+  fs->get_stmt()->accept(this);
+  --loops_;
+  vars_.pop_back();
+}
+
+void De10Compiler::SynthCheck::visit(const RepeatStatement* rs) {
+  if (!is_static(rs->get_cond())) {
+    return fail("Unable to compile a module with a repeat loop whose count isn't static");
+  }
+  ++loops_;
+  rs->get_stmt()->accept(this);
+  --loops_;
+}
+
+void De10Compiler::SynthCheck::visit(const WhileStatement* ws) {
+  (void) ws;
+  fail("Unable to compile a module with a while loop");
+}
+
+void De10Compiler::SynthCheck::visit(const DisplayStatement* ds) {
+  if (loops_ > 0) {
+    fail("Unable to compile a module with a system task inside of a loop");
+  }
+  Visitor::visit(ds);
+}
+
+void De10Compiler::SynthCheck::visit(const FinishStatement* fs) {
+  if (loops_ > 0) {
+    fail("Unable to compile a module with a system task inside of a loop");
+  }
+  Visitor::visit(fs);
+}
+
+void De10Compiler::SynthCheck::visit(const WriteStatement* ws) {
+  if (loops_ > 0) {
+    fail("Unable to compile a module with a system task inside of a loop");
+  }
+  Visitor::visit(ws);
+}
+
+void De10Compiler::SynthCheck::visit(const DelayControl* dc) {
+  (void) dc;
+  fail("Unable to compile a module with delay controls");
+}
+
 } // namespace cascade
@@ -36,12 +36,14 @@
 #include <stdint.h>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include "src/target/core_compiler.h"
 #include "src/target/core/de10/de10_gpio.h"
 #include "src/target/core/de10/de10_led.h"
 #include "src/target/core/de10/de10_logic.h"
 #include "src/target/core/de10/de10_pad.h"
 #include "src/target/core/de10/program_boxer.h"
+#include "src/verilog/ast/visitors/visitor.h"
 
 namespace cascade {
 
@@ -57,6 +59,33 @@ class De10Compiler : public CoreCompiler {
 
     void abort() override;
 
+    // Helper Class: Checks whether a module can be synthesized by quartus.
+    // Delay controls would be silently dropped. Loops are unrolled during
+    // synthesis, so their bounds have to be static, and their bodies can't
+    // contain nonblocking assigns or system tasks, which ModuleBoxer lowers
+    // to state that's shared by every iteration.
+    class SynthCheck : public Visitor {
+      public:
+        ~SynthCheck() override = default;
+        bool check(const ModuleDeclaration* md);
+        const std::string& what() const;
+      private:
+        std::string what_;
+        std::vector<const Identifier*> vars_;
+        size_t loops_;
+        void fail(const std::string& what);
+        bool is_static(const Expression* e);
+        void visit(const BlockingAssign* ba) override;
+        void visit(const NonblockingAssign* na) override;
+        void visit(const ForStatement* fs) override;
+        void visit(const RepeatStatement* rs) override;
+        void visit(const WhileStatement* ws) override;
+        void visit(const DisplayStatement* ds) override;
+        void visit(const FinishStatement* fs) override;
+        void visit(const WriteStatement* ws) override;
+        void visit(const DelayControl* dc) override;
+    };
+
   private:
     // Memory Mapped State:
     int fd_;
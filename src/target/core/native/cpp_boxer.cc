@@ -0,0 +1,1246 @@
+// Copyright 2017-2018 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "src/target/core/native/cpp_boxer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <sstream>
+#include "src/target/core/native/native_program.h"
+#include "src/verilog/analyze/constant.h"
+#include "src/verilog/analyze/evaluate.h"
+#include "src/verilog/analyze/read_set.h"
+#include "src/verilog/analyze/resolve.h"
+#include "src/verilog/print/text/text_printer.h"
+
+using namespace std;
+
+namespace cascade {
+
+CppBoxer::CppBoxer() : Visitor() {
+  ok_ = true;
+  os_ = nullptr;
+  next_tmp_ = 0;
+}
+
+CppBoxer& CppBoxer::set_read(const Identifier* id, VId vid) {
+  reads_.push_back(make_pair(id, vid));
+  return *this;
+}
+
+CppBoxer& CppBoxer::set_write(const Identifier* id, VId vid) {
+  writes_.push_back(make_pair(id, vid));
+  return *this;
+}
+
+CppBoxer& CppBoxer::set_state(const Identifier* id, VId vid) {
+  state_.push_back(make_pair(id, vid));
+  return *this;
+}
+
+string CppBoxer::box(const ModuleDeclaration* md) {
+  // Collect variables first, so that everything else can refer to them
+  for (auto mi : *md->get_items()) {
+    if (auto pd = dynamic_cast<const PortDeclaration*>(mi)) {
+      declare(pd->get_decl()->get_id());
+    } else if (auto d = dynamic_cast<const Declaration*>(mi)) {
+      declare(d->get_id());
+    }
+  }
+
+  // Collect continuous assigns and processes. Each process is run by one or
+  // more triggers, which are registered with variables in the same order
+  // that Monitor registers events in SwLogic.
+  vector<const VariableAssign*> cas;
+  for (auto mi : *md->get_items()) {
+    if (dynamic_cast<const PortDeclaration*>(mi) || dynamic_cast<const Declaration*>(mi)) {
+      continue;
+    } else if (auto ca = dynamic_cast<const ContinuousAssign*>(mi)) {
+      ok_ = ok_ && ca->get_ctrl()->null();
+      cas.push_back(ca->get_assign());
+    } else if (auto ac = dynamic_cast<const AlwaysConstruct*>(mi)) {
+      const auto tcs = dynamic_cast<const TimingControlStatement*>(ac->get_stmt());
+      const auto ec = (tcs == nullptr) ? nullptr : dynamic_cast<const EventControl*>(tcs->get_ctrl());
+      if (ec == nullptr) {
+        ok_ = false;
+        continue;
+      }
+      const auto p = procs_.size();
+      procs_.push_back(tcs->get_stmt());
+      if (ec->get_events()->empty()) {
+        triggers_.push_back({nullptr, Event::EDGE, p});
+        for (auto i : ReadSet(tcs->get_stmt())) {
+          sensitize(triggers_.size()-1, i);
+        }
+        continue;
+      }
+      for (auto e : *ec->get_events()) {
+        const auto id = dynamic_cast<const Identifier*>(e->get_expr());
+        const auto v = (id == nullptr) ? nullptr : lookup(id);
+        if ((v == nullptr) || (v->arity != 1)) {
+          ok_ = false;
+          continue;
+        }
+        triggers_.push_back({v->id, e->get_type(), p});
+        sensitize(triggers_.size()-1, id);
+      }
+    } else if (auto ic = dynamic_cast<const InitialConstruct*>(mi)) {
+      const auto ign = ic->get_attrs()->get<String>("__ignore");
+      if ((ign != nullptr) && ign->eq("true")) {
+        continue;
+      }
+      initials_.push_back(triggers_.size());
+      triggers_.push_back({nullptr, Event::EDGE, procs_.size()});
+      procs_.push_back(ic->get_stmt());
+    } else {
+      ok_ = false;
+    }
+  }
+  levelize(cas);
+  if (!ok_) {
+    return "";
+  }
+
+  // Processes are generated first, since this is where we discover the
+  // non-blocking update sites and constants which the rest of the program
+  // refers to.
+  stringstream ps;
+  indstream pos(ps);
+  os_ = &pos;
+  emit_scheduler(pos);
+  emit_notify(pos);
+  emit_processes(pos);
+
+  stringstream ss;
+  indstream os(ss);
+  os_ = &os;
+
+  os << "#include <sstream>" << endl;
+  os << "#include <vector>" << endl;
+  os << "#include \"src/target/core/native/native_program.h\"" << endl;
+  os << endl;
+  os << "namespace cascade {" << endl;
+  os << endl;
+  os << "namespace {" << endl;
+  os << endl;
+  os << "class Program : public NativeProgram {" << endl;
+  os.tab();
+  os << "public:" << endl;
+  os.tab();
+  emit_constructor(os);
+  emit_state_interface(os);
+  emit_core_interface(os);
+  os.untab();
+  os << "private:" << endl;
+  os.tab();
+  os << ps.str();
+  emit_variables(os);
+  os.untab();
+  os.untab();
+  os << "};" << endl;
+  os << endl;
+  os << "} // namespace" << endl;
+  os << endl;
+  os << "} // namespace cascade" << endl;
+  os << endl;
+  os << "extern \"C\" cascade::NativeProgram* " << NativeProgram::factory() << "(cascade::Interface* interface) {" << endl;
+  os << "  return new cascade::Program(interface);" << endl;
+  os << "}" << endl;
+
+  os_ = nullptr;
+  return ok_ ? ss.str() : "";
+}
+
+void CppBoxer::declare(const Identifier* id) {
+  Var v;
+  v.id = id;
+  v.width = Evaluate().get_width(id);
+  v.sign = Evaluate().get_signed(id);
+  v.arity = Evaluate().get_array_value(id).size();
+
+  index_[id] = vars_.size();
+  vars_.push_back(v);
+}
+
+void CppBoxer::levelize(const vector<const VariableAssign*>& cas) {
+  // This is the same ordering as SwLogic::levelize(). Each assign comes after
+  // the assigns which drive its inputs, and anything that's part of a
+  // combinational loop is placed after everything else.
+  vector<vector<size_t>> reads(cas.size());
+  unordered_map<size_t, vector<size_t>> writers;
+  for (size_t i = 0, ie = cas.size(); i < ie; ++i) {
+    const auto v = lookup(cas[i]->get_lhs());
+    if (v == nullptr) {
+      ok_ = false;
+      return;
+    }
+    writers[v-vars_.data()].push_back(i);
+    for (auto r : ReadSet(cas[i]->get_rhs())) {
+      const auto rv = lookup(r);
+      if (rv == nullptr) {
+        ok_ = false;
+        return;
+      }
+      reads[i].push_back(rv-vars_.data());
+    }
+  }
+
+  vector<vector<size_t>> succs(cas.size());
+  vector<size_t> preds(cas.size(), 0);
+  for (size_t i = 0, ie = cas.size(); i < ie; ++i) {
+    for (auto r : reads[i]) {
+      const auto itr = writers.find(r);
+      if (itr == writers.end()) {
+        continue;
+      }
+      for (auto j : itr->second) {
+        succs[j].push_back(i);
+        ++preds[i];
+      }
+    }
+  }
+  vector<size_t> level(cas.size(), 0);
+  vector<size_t> work;
+  for (size_t i = 0, ie = cas.size(); i < ie; ++i) {
+    if (preds[i] == 0) {
+      work.push_back(i);
+    }
+  }
+  size_t max_level = 0;
+  while (!work.empty()) {
+    const auto i = work.back();
+    work.pop_back();
+    max_level = max(max_level, level[i]);
+    for (auto j : succs[i]) {
+      level[j] = max(level[j], level[i]+1);
+      if (--preds[j] == 0) {
+        work.push_back(j);
+      }
+    }
+  }
+  for (size_t i = 0, ie = cas.size(); i < ie; ++i) {
+    if (preds[i] != 0) {
+      level[i] = max_level+1;
+    }
+  }
+
+  vector<size_t> order(cas.size());
+  for (size_t i = 0, ie = cas.size(); i < ie; ++i) {
+    order[i] = i;
+  }
+  stable_sort(order.begin(), order.end(), [&level](size_t a, size_t b) {
+    return level[a] < level[b];
+  });
+  for (size_t i = 0, ie = order.size(); i < ie; ++i) {
+    assigns_.push_back(cas[order[i]]);
+    for (auto r : reads[order[i]]) {
+      auto& fo = vars_[r].fanout;
+      if (fo.empty() || (fo.back() != i)) {
+        fo.push_back(i);
+      }
+    }
+  }
+}
+
+void CppBoxer::sensitize(size_t t, const Identifier* id) {
+  auto v = const_cast<Var*>(lookup(id));
+  if (v == nullptr) {
+    ok_ = false;
+    return;
+  }
+  if (v->triggers.empty() || (v->triggers.back() != t)) {
+    v->triggers.push_back(t);
+  }
+}
+
+const CppBoxer::Var* CppBoxer::lookup(const Identifier* id) {
+  const auto r = Resolve().get_resolution(id);
+  const auto itr = index_.find(r);
+  return (itr == index_.end()) ? nullptr : &vars_[itr->second];
+}
+
+void CppBoxer::emit_variables(indstream& os) {
+  os << "// Variables:" << endl;
+  for (size_t i = 0, ie = vars_.size(); i < ie; ++i) {
+    const auto& v = vars_[i];
+    os << type(v.width, v.sign) << " " << var(i) << "[" << v.arity << "]; // " << v.id->get_ids()->back()->get_readable_sid() << endl;
+  }
+  os << endl;
+
+  os << "// Non-Blocking Updates:" << endl;
+  os << "std::vector<size_t> updates_;" << endl;
+  for (size_t i = 0, ie = updates_.size(); i < ie; ++i) {
+    const auto rhs = updates_[i]->get_assign()->get_rhs();
+    os << "std::vector<Update<" << Evaluate().get_width(rhs) << ", " << (Evaluate().get_signed(rhs) ? "true" : "false") << ">> u" << i << "_;" << endl;
+    os << "size_t c" << i << "_ = 0;" << endl;
+  }
+  os << endl;
+
+  os << "// Constants:" << endl;
+  for (const auto& c : consts_) {
+    os << c.second << endl;
+  }
+}
+
+void CppBoxer::emit_constructor(indstream& os) {
+  os << "explicit Program(Interface* interface) : NativeProgram(interface) {" << endl;
+  os.tab();
+  os << "provision(" << assigns_.size() << ", " << triggers_.size() << ");" << endl;
+  // Variables start out with whatever values they have now. Most of these
+  // will be zero, which is how FixedBits is initialized by default.
+  for (size_t i = 0, ie = vars_.size(); i < ie; ++i) {
+    const auto& v = vars_[i];
+    const auto& vals = Evaluate().get_array_value(v.id);
+    for (size_t j = 0, je = vals.size(); j < je; ++j) {
+      stringstream ws;
+      auto zero = true;
+      for (size_t k = (v.width+63)/64; k-- > 0; ) {
+        const auto w = vals[j].read_word<uint64_t>(k);
+        zero = zero && (w == 0);
+        ws << "0x" << hex << w << "ull" << (k == 0 ? "" : ", ");
+      }
+      if (!zero) {
+        os << var(i) << "[" << j << "] = lit<" << v.width << ", " << (v.sign ? "true" : "false") << ">({" << ws.str() << "});" << endl;
+      }
+    }
+  }
+  os.untab();
+  os << "}" << endl;
+  os << "~Program() override = default;" << endl;
+  os << endl;
+}
+
+void CppBoxer::emit_state_interface(indstream& os) {
+  // Inputs and stateful variables are both transferred through this interface
+  map<VId, size_t> vids;
+  for (const auto& r : reads_) {
+    vids[r.second] = lookup(r.first)-vars_.data();
+  }
+  for (const auto& s : state_) {
+    vids[s.second] = lookup(s.first)-vars_.data();
+  }
+
+  os << "void get(VId id, std::vector<Bits>* bs) override {" << endl;
+  os.tab();
+  os << "bs->clear();" << endl;
+  os << "switch (id) {" << endl;
+  os.tab();
+  for (const auto& v : vids) {
+    os << "case " << v.first << ":" << endl;
+    os << "  for (size_t i = 0; i < " << vars_[v.second].arity << "; ++i) {" << endl;
+    os << "    bs->push_back(" << var(v.second) << "[i].to_bits());" << endl;
+    os << "  }" << endl;
+    os << "  break;" << endl;
+  }
+  os << "default:" << endl;
+  os << "  break;" << endl;
+  os.untab();
+  os << "}" << endl;
+  os.untab();
+  os << "}" << endl;
+
+  os << "void set(VId id, const std::vector<Bits>& bs) override {" << endl;
+  os.tab();
+  os << "switch (id) {" << endl;
+  os.tab();
+  for (const auto& v : vids) {
+    os << "case " << v.first << ":" << endl;
+    os << "  for (size_t i = 0, ie = std::min<size_t>(" << vars_[v.second].arity << ", bs.size()); i < ie; ++i) {" << endl;
+    os << "    " << var(v.second) << "[i].read(bs[i]);" << endl;
+    os << "  }" << endl;
+    os << "  break;" << endl;
+  }
+  os << "default:" << endl;
+  os << "  break;" << endl;
+  os.untab();
+  os << "}" << endl;
+  os.untab();
+  os << "}" << endl;
+  os << endl;
+}
+
+void CppBoxer::emit_core_interface(indstream& os) {
+  os << "void read(VId id, const Bits* b) override {" << endl;
+  os.tab();
+  os << "switch (id) {" << endl;
+  os.tab();
+  for (const auto& r : reads_) {
+    const auto k = lookup(r.first)-vars_.data();
+    os << "case " << r.second << ":" << endl;
+    os << "  " << var(k) << "[0].read(*b);" << endl;
+    os << "  notify_" << k << "();" << endl;
+    os << "  break;" << endl;
+  }
+  os << "default:" << endl;
+  os << "  break;" << endl;
+  os.untab();
+  os << "}" << endl;
+  os.untab();
+  os << "}" << endl;
+
+  os << "void resync() override {" << endl;
+  os.tab();
+  os << "for (size_t i = 0; i < " << assigns_.size() << "; ++i) {" << endl;
+  os << "  mark(i);" << endl;
+  os << "}" << endl;
+  for (const auto& r : reads_) {
+    os << "notify_" << (lookup(r.first)-vars_.data()) << "();" << endl;
+  }
+  os << "silent_ = true;" << endl;
+  os << "drain();" << endl;
+  os << "silent_ = false;" << endl;
+  for (auto t : initials_) {
+    os << "schedule(" << t << ");" << endl;
+  }
+  os.untab();
+  os << "}" << endl;
+
+  os << "void evaluate() override {" << endl;
+  os << "  there_were_tasks_ = false;" << endl;
+  os << "  drain();" << endl;
+  os << "  write_outputs();" << endl;
+  os << "}" << endl;
+
+  os << "bool there_are_updates() const override {" << endl;
+  os << "  return !updates_.empty();" << endl;
+  os << "}" << endl;
+
+  // Updates are applied in the order they were scheduled
+  os << "void update() override {" << endl;
+  os.tab();
+  os << "for (auto u : updates_) {" << endl;
+  os.tab();
+  os << "switch (u) {" << endl;
+  os.tab();
+  for (size_t i = 0, ie = updates_.size(); i < ie; ++i) {
+    const auto lhs = updates_[i]->get_assign()->get_lhs();
+    const auto k = lookup(lhs)-vars_.data();
+    const Expression* re = nullptr;
+    deref(lhs, vars_[k], &re);
+    os << "case " << i << ": {" << endl;
+    os.tab();
+    os << "const auto& x = u" << i << "_[c" << i << "_++];" << endl;
+    if (re == nullptr) {
+      os << var(k) << "[x.idx].assign(x.val);" << endl;
+    } else {
+      os << "put(" << var(k) << "[x.idx], x.msb, x.lsb, x.val);" << endl;
+    }
+    os << "if (c" << i << "_ == u" << i << "_.size()) {" << endl;
+    os << "  u" << i << "_.clear();" << endl;
+    os << "  c" << i << "_ = 0;" << endl;
+    os << "}" << endl;
+    os << "notify_" << k << "();" << endl;
+    os << "break;" << endl;
+    os.untab();
+    os << "}" << endl;
+  }
+  os << "default:" << endl;
+  os << "  break;" << endl;
+  os.untab();
+  os << "}" << endl;
+  os.untab();
+  os << "}" << endl;
+  os << "updates_.clear();" << endl;
+  os << "there_were_tasks_ = false;" << endl;
+  os << "drain();" << endl;
+  os << "write_outputs();" << endl;
+  os.untab();
+  os << "}" << endl;
+
+  os << "bool there_were_tasks() const override {" << endl;
+  os << "  return there_were_tasks_;" << endl;
+  os << "}" << endl;
+
+  // This is the same loop as Core::open_loop(), but without virtual calls
+  os << "size_t open_loop(VId clk, bool val, size_t itr) override {" << endl;
+  os.tab();
+  os << "size_t res = 0;" << endl;
+  os << "for (auto tasks = false; (res < itr) && !tasks; ++res) {" << endl;
+  os.tab();
+  os << "val = !val;" << endl;
+  os << "tick(clk, val);" << endl;
+  os << "for (auto done = false; !done; ) {" << endl;
+  os.tab();
+  os << "evaluate();" << endl;
+  os << "tasks |= there_were_tasks_;" << endl;
+  os << "done = updates_.empty();" << endl;
+  os << "if (!done) {" << endl;
+  os << "  update();" << endl;
+  os << "  tasks |= there_were_tasks_;" << endl;
+  os << "}" << endl;
+  os.untab();
+  os << "}" << endl;
+  os.untab();
+  os << "}" << endl;
+  os << "return res;" << endl;
+  os.untab();
+  os << "}" << endl;
+  os << endl;
+}
+
+void CppBoxer::emit_scheduler(indstream& os) {
+  os << "void tick(VId id, bool b) {" << endl;
+  os.tab();
+  os << "switch (id) {" << endl;
+  os.tab();
+  for (const auto& r : reads_) {
+    const auto k = lookup(r.first)-vars_.data();
+    const auto& v = vars_[k];
+    os << "case " << r.second << ":" << endl;
+    os << "  " << var(k) << "[0] = " << type(v.width, v.sign) << "(b ? 1 : 0);" << endl;
+    os << "  notify_" << k << "();" << endl;
+    os << "  break;" << endl;
+  }
+  os << "default:" << endl;
+  os << "  break;" << endl;
+  os.untab();
+  os << "}" << endl;
+  os.untab();
+  os << "}" << endl;
+
+  os << "void write_outputs() {" << endl;
+  os.tab();
+  for (const auto& w : writes_) {
+    os << "write(" << w.second << ", " << var(lookup(w.first)-vars_.data()) << "[0]);" << endl;
+  }
+  os.untab();
+  os << "}" << endl;
+
+  // Continuous assigns are evaluated in level order, each at most once per
+  // pass unless it's part of a combinational loop. Each assign is placed in a
+  // function of its own and dispatched through a table. Large designs have
+  // thousands of these, and host compilers handle many small functions much
+  // better than a single function with a case for each one.
+  for (size_t i = 0, ie = assigns_.size(); i < ie; ++i) {
+    os << "void assign_" << i << "() {" << endl;
+    os.tab();
+    emit_assign(assigns_[i]);
+    os.untab();
+    os << "}" << endl;
+  }
+  os << "void settle() {" << endl;
+  os.tab();
+  if (!assigns_.empty()) {
+    os << "static void (Program::* const assigns[])() = {" << endl;
+    os.tab();
+    for (size_t i = 0, ie = assigns_.size(); i < ie; ++i) {
+      os << "&Program::assign_" << i << (i+1 == ie ? "" : ",") << endl;
+    }
+    os.untab();
+    os << "};" << endl;
+    os << "for (auto i = next_dirty(); i != size_t(-1); i = next_dirty()) {" << endl;
+    os << "  (this->*assigns[i])();" << endl;
+    os << "}" << endl;
+  }
+  os.untab();
+  os << "}" << endl;
+
+  os << "void drain() {" << endl;
+  os.tab();
+  os << "while (true) {" << endl;
+  os.tab();
+  os << "settle();" << endl;
+  os << "const auto t = next_active();" << endl;
+  os << "if (t == size_t(-1)) {" << endl;
+  os << "  break;" << endl;
+  os << "}" << endl;
+  os << "fire(t);" << endl;
+  os.untab();
+  os << "}" << endl;
+  os.untab();
+  os << "}" << endl;
+
+  // Edges are checked when a trigger is run rather than when it's scheduled,
+  // which is also how SwLogic handles events.
+  os << "void fire(size_t t) {" << endl;
+  os.tab();
+  os << "switch (t) {" << endl;
+  os.tab();
+  for (size_t i = 0, ie = triggers_.size(); i < ie; ++i) {
+    const auto& t = triggers_[i];
+    os << "case " << i << ":" << endl;
+    if ((t.id == nullptr) || (t.type == Event::EDGE)) {
+      os << "  proc_" << t.proc << "();" << endl;
+    } else {
+      const auto k = lookup(t.id)-vars_.data();
+      os << "  if (" << (t.type == Event::NEGEDGE ? "!" : "") << var(k) << "[0].to_bool()) {" << endl;
+      os << "    proc_" << t.proc << "();" << endl;
+      os << "  }" << endl;
+    }
+    os << "  break;" << endl;
+  }
+  os << "default:" << endl;
+  os << "  break;" << endl;
+  os.untab();
+  os << "}" << endl;
+  os.untab();
+  os << "}" << endl;
+  os << endl;
+}
+
+void CppBoxer::emit_notify(indstream& os) {
+  for (size_t i = 0, ie = vars_.size(); i < ie; ++i) {
+    os << "void notify_" << i << "() {" << endl;
+    os.tab();
+    for (auto a : vars_[i].fanout) {
+      os << "mark(" << a << ");" << endl;
+    }
+    for (auto t : vars_[i].triggers) {
+      os << "schedule(" << t << ");" << endl;
+    }
+    os.untab();
+    os << "}" << endl;
+  }
+  os << endl;
+}
+
+void CppBoxer::emit_processes(indstream& os) {
+  for (size_t i = 0, ie = procs_.size(); i < ie; ++i) {
+    os << "void proc_" << i << "() {" << endl;
+    os.tab();
+    procs_[i]->accept(this);
+    os.untab();
+    os << "}" << endl;
+  }
+  os << endl;
+}
+
+void CppBoxer::emit_assign(const VariableAssign* va) {
+  const auto lhs = va->get_lhs();
+  const auto v = lookup(lhs);
+  if (v == nullptr) {
+    ok_ = false;
+    return;
+  }
+  const auto k = v-vars_.data();
+
+  const Expression* re = nullptr;
+  const auto idx = deref(lhs, *v, &re);
+  const auto rhs = expr(va->get_rhs());
+  if (re == nullptr) {
+    *os_ << var(k) << "[" << idx << "].assign(" << rhs << ");" << endl;
+  } else {
+    string msb;
+    string lsb;
+    range(re, *v, &msb, &lsb);
+    *os_ << "put(" << var(k) << "[" << idx << "], " << msb << ", " << lsb << ", " << rhs << ");" << endl;
+  }
+  *os_ << "notify_" << k << "();" << endl;
+}
+
+void CppBoxer::emit_printf(const Many<Expression>* args) {
+  // This mirrors Printf::format(), with the literal text computed ahead of
+  // time.
+  *os_ << "std::stringstream ss;" << endl;
+  if (args->empty()) {
+    return;
+  }
+  auto a = args->begin();
+  const auto s = dynamic_cast<const String*>(*a);
+  if (s == nullptr) {
+    *os_ << "print(ss, " << expr(*a) << ", 10);" << endl;
+    return;
+  }
+
+  const auto& fmt = s->get_readable_val();
+  for (size_t i = 0, j = 0; ; i = j+2) {
+    j = fmt.find_first_of('%', i);
+    stringstream text;
+    TextPrinter(text) << fmt.substr(i, j-i);
+    if (!text.str().empty()) {
+      *os_ << "ss << " << literal(text.str()) << ";" << endl;
+    }
+    if (j == string::npos) {
+      break;
+    }
+    if (++a == args->end()) {
+      continue;
+    }
+    switch ((j+1 < fmt.length()) ? fmt[j+1] : '\0') {
+      case 'b':
+      case 'B':
+        *os_ << "print(ss, " << expr(*a) << ", 2);" << endl;
+        break;
+      case 'd':
+      case 'D':
+        *os_ << "print(ss, " << expr(*a) << ", 10);" << endl;
+        break;
+      case 'h':
+      case 'H':
+        *os_ << "print(ss, " << expr(*a) << ", 16);" << endl;
+        break;
+      case 'o':
+      case 'O':
+        *os_ << "print(ss, " << expr(*a) << ", 8);" << endl;
+        break;
+      default:
+        ok_ = false;
+        break;
+    }
+  }
+}
+
+string CppBoxer::expr(const Expression* e) {
+  e->accept(this);
+  return res_;
+}
+
+string CppBoxer::expr(const Expression* e, size_t w, bool s) {
+  const auto code = expr(e);
+  return cast(code, Evaluate().get_width(e), Evaluate().get_signed(e), w, s);
+}
+
+string CppBoxer::deref(const Identifier* id, const Var& v, const Expression** range) {
+  // This mirrors the arithmetic in Bytecode::lower(). Constant subscripts are
+  // folded into the base index, everything else is computed at runtime.
+  size_t base = 0;
+  stringstream dyn;
+  auto iitr = id->get_dim()->begin();
+  const auto iend = id->get_dim()->end();
+  size_t mul = v.arity;
+  for (auto rd : *v.id->get_dim()) {
+    if (iitr == iend) {
+      ok_ = false;
+      break;
+    }
+    const auto rng = Evaluate().get_range(rd);
+    mul /= (rng.first-rng.second+1);
+    if (Constant().is_constant(*iitr)) {
+      base += mul * Evaluate().get_value(*iitr).to_int();
+    } else {
+      dyn << " + " << mul << "*(" << expr(*iitr) << ").to_int()";
+    }
+    ++iitr;
+  }
+  *range = (iitr == iend) ? nullptr : *iitr;
+
+  if (dyn.str().empty()) {
+    return to_string((base < v.arity) ? base : 0);
+  }
+  return "ix(" + to_string(base) + dyn.str() + ", " + to_string(v.arity) + ")";
+}
+
+void CppBoxer::range(const Expression* re, const Var& v, string* msb, string* lsb) {
+  // Constant ranges are clamped now, everything else is clamped by the
+  // helpers in NativeProgram.
+  if (Constant().is_constant(re)) {
+    const auto rng = Evaluate().get_range(re);
+    *msb = to_string(min(rng.first, v.width-1));
+    *lsb = to_string(min(rng.second, v.width-1));
+    return;
+  }
+  const auto r = dynamic_cast<const RangeExpression*>(re);
+  if (r == nullptr) {
+    *msb = *lsb = "(" + expr(re) + ").to_int()";
+    return;
+  }
+  const auto upper = "(" + expr(r->get_upper()) + ").to_int()";
+  const auto lower = "(" + expr(r->get_lower()) + ").to_int()";
+  switch (r->get_type()) {
+    case RangeExpression::CONSTANT:
+      *msb = upper;
+      *lsb = lower;
+      break;
+    case RangeExpression::PLUS:
+      *msb = "(" + upper + " + " + lower + " - 1)";
+      *lsb = upper;
+      break;
+    case RangeExpression::MINUS:
+      *msb = upper;
+      *lsb = "(" + upper + " - " + lower + " + 1)";
+      break;
+    default:
+      assert(false);
+      break;
+  }
+}
+
+string CppBoxer::type(size_t w, bool s) {
+  return "B<" + to_string(w) + ", " + (s ? "true" : "false") + ">";
+}
+
+string CppBoxer::cast(const string& code, size_t w1, bool s1, size_t w2, bool s2) {
+  if ((w1 == w2) && (s1 == s2)) {
+    return code;
+  }
+  return "cast<" + to_string(w2) + ", " + (s2 ? "true" : "false") + ">(" + code + ")";
+}
+
+string CppBoxer::var(size_t idx) {
+  return "v" + to_string(idx) + "_";
+}
+
+string CppBoxer::literal(const string& s) {
+  stringstream ss;
+  ss << "\"";
+  for (auto c : s) {
+    if (isprint(c) && (c != '"') && (c != '\\') && (c != '?')) {
+      ss << c;
+    } else {
+      ss << "\\" << oct << ((c >> 6) & 3) << ((c >> 3) & 7) << (c & 7) << dec;
+    }
+  }
+  ss << "\"";
+  return ss.str();
+}
+
+void CppBoxer::visit(const BinaryExpression* be) {
+  const auto w = Evaluate().get_width(be);
+  const auto s = Evaluate().get_signed(be);
+  const auto lw = Evaluate().get_width(be->get_lhs());
+  const auto ls = Evaluate().get_signed(be->get_lhs());
+
+  string fn = "";
+  string op = "";
+  switch (be->get_op()) {
+    case BinaryExpression::PLUS:
+      fn = "add";
+      break;
+    case BinaryExpression::MINUS:
+      fn = "sub";
+      break;
+    case BinaryExpression::TIMES:
+      fn = "mul";
+      break;
+    case BinaryExpression::DIV:
+      fn = "div";
+      break;
+    case BinaryExpression::MOD:
+      fn = "mod";
+      break;
+    case BinaryExpression::TTIMES:
+      fn = "pow";
+      break;
+    case BinaryExpression::AMP:
+      fn = "band";
+      break;
+    case BinaryExpression::PIPE:
+      fn = "bor";
+      break;
+    case BinaryExpression::CARAT:
+      fn = "bxor";
+      break;
+    case BinaryExpression::TCARAT:
+      fn = "bxnor";
+      break;
+
+    // NOTE: These are equivalent because we don't support x and z
+    case BinaryExpression::EEEQ:
+    case BinaryExpression::EEQ:
+      op = "==";
+      break;
+    case BinaryExpression::BEEQ:
+    case BinaryExpression::BEQ:
+      op = "!=";
+      break;
+    case BinaryExpression::LT:
+      op = "<";
+      break;
+    case BinaryExpression::LEQ:
+      op = "<=";
+      break;
+    case BinaryExpression::GT:
+      op = ">";
+      break;
+    case BinaryExpression::GEQ:
+      op = ">=";
+      break;
+
+    case BinaryExpression::AAMP:
+    case BinaryExpression::PPIPE: {
+      const auto l = expr(be->get_lhs());
+      const auto r = expr(be->get_rhs());
+      const auto o = (be->get_op() == BinaryExpression::AAMP) ? " && " : " || ";
+      res_ = cast("bit((" + l + ").to_bool()" + o + "(" + r + ").to_bool())", 1, false, w, s);
+      return;
+    }
+
+    case BinaryExpression::LLT:
+    case BinaryExpression::LLLT:
+    case BinaryExpression::GGT:
+    case BinaryExpression::GGGT: {
+      const auto l = expr(be->get_lhs(), w, s);
+      const auto r = expr(be->get_rhs());
+      const auto f = (be->get_op() == BinaryExpression::GGT) ? "slr" : (be->get_op() == BinaryExpression::GGGT) ? "sar" : "sll";
+      res_ = string(f) + "(" + l + ", (" + r + ").to_int())";
+      return;
+    }
+
+    default:
+      assert(false);
+      break;
+  }
+
+  // Arithmetic and bitwise operators: operands have the type of this expression
+  if (fn != "") {
+    const auto l = expr(be->get_lhs(), w, s);
+    const auto r = expr(be->get_rhs(), w, s);
+    res_ = fn + "(" + l + ", " + r + ")";
+    return;
+  }
+  // Comparison operators: operands have been extended to a common type
+  const auto l = expr(be->get_lhs());
+  const auto r = expr(be->get_rhs(), lw, ls);
+  res_ = cast("bit(" + l + " " + op + " " + r + ")", 1, false, w, s);
+}
+
+void CppBoxer::visit(const ConditionalExpression* ce) {
+  const auto w = Evaluate().get_width(ce);
+  const auto s = Evaluate().get_signed(ce);
+  const auto c = expr(ce->get_cond());
+  const auto l = expr(ce->get_lhs(), w, s);
+  const auto r = expr(ce->get_rhs(), w, s);
+  res_ = "((" + c + ").to_bool() ? " + l + " : " + r + ")";
+}
+
+void CppBoxer::visit(const NestedExpression* ne) {
+  res_ = expr(ne->get_expr(), Evaluate().get_width(ne), Evaluate().get_signed(ne));
+}
+
+void CppBoxer::visit(const Concatenation* c) {
+  string code = "";
+  size_t cw = 0;
+  for (auto e : *c->get_exprs()) {
+    const auto x = expr(e);
+    code = (cw == 0) ? ("cat(" + x + ")") : (code + ".concat(" + x + ")");
+    cw += Evaluate().get_width(e);
+  }
+  res_ = cast(code, cw, false, Evaluate().get_width(c), Evaluate().get_signed(c));
+}
+
+void CppBoxer::visit(const Identifier* id) {
+  const auto v = lookup(id);
+  if (v == nullptr) {
+    ok_ = false;
+    res_ = "";
+    return;
+  }
+  const auto w = Evaluate().get_width(id);
+  const auto s = Evaluate().get_signed(id);
+
+  const Expression* re = nullptr;
+  const auto idx = deref(id, *v, &re);
+  const auto src = var(v-vars_.data()) + "[" + idx + "]";
+  if (re == nullptr) {
+    res_ = cast(src, v->width, v->sign, w, s);
+    return;
+  }
+  string msb;
+  string lsb;
+  range(re, *v, &msb, &lsb);
+  res_ = "slice<" + to_string(w) + ", " + (s ? "true" : "false") + ">(" + src + ", " + msb + ", " + lsb + ")";
+}
+
+void CppBoxer::visit(const MultipleConcatenation* mc) {
+  const auto n = Evaluate().get_value(mc->get_expr()).to_int();
+  if (n == 0) {
+    ok_ = false;
+    res_ = "";
+    return;
+  }
+  const auto cw = Evaluate().get_width(mc->get_concat());
+  const auto code = "rep<" + to_string(n) + ">(" + expr(mc->get_concat()) + ")";
+  res_ = cast(code, n*cw, false, Evaluate().get_width(mc), Evaluate().get_signed(mc));
+}
+
+void CppBoxer::visit(const Number* n) {
+  const auto w = Evaluate().get_width(n);
+  const auto s = Evaluate().get_signed(n);
+  const auto& val = Evaluate().get_value(n);
+
+  // Narrow constants are built in place, so that the c++ compiler can fold
+  // them. Everything else is hoisted into a member.
+  if (w <= 32) {
+    stringstream ss;
+    ss << type(w, s) << "(0x" << hex << val.read_word<uint32_t>(0) << "u)";
+    res_ = ss.str();
+    return;
+  }
+  stringstream ss;
+  for (size_t k = (w+63)/64; k-- > 0; ) {
+    ss << "0x" << hex << val.read_word<uint64_t>(k) << "ull" << (k == 0 ? "" : ", ");
+  }
+  const auto init = "lit<" + to_string(w) + ", " + (s ? "true" : "false") + ">({" + ss.str() + "})";
+  auto itr = consts_.find(init);
+  if (itr == consts_.end()) {
+    const auto name = "k" + to_string(consts_.size()) + "_";
+    itr = consts_.insert(make_pair(init, "const " + type(w, s) + " " + name + " = " + init + ";")).first;
+  }
+  const auto& decl = itr->second;
+  const auto b = decl.find(" k") + 1;
+  res_ = decl.substr(b, decl.find(' ', b) - b);
+}
+
+void CppBoxer::visit(const String* s) {
+  // Strings are only supported as the first argument to a system task
+  (void) s;
+  ok_ = false;
+  res_ = "";
+}
+
+void CppBoxer::visit(const RangeExpression* re) {
+  // Ranges are handled by their enclosing identifiers
+  (void) re;
+  ok_ = false;
+  res_ = "";
+}
+
+void CppBoxer::visit(const UnaryExpression* ue) {
+  const auto w = Evaluate().get_width(ue);
+  const auto s = Evaluate().get_signed(ue);
+
+  string fn = "";
+  switch (ue->get_op()) {
+    case UnaryExpression::PLUS:
+      res_ = expr(ue->get_lhs(), w, s);
+      return;
+    case UnaryExpression::MINUS:
+      res_ = "neg(" + expr(ue->get_lhs(), w, s) + ")";
+      return;
+    case UnaryExpression::TILDE:
+      res_ = "bnot(" + expr(ue->get_lhs(), w, s) + ")";
+      return;
+    case UnaryExpression::BANG:
+      fn = "logical_not";
+      break;
+    case UnaryExpression::AMP:
+      fn = "reduce_and";
+      break;
+    case UnaryExpression::TAMP:
+      fn = "reduce_nand";
+      break;
+    case UnaryExpression::PIPE:
+      fn = "reduce_or";
+      break;
+    case UnaryExpression::TPIPE:
+      fn = "reduce_nor";
+      break;
+    case UnaryExpression::CARAT:
+      fn = "reduce_xor";
+      break;
+    case UnaryExpression::TCARAT:
+      fn = "reduce_xnor";
+      break;
+    default:
+      assert(false);
+      break;
+  }
+  // Logical and reduction operators: operands are self-determined
+  res_ = cast("bit((" + expr(ue->get_lhs()) + ")." + fn + "())", 1, false, w, s);
+}
+
+void CppBoxer::visit(const BlockingAssign* ba) {
+  if (!ba->get_ctrl()->null()) {
+    ok_ = false;
+    return;
+  }
+  emit_assign(ba->get_assign());
+  // SwLogic settles continuous assigns between every step of a process, so
+  // statements which follow this one have to see their results.
+  const auto v = lookup(ba->get_assign()->get_lhs());
+  if ((v != nullptr) && !v->fanout.empty()) {
+    *os_ << "settle();" << endl;
+  }
+}
+
+void CppBoxer::visit(const NonblockingAssign* na) {
+  if (!na->get_ctrl()->null()) {
+    ok_ = false;
+    return;
+  }
+  const auto lhs = na->get_assign()->get_lhs();
+  const auto v = lookup(lhs);
+  if (v == nullptr) {
+    ok_ = false;
+    return;
+  }
+
+  const auto u = updates_.size();
+  updates_.push_back(na);
+
+  const Expression* re = nullptr;
+  const auto idx = deref(lhs, *v, &re);
+  string msb = "0";
+  string lsb = "0";
+  if (re != nullptr) {
+    range(re, *v, &msb, &lsb);
+  }
+  *os_ << "if (!silent_) {" << endl;
+  *os_ << "  u" << u << "_.push_back({" << idx << ", " << msb << ", " << lsb << ", " << expr(na->get_assign()->get_rhs()) << "});" << endl;
+  *os_ << "  updates_.push_back(" << u << ");" << endl;
+  *os_ << "}" << endl;
+}
+
+void CppBoxer::visit(const CaseStatement* cs) {
+  // This mirrors SwLogic: items are compared in order after extending them
+  // and the selector to a common width and sign, and the default item matches
+  // only if nothing else does. The host compiler is responsible for turning
+  // constant items into a jump table.
+  const auto ext = Evaluate().get_case_extension(cs);
+  const auto extend = [this, &ext](const Expression* e) {
+    const auto we = Evaluate().get_width(e);
+    return cast(expr(e, we, ext.second), we, ext.second, ext.first, ext.second);
+  };
+  const auto c = "c" + to_string(next_tmp_++);
+  *os_ << "{" << endl;
+  os_->tab();
+  *os_ << "const auto " << c << " = " << extend(cs->get_cond()) << ";" << endl;
+  auto first = true;
+  const CaseItem* def = nullptr;
+  for (auto ci : *cs->get_items()) {
+    if (ci->get_exprs()->empty()) {
+      def = (def == nullptr) ? ci : def;
+      continue;
+    }
+    *os_ << (first ? "if (" : "else if (");
+    for (auto i = ci->get_exprs()->begin(), ie = ci->get_exprs()->end(); i != ie; ++i) {
+      *os_ << ((i == ci->get_exprs()->begin()) ? "" : " || ") << "(" << c << " == " << extend(*i) << ")";
+    }
+    *os_ << ") {" << endl;
+    os_->tab();
+    ci->get_stmt()->accept(this);
+    os_->untab();
+    *os_ << "}" << endl;
+    first = false;
+  }
+  if (def != nullptr) {
+    *os_ << (first ? "{" : "else {") << endl;
+    os_->tab();
+    def->get_stmt()->accept(this);
+    os_->untab();
+    *os_ << "}" << endl;
+  }
+  os_->untab();
+  *os_ << "}" << endl;
+}
+
+void CppBoxer::visit(const ConditionalStatement* cs) {
+  *os_ << "if ((" << expr(cs->get_if()) << ").to_bool()) {" << endl;
+  os_->tab();
+  cs->get_then()->accept(this);
+  os_->untab();
+  *os_ << "} else {" << endl;
+  os_->tab();
+  cs->get_else()->accept(this);
+  os_->untab();
+  *os_ << "}" << endl;
+}
+
+void CppBoxer::visit(const ForStatement* fs) {
+  emit_assign(fs->get_init());
+  *os_ << "while ((" << expr(fs->get_cond()) << ").to_bool()) {" << endl;
+  os_->tab();
+  fs->get_stmt()->accept(this);
+  emit_assign(fs->get_update());
+  os_->untab();
+  *os_ << "}" << endl;
+}
+
+void CppBoxer::visit(const ForeverStatement* fs) {
+  // Processes have to run to completion
+  (void) fs;
+  ok_ = false;
+}
+
+void CppBoxer::visit(const RepeatStatement* rs) {
+  const auto n = "n" + to_string(next_tmp_++);
+  *os_ << "for (auto " << n << " = (" << expr(rs->get_cond()) << ").to_int(); " << n << " > 0; --" << n << ") {" << endl;
+  os_->tab();
+  rs->get_stmt()->accept(this);
+  os_->untab();
+  *os_ << "}" << endl;
+}
+
+void CppBoxer::visit(const ParBlock* pb) {
+  ok_ = ok_ && pb->get_decls()->empty();
+  *os_ << "{" << endl;
+  os_->tab();
+  pb->get_stmts()->accept(this);
+  os_->untab();
+  *os_ << "}" << endl;
+}
+
+void CppBoxer::visit(const SeqBlock* sb) {
+  ok_ = ok_ && sb->get_decls()->empty();
+  *os_ << "{" << endl;
+  os_->tab();
+  sb->get_stmts()->accept(this);
+  os_->untab();
+  *os_ << "}" << endl;
+}
+
+void CppBoxer::visit(const TimingControlStatement* tcs) {
+  // Processes have to run to completion
+  (void) tcs;
+  ok_ = false;
+}
+
+void CppBoxer::visit(const DisplayStatement* ds) {
+  *os_ << "if (!silent_) {" << endl;
+  os_->tab();
+  emit_printf(ds->get_args());
+  *os_ << "interface_->display(ss.str());" << endl;
+  *os_ << "there_were_tasks_ = true;" << endl;
+  os_->untab();
+  *os_ << "}" << endl;
+}
+
+void CppBoxer::visit(const FinishStatement* fs) {
+  *os_ << "if (!silent_) {" << endl;
+  *os_ << "  interface_->finish((" << expr(fs->get_arg()) << ").to_int());" << endl;
+  *os_ << "  there_were_tasks_ = true;" << endl;
+  *os_ << "}" << endl;
+}
+
+void CppBoxer::visit(const WriteStatement* ws) {
+  *os_ << "if (!silent_) {" << endl;
+  os_->tab();
+  emit_printf(ws->get_args());
+  *os_ << "interface_->write(ss.str());" << endl;
+  *os_ << "there_were_tasks_ = true;" << endl;
+  os_->untab();
+  *os_ << "}" << endl;
+}
+
+void CppBoxer::visit(const WaitStatement* ws) {
+  // Processes have to run to completion
+  (void) ws;
+  ok_ = false;
+}
+
+void CppBoxer::visit(const WhileStatement* ws) {
+  *os_ << "while ((" << expr(ws->get_cond()) << ").to_bool()) {" << endl;
+  os_->tab();
+  ws->get_stmt()->accept(this);
+  os_->untab();
+  *os_ << "}" << endl;
+}
+
+} // namespace cascade
@@ -0,0 +1,165 @@
+// Copyright 2017-2018 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CASCADE_SRC_TARGET_CORE_NATIVE_CPP_BOXER_H
+#define CASCADE_SRC_TARGET_CORE_NATIVE_CPP_BOXER_H
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "src/base/stream/indstream.h"
+#include "src/runtime/ids.h"
+#include "src/verilog/ast/ast.h"
+#include "src/verilog/ast/visitors/visitor.h"
+
+namespace cascade {
+
+// This class lowers a module declaration to a c++ translation unit which
+// implements the module as a NativeProgram (see native_program.h). The
+// generated code follows the same scheduling semantics as SwLogic, but with
+// every variable stored in a FixedBits of its declared width, every
+// expression compiled to straight-line code, and every process run to
+// completion. Modules which use a language feature that can't be scheduled
+// this way, such as timing control inside of a process, are rejected.
+
+class CppBoxer : public Visitor {
+  public:
+    CppBoxer();
+    ~CppBoxer() override = default;
+
+    // Configuration Interface:
+    CppBoxer& set_read(const Identifier* id, VId vid);
+    CppBoxer& set_write(const Identifier* id, VId vid);
+    CppBoxer& set_state(const Identifier* id, VId vid);
+
+    // Returns the source for md, or the empty string if md can't be lowered.
+    std::string box(const ModuleDeclaration* md);
+
+  private:
+    // Variables:
+    struct Var {
+      const Identifier* id;
+      size_t width;
+      bool sign;
+      size_t arity;
+      // Continuous assigns which read this variable
+      std::vector<size_t> fanout;
+      // Triggers which are sensitive to this variable
+      std::vector<size_t> triggers;
+    };
+    // Triggers: An event which causes a process to run. Triggers without an
+    // identifier fire unconditionally.
+    struct Trigger {
+      const Identifier* id;
+      Event::Type type;
+      size_t proc;
+    };
+
+    // Configuration State:
+    std::vector<std::pair<const Identifier*, VId>> reads_;
+    std::vector<std::pair<const Identifier*, VId>> writes_;
+    std::vector<std::pair<const Identifier*, VId>> state_;
+
+    // Program Structure:
+    std::vector<Var> vars_;
+    std::unordered_map<const Identifier*, size_t> index_;
+    std::vector<const VariableAssign*> assigns_;
+    std::vector<const Statement*> procs_;
+    std::vector<Trigger> triggers_;
+    std::vector<size_t> initials_;
+    std::vector<const NonblockingAssign*> updates_;
+    std::map<std::string, std::string> consts_;
+
+    // Code Generation State:
+    bool ok_;
+    std::string res_;
+    indstream* os_;
+    size_t next_tmp_;
+
+    // Analysis Helpers:
+    void declare(const Identifier* id);
+    void levelize(const std::vector<const VariableAssign*>& cas);
+    void sensitize(size_t t, const Identifier* id);
+    const Var* lookup(const Identifier* id);
+
+    // Code Printing Helpers:
+    void emit_variables(indstream& os);
+    void emit_constructor(indstream& os);
+    void emit_state_interface(indstream& os);
+    void emit_core_interface(indstream& os);
+    void emit_scheduler(indstream& os);
+    void emit_notify(indstream& os);
+    void emit_processes(indstream& os);
+    void emit_assign(const VariableAssign* va);
+    void emit_printf(const Many<Expression>* args);
+
+    // Expression Helpers:
+    std::string expr(const Expression* e);
+    std::string expr(const Expression* e, size_t w, bool s);
+    std::string deref(const Identifier* id, const Var& v, const Expression** range);
+    void range(const Expression* re, const Var& v, std::string* msb, std::string* lsb);
+    static std::string type(size_t w, bool s);
+    static std::string cast(const std::string& code, size_t w1, bool s1, size_t w2, bool s2);
+    static std::string var(size_t idx);
+    static std::string literal(const std::string& s);
+
+    // Visitor Interface:
+    void visit(const BinaryExpression* be) override;
+    void visit(const ConditionalExpression* ce) override;
+    void visit(const NestedExpression* ne) override;
+    void visit(const Concatenation* c) override;
+    void visit(const Identifier* id) override;
+    void visit(const MultipleConcatenation* mc) override;
+    void visit(const Number* n) override;
+    void visit(const String* s) override;
+    void visit(const RangeExpression* re) override;
+    void visit(const UnaryExpression* ue) override;
+    void visit(const BlockingAssign* ba) override;
+    void visit(const NonblockingAssign* na) override;
+    void visit(const CaseStatement* cs) override;
+    void visit(const ConditionalStatement* cs) override;
+    void visit(const ForStatement* fs) override;
+    void visit(const ForeverStatement* fs) override;
+    void visit(const RepeatStatement* rs) override;
+    void visit(const ParBlock* pb) override;
+    void visit(const SeqBlock* sb) override;
+    void visit(const TimingControlStatement* tcs) override;
+    void visit(const DisplayStatement* ds) override;
+    void visit(const FinishStatement* fs) override;
+    void visit(const WriteStatement* ws) override;
+    void visit(const WaitStatement* ws) override;
+    void visit(const WhileStatement* ws) override;
+};
+
+} // namespace cascade
+
+#endif
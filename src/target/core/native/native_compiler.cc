@@ -0,0 +1,251 @@
+// Copyright 2017-2018 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "src/target/core/native/native_compiler.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <fstream>
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "src/base/system/system.h"
+#include "src/target/core/native/cpp_boxer.h"
+#include "src/target/core/sw/sw_logic.h"
+#include "src/verilog/analyze/module_info.h"
+#include "src/verilog/ast/ast.h"
+
+using namespace std;
+
+namespace cascade {
+
+NativeCompiler::NativeCompiler() : CoreCompiler() {
+  set_cxx("c++");
+  set_src_root(System::src_root());
+
+  aborted_ = false;
+  next_seq_ = 1;
+  stats_.native = 0;
+  stats_.fallback = 0;
+}
+
+NativeCompiler& NativeCompiler::set_cxx(const string& cxx) {
+  cxx_ = cxx;
+  return *this;
+}
+
+NativeCompiler& NativeCompiler::set_src_root(const string& root) {
+  src_root_ = root;
+  return *this;
+}
+
+void NativeCompiler::abort() {
+  // Kill any outstanding invocations of the host compiler. The threads
+  // waiting on them will notice that we've aborted and return nullptr.
+  lock_guard<mutex> lg(lock_);
+  aborted_ = true;
+  for (auto p : pids_) {
+    kill(-p, SIGKILL);
+  }
+}
+
+NativeCompiler::Stats NativeCompiler::get_stats() {
+  lock_guard<mutex> lg(lock_);
+  return stats_;
+}
+
+Logic* NativeCompiler::compile_logic(Interface* interface, ModuleDeclaration* md) {
+  ModuleInfo info(md);
+  CppBoxer cb;
+  for (auto i : info.inputs()) {
+    cb.set_read(i, to_vid(i));
+  }
+  for (auto o : info.outputs()) {
+    cb.set_write(o, to_vid(o));
+  }
+  for (auto s : info.stateful()) {
+    cb.set_state(s, to_vid(s));
+  }
+  const auto src = cb.box(md);
+  if (src == "") {
+    return fallback(interface, md, "");
+  }
+
+  // Record which sequence number this module is waiting on. If a newer
+  // version of this module shows up while we're compiling, this result is
+  // out of date and can be discarded.
+  const auto mid = to_mid(md->get_id());
+  size_t my_seq = 0;
+  { lock_guard<mutex> lg(lock_);
+    if (aborted_) {
+      delete md;
+      return nullptr;
+    }
+    my_seq = next_seq_++;
+    wait_table_[mid] = my_seq;
+  }
+
+  char tmpl[] = "/tmp/cascade_native_XXXXXX";
+  if (mkdtemp(tmpl) == nullptr) {
+    return fallback(interface, md, string("unable to create a temporary directory: ") + strerror(errno));
+  }
+  const string dir = tmpl;
+  string what;
+  const auto result = build(dir, src, &what);
+
+  { lock_guard<mutex> lg(lock_);
+    if (aborted_ || (my_seq < wait_table_[mid])) {
+      remove((dir + "/program.cc").c_str());
+      remove((dir + "/program.so").c_str());
+      rmdir(dir.c_str());
+      delete md;
+      return nullptr;
+    }
+  }
+
+  // The shared object can be unlinked as soon as it's been opened.
+  void* handle = result ? dlopen((dir + "/program.so").c_str(), RTLD_NOW | RTLD_LOCAL) : nullptr;
+  if (result && (handle == nullptr)) {
+    what = string("unable to load shared object: ") + dlerror();
+  }
+  remove((dir + "/program.cc").c_str());
+  remove((dir + "/program.so").c_str());
+  rmdir(dir.c_str());
+  if (handle == nullptr) {
+    return fallback(interface, md, what);
+  }
+  const auto factory = (NativeProgram::Factory)dlsym(handle, NativeProgram::factory());
+  if (factory == nullptr) {
+    what = string("unable to find program factory: ") + dlerror();
+    dlclose(handle);
+    return fallback(interface, md, what);
+  }
+
+  auto c = new NativeLogic(interface, handle, factory(interface));
+  for (auto i : info.inputs()) {
+    c->set_read(to_vid(i));
+  }
+  for (auto s : info.stateful()) {
+    c->set_state(to_vid(s));
+  }
+  delete md;
+
+  { lock_guard<mutex> lg(lock_);
+    ++stats_.native;
+  }
+  return c;
+}
+
+bool NativeCompiler::build(const string& dir, const string& src, string* what) {
+  ofstream ofs(dir + "/program.cc");
+  ofs << src;
+  ofs.close();
+  if (!ofs) {
+    *what = "unable to write " + dir + "/program.cc";
+    return false;
+  }
+
+  const auto include = "-I" + src_root_;
+  const auto out = dir + "/program.so";
+  const auto in = dir + "/program.cc";
+  const char* argv[] = {
+    cxx_.c_str(), "-std=c++14", "-O2", "-fPIC", "-shared", "-DNDEBUG", "-w",
+    include.c_str(), "-o", out.c_str(), in.c_str(), nullptr
+  };
+
+  // Run the host compiler in its own process group, so that abort() can kill
+  // it along with anything that it spawns.
+  pid_t pid = 0;
+  { lock_guard<mutex> lg(lock_);
+    if (aborted_) {
+      *what = "compilation was aborted";
+      return false;
+    }
+    pid = fork();
+    if (pid == 0) {
+      setpgid(0, 0);
+      const auto fd = open("/dev/null", O_WRONLY);
+      dup2(fd, STDOUT_FILENO);
+      dup2(fd, STDERR_FILENO);
+      execvp(argv[0], const_cast<char* const*>(argv));
+      _exit(127);
+    } else if (pid < 0) {
+      *what = string("unable to run the host compiler: ") + strerror(errno);
+      return false;
+    }
+    setpgid(pid, pid);
+    pids_.insert(pid);
+  }
+
+  int status = 0;
+  const auto res = waitpid(pid, &status, 0);
+  { lock_guard<mutex> lg(lock_);
+    pids_.erase(pid);
+  }
+  if (res != pid) {
+    *what = string("unable to wait for the host compiler: ") + strerror(errno);
+    return false;
+  } else if (WIFSIGNALED(status)) {
+    *what = "host compiler " + cxx_ + " was killed by signal " + to_string(WTERMSIG(status));
+    return false;
+  } else if (!WIFEXITED(status) || (WEXITSTATUS(status) != 0)) {
+    *what = "host compiler " + cxx_ + " exited with status " + to_string(WEXITSTATUS(status));
+    return false;
+  }
+  return true;
+}
+
+Logic* NativeCompiler::fallback(Interface* interface, ModuleDeclaration* md, const string& why) {
+  if (why != "") {
+    interface->warning("Native compilation failed, falling back to software: " + why);
+  }
+  { lock_guard<mutex> lg(lock_);
+    ++stats_.fallback;
+  }
+
+  ModuleInfo info(md);
+  auto c = new SwLogic(interface, md, false);
+  for (auto i : info.inputs()) {
+    c->set_read(i, to_vid(i));
+  }
+  for (auto o : info.outputs()) {
+    c->set_write(o, to_vid(o));
+  }
+  for (auto s : info.stateful()) { 
+    c->set_state(s, to_vid(s));
+  }
+  return c;
+}
+
+} // namespace cascade
@@ -0,0 +1,97 @@
+// Copyright 2017-2018 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CASCADE_SRC_TARGET_CORE_NATIVE_NATIVE_COMPILER_H
+#define CASCADE_SRC_TARGET_CORE_NATIVE_NATIVE_COMPILER_H
+
+#include <mutex>
+#include <string>
+#include <sys/types.h>
+#include <unordered_map>
+#include <unordered_set>
+#include "src/target/core_compiler.h"
+#include "src/target/core/native/native_logic.h"
+
+namespace cascade {
+
+// This compiler lowers logic modules to c++ (see CppBoxer), builds the result
+// into a shared object using the host c++ compiler, and loads it into the
+// running process. Modules which CppBoxer can't handle, or which the host
+// compiler rejects, are compiled to SwLogic instead so that a jit request
+// never makes things worse than they were. Failures other than unsupported
+// language features are reported as warnings.
+
+class NativeCompiler : public CoreCompiler {
+  public:
+    // Compilation Statistics:
+    //
+    // The number of modules which were loaded as native code, and the number
+    // which fell back to SwLogic for any reason.
+    struct Stats {
+      size_t native;
+      size_t fallback;
+    };
+
+    NativeCompiler();
+    ~NativeCompiler() override = default;
+
+    NativeCompiler& set_cxx(const std::string& cxx);
+    NativeCompiler& set_src_root(const std::string& root);
+
+    void abort() override;
+
+    Stats get_stats();
+
+  private:
+    // Host Compiler Configuration:
+    std::string cxx_;
+    std::string src_root_;
+
+    // Compilation Request Ordering:
+    std::mutex lock_;
+    bool aborted_;
+    size_t next_seq_;
+    std::unordered_map<MId, size_t> wait_table_;
+    std::unordered_set<pid_t> pids_;
+    Stats stats_;
+
+    Logic* compile_logic(Interface* interface, ModuleDeclaration* md) override;
+
+    // Runs the host compiler on src, placing the result in dir. Returns true
+    // on success, otherwise explains what went wrong in what.
+    bool build(const std::string& dir, const std::string& src, std::string* what);
+    // Returns an instance of SwLogic for md. If why is non-empty, it's
+    // reported to the user as a warning.
+    Logic* fallback(Interface* interface, ModuleDeclaration* md, const std::string& why);
+};
+
+} // namespace cascade
+
+#endif
@@ -0,0 +1,103 @@
+// Copyright 2017-2018 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "src/target/core/native/native_logic.h"
+
+#include <dlfcn.h>
+#include "src/target/input.h"
+#include "src/target/state.h"
+
+using namespace std;
+
+namespace cascade {
+
+NativeLogic::NativeLogic(Interface* interface, void* handle, NativeProgram* program) : Logic(interface) {
+  handle_ = handle;
+  program_ = program;
+}
+
+NativeLogic::~NativeLogic() {
+  // The program's code lives in the shared object, so it has to be torn down
+  // before the library is unloaded.
+  delete program_;
+  dlclose(handle_);
+}
+
+NativeLogic& NativeLogic::set_read(VId vid) {
+  reads_.push_back(vid);
+  return *this;
+}
+
+NativeLogic& NativeLogic::set_state(VId vid) {
+  state_.push_back(vid);
+  return *this;
+}
+
+State* NativeLogic::get_state() {
+  auto s = new State();
+  vector<Bits> bs;
+  for (auto v : state_) {
+    program_->get(v, &bs);
+    s->insert(v, bs);
+  }
+  return s;
+}
+
+void NativeLogic::set_state(const State* s) {
+  for (auto v : state_) {
+    const auto itr = s->find(v);
+    if (itr != s->end()) {
+      program_->set(v, itr->second);
+    }
+  }
+}
+
+Input* NativeLogic::get_input() {
+  auto i = new Input();
+  vector<Bits> bs;
+  for (auto v : reads_) {
+    program_->get(v, &bs);
+    i->insert(v, bs[0]);
+  }
+  return i;
+}
+
+void NativeLogic::set_input(const Input* i) {
+  vector<Bits> bs(1);
+  for (auto v : reads_) {
+    const auto itr = i->find(v);
+    if (itr != i->end()) {
+      bs[0] = itr->second;
+      program_->set(v, bs);
+    }
+  }
+}
+
+} // namespace cascade
@@ -0,0 +1,107 @@
+// Copyright 2017-2018 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CASCADE_SRC_TARGET_CORE_NATIVE_NATIVE_LOGIC_H
+#define CASCADE_SRC_TARGET_CORE_NATIVE_NATIVE_LOGIC_H
+
+#include <vector>
+#include "src/base/bits/bits.h"
+#include "src/target/core.h"
+#include "src/target/core/native/native_program.h"
+
+namespace cascade {
+
+// This class is a thin wrapper around a NativeProgram which has been loaded
+// from a shared object. It translates between the Core interface and the
+// program, and takes ownership of both the program and the library handle
+// which it was loaded from.
+
+class NativeLogic : public Logic {
+  public:
+    NativeLogic(Interface* interface, void* handle, NativeProgram* program);
+    ~NativeLogic() override;
+
+    // Configuration Logic:
+    NativeLogic& set_read(VId vid);
+    NativeLogic& set_state(VId vid);
+
+    // Core Interface:
+    State* get_state() override;
+    void set_state(const State* s) override;
+    Input* get_input() override;
+    void set_input(const Input* i) override;
+    void resync() override; 
+
+    void read(VId vid, const Bits* b) override;
+    void evaluate() override;
+    bool there_are_updates() const override;
+    void update() override;
+    bool there_were_tasks() const override;
+
+    size_t open_loop(VId clk, bool val, size_t itr) override;
+
+  private:
+    void* handle_;
+    NativeProgram* program_;
+    std::vector<VId> reads_;
+    std::vector<VId> state_;
+};
+
+inline void NativeLogic::resync() {
+  program_->resync();
+}
+
+inline void NativeLogic::read(VId vid, const Bits* b) {
+  program_->read(vid, b);
+}
+
+inline void NativeLogic::evaluate() {
+  program_->evaluate();
+}
+
+inline bool NativeLogic::there_are_updates() const {
+  return program_->there_are_updates();
+}
+
+inline void NativeLogic::update() {
+  program_->update();
+}
+
+inline bool NativeLogic::there_were_tasks() const {
+  return program_->there_were_tasks();
+}
+
+inline size_t NativeLogic::open_loop(VId clk, bool val, size_t itr) {
+  return program_->open_loop(clk, val, itr);
+}
+
+} // namespace cascade
+
+#endif
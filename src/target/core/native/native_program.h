@@ -0,0 +1,408 @@
+// Copyright 2017-2018 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CASCADE_SRC_TARGET_CORE_NATIVE_NATIVE_PROGRAM_H
+#define CASCADE_SRC_TARGET_CORE_NATIVE_NATIVE_PROGRAM_H
+
+#include <algorithm>
+#include <initializer_list>
+#include <ostream>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "src/base/bits/bits.h"
+#include "src/base/bits/fixed_bits.h"
+#include "src/runtime/ids.h"
+#include "src/target/interface.h"
+
+namespace cascade {
+
+// This class is the boundary between NativeLogic and the c++ code which
+// CppBoxer generates for a module. Generated programs derive from this class,
+// are compiled into shared objects, and export a factory function with the
+// name returned by factory(). Shared objects are loaded without access to the
+// symbols in the cascade binary, so everything on this side of the boundary
+// must be header-only.
+//
+// The protected members below are the runtime support for generated code: a
+// dirty bitset for continuous assigns, a stack of pending triggers, and the
+// operators which generated expressions are built from. The operators follow
+// the same conventions as Bytecode (see src/verilog/analyze/bytecode.h).
+
+class NativeProgram {
+  public:
+    // Factory Interface:
+    typedef NativeProgram* (*Factory)(Interface*);
+    static const char* factory();
+
+    // Constructors:
+    explicit NativeProgram(Interface* interface);
+    virtual ~NativeProgram() = default;
+
+    // State Interface:
+    virtual void get(VId id, std::vector<Bits>* bs) = 0;
+    virtual void set(VId id, const std::vector<Bits>& bs) = 0;
+
+    // Core Interface:
+    virtual void read(VId id, const Bits* b) = 0;
+    virtual void resync() = 0;
+    virtual void evaluate() = 0;
+    virtual bool there_are_updates() const = 0;
+    virtual void update() = 0;
+    virtual bool there_were_tasks() const = 0;
+    virtual size_t open_loop(VId clk, bool val, size_t itr) = 0;
+
+  protected:
+    template <size_t W, bool S>
+    using B = FixedBits<W, S>;
+
+    // A pending non-blocking assignment. Msb is -1 for whole-word writes.
+    template <size_t W, bool S>
+    struct Update {
+      size_t idx;
+      size_t msb;
+      size_t lsb;
+      B<W, S> val;
+    };
+
+    Interface* interface_;
+
+    // Control State:
+    bool silent_;
+    bool there_were_tasks_;
+
+    // Scheduling:
+    void provision(size_t assigns, size_t triggers);
+    void mark(size_t i);
+    size_t next_dirty();
+    void schedule(size_t t);
+    size_t next_active();
+
+    // Output Helpers:
+    template <size_t W, bool S>
+    void write(VId id, const B<W, S>& x);
+    template <size_t W, bool S>
+    static void print(std::ostream& os, const B<W, S>& x, size_t base);
+
+    // Conversion Helpers:
+    template <size_t W, bool S>
+    static B<W, S> lit(std::initializer_list<uint64_t> words);
+    template <size_t W, bool S, size_t W2, bool S2>
+    static B<W, S> cast(const B<W2, S2>& x);
+    static B<1, false> bit(bool b);
+
+    // Subscript Helpers:
+    static size_t ix(size_t idx, size_t n);
+    template <size_t W, bool S, size_t W2, bool S2>
+    static B<W, S> slice(const B<W2, S2>& x, size_t msb, size_t lsb);
+    template <size_t W, bool S, size_t W2, bool S2>
+    static void put(B<W, S>& x, size_t msb, size_t lsb, const B<W2, S2>& val);
+
+    // Operators:
+    template <size_t W, bool S>
+    static B<W, S> add(const B<W, S>& x, const B<W, S>& y);
+    template <size_t W, bool S>
+    static B<W, S> sub(const B<W, S>& x, const B<W, S>& y);
+    template <size_t W, bool S>
+    static B<W, S> mul(const B<W, S>& x, const B<W, S>& y);
+    template <size_t W, bool S>
+    static B<W, S> div(const B<W, S>& x, const B<W, S>& y);
+    template <size_t W, bool S>
+    static B<W, S> mod(const B<W, S>& x, const B<W, S>& y);
+    template <size_t W, bool S>
+    static B<W, S> pow(const B<W, S>& x, const B<W, S>& y);
+    template <size_t W, bool S>
+    static B<W, S> band(const B<W, S>& x, const B<W, S>& y);
+    template <size_t W, bool S>
+    static B<W, S> bor(const B<W, S>& x, const B<W, S>& y);
+    template <size_t W, bool S>
+    static B<W, S> bxor(const B<W, S>& x, const B<W, S>& y);
+    template <size_t W, bool S>
+    static B<W, S> bxnor(const B<W, S>& x, const B<W, S>& y);
+    template <size_t W, bool S>
+    static B<W, S> sll(const B<W, S>& x, size_t samt);
+    template <size_t W, bool S>
+    static B<W, S> slr(const B<W, S>& x, size_t samt);
+    template <size_t W, bool S>
+    static B<W, S> sar(const B<W, S>& x, size_t samt);
+    template <size_t W, bool S>
+    static B<W, S> neg(const B<W, S>& x);
+    template <size_t W, bool S>
+    static B<W, S> bnot(const B<W, S>& x);
+    template <size_t W, bool S>
+    static B<W, false> cat(const B<W, S>& x);
+    template <size_t N, size_t W, bool S>
+    static B<N*W, false> rep(const B<W, S>& x);
+
+  private:
+    std::vector<uint64_t> dirty_;
+    size_t dirty_begin_;
+    std::vector<size_t> active_;
+    std::vector<bool> queued_;
+    Bits scratch_;
+};
+
+inline const char* NativeProgram::factory() {
+  return "cascade_native_program";
+}
+
+inline NativeProgram::NativeProgram(Interface* interface) {
+  interface_ = interface;
+  silent_ = false;
+  there_were_tasks_ = false;
+  dirty_begin_ = 0;
+}
+
+inline void NativeProgram::provision(size_t assigns, size_t triggers) {
+  dirty_.resize((assigns+63)/64, 0);
+  dirty_begin_ = dirty_.size();
+  queued_.resize(triggers, false);
+}
+
+inline void NativeProgram::mark(size_t i) {
+  const auto w = i / 64;
+  dirty_[w] |= (uint64_t(1) << (i % 64));
+  dirty_begin_ = std::min(dirty_begin_, w);
+}
+
+inline size_t NativeProgram::next_dirty() {
+  for (const auto de = dirty_.size(); dirty_begin_ < de; ++dirty_begin_) {
+    auto& w = dirty_[dirty_begin_];
+    if (w != 0) {
+      const auto b = __builtin_ctzll(w);
+      w &= (w-1);
+      return 64*dirty_begin_ + b;
+    }
+  }
+  return -1;
+}
+
+inline void NativeProgram::schedule(size_t t) {
+  if (!queued_[t]) {
+    queued_[t] = true;
+    active_.push_back(t);
+  }
+}
+
+inline size_t NativeProgram::next_active() {
+  if (active_.empty()) {
+    return -1;
+  }
+  const auto t = active_.back();
+  active_.pop_back();
+  queued_[t] = false;
+  return t;
+}
+
+template <size_t W, bool S>
+inline void NativeProgram::write(VId id, const B<W, S>& x) {
+  if (W == 1) {
+    interface_->write(id, x.get(0));
+  } else {
+    x.write(scratch_);
+    interface_->write(id, &scratch_);
+  }
+}
+
+template <size_t W, bool S>
+inline void NativeProgram::print(std::ostream& os, const B<W, S>& x, size_t base) {
+  x.to_bits().write(os, base);
+}
+
+template <size_t W, bool S>
+inline NativeProgram::B<W, S> NativeProgram::lit(std::initializer_list<uint64_t> words) {
+  // Words are listed from most to least significant. Shifting in 32 bits at a
+  // time works regardless of the word size of the underlying representation.
+  B<W, S> res;
+  for (auto w : words) {
+    res.bitwise_sll(32, res);
+    res.bitwise_or(B<W, S>(w >> 32), res);
+    res.bitwise_sll(32, res);
+    res.bitwise_or(B<W, S>(w & 0xffffffff), res);
+  }
+  return res;
+}
+
+template <size_t W, bool S, size_t W2, bool S2>
+inline NativeProgram::B<W, S> NativeProgram::cast(const B<W2, S2>& x) {
+  B<W, S> res;
+  res.assign(x);
+  return res;
+}
+
+inline NativeProgram::B<1, false> NativeProgram::bit(bool b) {
+  return B<1, false>(b ? 1 : 0);
+}
+
+inline size_t NativeProgram::ix(size_t idx, size_t n) {
+  // Out of bounds accesses are undefined, so we'll map them to a safe value
+  return (idx < n) ? idx : 0;
+}
+
+template <size_t W, bool S, size_t W2, bool S2>
+inline NativeProgram::B<W, S> NativeProgram::slice(const B<W2, S2>& x, size_t msb, size_t lsb) {
+  msb = std::min(msb, W2-1);
+  lsb = std::min(lsb, W2-1);
+  B<W, S> res;
+  res.assign(x, std::max(msb, lsb), lsb);
+  return res;
+}
+
+template <size_t W, bool S, size_t W2, bool S2>
+inline void NativeProgram::put(B<W, S>& x, size_t msb, size_t lsb, const B<W2, S2>& val) {
+  msb = std::min(msb, W-1);
+  lsb = std::min(lsb, W-1);
+  x.assign(std::max(msb, lsb), lsb, val);
+}
+
+template <size_t W, bool S>
+inline NativeProgram::B<W, S> NativeProgram::add(const B<W, S>& x, const B<W, S>& y) {
+  B<W, S> res;
+  x.arithmetic_plus(y, res);
+  return res;
+}
+
+template <size_t W, bool S>
+inline NativeProgram::B<W, S> NativeProgram::sub(const B<W, S>& x, const B<W, S>& y) {
+  B<W, S> res;
+  x.arithmetic_minus(y, res);
+  return res;
+}
+
+template <size_t W, bool S>
+inline NativeProgram::B<W, S> NativeProgram::mul(const B<W, S>& x, const B<W, S>& y) {
+  B<W, S> res;
+  x.arithmetic_multiply(y, res);
+  return res;
+}
+
+template <size_t W, bool S>
+inline NativeProgram::B<W, S> NativeProgram::div(const B<W, S>& x, const B<W, S>& y) {
+  B<W, S> res;
+  x.arithmetic_divide(y, res);
+  return res;
+}
+
+template <size_t W, bool S>
+inline NativeProgram::B<W, S> NativeProgram::mod(const B<W, S>& x, const B<W, S>& y) {
+  B<W, S> res;
+  x.arithmetic_mod(y, res);
+  return res;
+}
+
+template <size_t W, bool S>
+inline NativeProgram::B<W, S> NativeProgram::pow(const B<W, S>& x, const B<W, S>& y) {
+  B<W, S> res;
+  x.arithmetic_pow(y, res);
+  return res;
+}
+
+template <size_t W, bool S>
+inline NativeProgram::B<W, S> NativeProgram::band(const B<W, S>& x, const B<W, S>& y) {
+  B<W, S> res;
+  x.bitwise_and(y, res);
+  return res;
+}
+
+template <size_t W, bool S>
+inline NativeProgram::B<W, S> NativeProgram::bor(const B<W, S>& x, const B<W, S>& y) {
+  B<W, S> res;
+  x.bitwise_or(y, res);
+  return res;
+}
+
+template <size_t W, bool S>
+inline NativeProgram::B<W, S> NativeProgram::bxor(const B<W, S>& x, const B<W, S>& y) {
+  B<W, S> res;
+  x.bitwise_xor(y, res);
+  return res;
+}
+
+template <size_t W, bool S>
+inline NativeProgram::B<W, S> NativeProgram::bxnor(const B<W, S>& x, const B<W, S>& y) {
+  B<W, S> res;
+  x.bitwise_xnor(y, res);
+  return res;
+}
+
+template <size_t W, bool S>
+inline NativeProgram::B<W, S> NativeProgram::sll(const B<W, S>& x, size_t samt) {
+  B<W, S> res;
+  x.bitwise_sll(std::min(samt, W), res);
+  return res;
+}
+
+template <size_t W, bool S>
+inline NativeProgram::B<W, S> NativeProgram::slr(const B<W, S>& x, size_t samt) {
+  B<W, S> res;
+  x.bitwise_slr(std::min(samt, W), res);
+  return res;
+}
+
+template <size_t W, bool S>
+inline NativeProgram::B<W, S> NativeProgram::sar(const B<W, S>& x, size_t samt) {
+  B<W, S> res;
+  x.bitwise_sar(std::min(samt, W), res);
+  return res;
+}
+
+template <size_t W, bool S>
+inline NativeProgram::B<W, S> NativeProgram::neg(const B<W, S>& x) {
+  B<W, S> res;
+  x.arithmetic_minus(res);
+  return res;
+}
+
+template <size_t W, bool S>
+inline NativeProgram::B<W, S> NativeProgram::bnot(const B<W, S>& x) {
+  B<W, S> res;
+  x.bitwise_not(res);
+  return res;
+}
+
+template <size_t W, bool S>
+inline NativeProgram::B<W, false> NativeProgram::cat(const B<W, S>& x) {
+  return cast<W, false>(x);
+}
+
+template <size_t N, size_t W, bool S>
+inline NativeProgram::B<N*W, false> NativeProgram::rep(const B<W, S>& x) {
+  const auto y = cast<N*W, false>(cat(x));
+  B<N*W, false> res;
+  for (size_t i = 0; i < N; ++i) {
+    res.bitwise_sll(W, res);
+    res.bitwise_or(y, res);
+  }
+  return res;
+}
+
+} // namespace cascade
+
+#endif
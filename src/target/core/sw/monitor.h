@@ -32,7 +32,6 @@
 #define CASCADE_SRC_TARGET_CORE_SW_MONITOR_H
 
 #include <cassert>
-#include "src/verilog/analyze/read_set.h"
 #include "src/verilog/analyze/resolve.h"
 #include "src/verilog/ast/ast.h"
 #include "src/verilog/ast/visitors/editor.h"
@@ -48,7 +47,6 @@ class Monitor : public Editor {
 
   private:
     void wait_on_node(Node* n, Node* m);
-    void wait_on_reads(Node* n, Expression* e);
 
     void edit(Event* e) override;
     void edit(AlwaysConstruct* ac) override;
@@ -75,14 +73,6 @@ inline void Monitor::wait_on_node(Node* n, Node* m) {
   m->monitor_.push_back(n);
 }
 
-inline void Monitor::wait_on_reads(Node* n, Expression* m) {
-  for (auto i : ReadSet(m)) {
-    auto r = Resolve().get_resolution(i);
-    assert(r != nullptr);
-    wait_on_node(n, const_cast<Identifier*>(r));
-  }
-}
-
 inline void Monitor::edit(Event* e) {
   // TODO: Support for complex expressions here
   auto id = dynamic_cast<Identifier*>(e->get_expr());
@@ -98,8 +88,9 @@ inline void Monitor::edit(AlwaysConstruct* ac) {
 }
 
 inline void Monitor::edit(ContinuousAssign* ca) {
-  Editor::edit(ca);
-  wait_on_reads(ca, ca->get_assign()->get_rhs());
+  // Does nothing. Continuous assigns are scheduled directly by SwLogic, which
+  // tracks their sensitivities itself (see sw_logic.h).
+  (void) ca;
 }
 
 inline void Monitor::edit(ParBlock* pb) {
@@ -156,14 +147,9 @@ inline void Monitor::edit(WaitStatement* ws) {
 }
 
 inline void Monitor::edit(EventControl* ec) {
+  // Implicit event controls are woken up by SwLogic, which tracks their
+  // sensitivities itself (see sw_logic.h).
   if (ec->get_events()->empty()) {
-    auto tcs = dynamic_cast<TimingControlStatement*>(ec->get_parent());
-    assert(tcs != nullptr);
-    for (auto i : ReadSet(tcs->get_stmt())) {
-      auto r = Resolve().get_resolution(i);
-      assert(r != nullptr);
-      wait_on_node(ec, const_cast<Identifier*>(r));
-    }
     return;
   }
 
@@ -49,6 +49,7 @@ class SwClock : public Clock {
     void set_state(const State* s) override;
     Input* get_input() override;
     void set_input(const Input* i) override;
+    bool is_thread_safe() const override;
 
     bool overrides_done_step() const override;
     void done_step() override;
@@ -94,6 +95,10 @@ inline void SwClock::set_input(const Input* i) {
   (void) i;
 }
 
+inline bool SwClock::is_thread_safe() const {
+  return true;
+}
+
 inline bool SwClock::overrides_done_step() const {
   return true;
 }
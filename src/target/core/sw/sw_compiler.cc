@@ -42,6 +42,7 @@ namespace cascade {
 
 SwCompiler::SwCompiler() : CoreCompiler() { 
   set_include_dirs("");
+  set_levelized(false);
   set_led(nullptr, nullptr);
   set_pad(nullptr, nullptr);
   set_reset(nullptr, nullptr);
@@ -52,6 +53,11 @@ SwCompiler& SwCompiler::set_include_dirs(const std::string& s) {
   return *this;
 }
 
+SwCompiler& SwCompiler::set_levelized(bool l) {
+  levelized_ = l;
+  return *this;
+}
+
 SwCompiler& SwCompiler::set_led(Bits* b, mutex* l) {
   led_ = b;
   led_lock_ = l;
@@ -180,7 +186,7 @@ SwLed* SwCompiler::compile_led(Interface* interface, ModuleDeclaration* md) {
 
 SwLogic* SwCompiler::compile_logic(Interface* interface, ModuleDeclaration* md) {
   ModuleInfo info(md);
-  auto c = new SwLogic(interface, md);
+  auto c = new SwLogic(interface, md, levelized_);
   for (auto i : info.inputs()) {
     c->set_read(i, to_vid(i));
   }
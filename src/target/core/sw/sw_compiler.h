@@ -50,6 +50,7 @@ class SwCompiler : public CoreCompiler {
     ~SwCompiler() override = default;
 
     SwCompiler& set_include_dirs(const std::string& s);
+    SwCompiler& set_levelized(bool l);
     SwCompiler& set_led(Bits* b, std::mutex* l);
     SwCompiler& set_pad(Bits* b, std::mutex* l);
     SwCompiler& set_reset(Bits* b, std::mutex* l);
@@ -66,6 +67,7 @@ class SwCompiler : public CoreCompiler {
     SwReset* compile_reset(Interface* interface, ModuleDeclaration* md) override;
 
     std::string include_dirs_;
+    bool levelized_;
 
     Bits* led_;
     Bits* pad_;
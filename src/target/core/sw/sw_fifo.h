@@ -59,6 +59,7 @@ class SwFifo : public Fifo {
     void set_state(const State* s) override;
     Input* get_input() override;
     void set_input(const Input* i) override;
+    bool is_thread_safe() const override;
 
     void read(VId id, const Bits* b) override;
     void evaluate() override;
@@ -249,6 +250,10 @@ inline void SwFifo::set_input(const Input* i) {
   wdata_ = i->find(wdata_id_)->second;
 }
 
+inline bool SwFifo::is_thread_safe() const {
+  return true;
+}
+
 inline void SwFifo::read(VId id, const Bits* b) {
   if (id == clock_id_) {
     const auto cold = clock_;
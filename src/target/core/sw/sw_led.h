@@ -46,6 +46,7 @@ class SwLed : public Led {
     void set_state(const State* s) override;
     Input* get_input() override;
     void set_input(const Input* i) override;
+    bool is_thread_safe() const override;
 
     void read(VId id, const Bits* b) override;
     void evaluate() override;
@@ -90,6 +91,10 @@ inline void SwLed::set_input(const Input* i) {
   }
 }
 
+inline bool SwLed::is_thread_safe() const {
+  return true;
+}
+
 inline void SwLed::read(VId id, const Bits* b) {
   (void) id;
   std::lock_guard<std::mutex> lg(*lock_);
@@ -36,9 +36,11 @@
 #include "src/target/core/sw/monitor.h"
 #include "src/target/input.h"
 #include "src/target/interface.h"
+#include "src/verilog/analyze/constant.h"
 #include "src/verilog/analyze/evaluate.h"
 #include "src/verilog/analyze/module_info.h"
 #include "src/verilog/analyze/printf.h"
+#include "src/verilog/analyze/read_set.h"
 #include "src/verilog/analyze/resolve.h"
 #include "src/verilog/ast/ast.h"
 #include "src/verilog/print/text/text_printer.h"
@@ -47,15 +49,52 @@ using namespace std;
 
 namespace cascade {
 
-SwLogic::SwLogic(Interface* interface, ModuleDeclaration* md) : Logic(interface), Visitor() { 
+SwLogic::SwLogic(Interface* interface, ModuleDeclaration* md, bool levelized) : Logic(interface), Visitor() { 
   // Record pointer to source code
   src_ = md;
-  // Initialize monitors
+  levelized_ = levelized;
+  delays_ = false;
+  now_ = 0;
+  // Lower variable assignments to bytecode
+  Lower l(this);
   for (auto mi : *src_->get_items()) {
-    Monitor().init(mi);
+    mi->accept(&l);
   }
-  // Initial provision for update_pool_:
+  // Sort continuous assigns by level
+  levelize();
+  // Initialize monitors. Levelized always constructs are scheduled alongside
+  // continuous assigns and don't need any.
+  for (auto mi : *src_->get_items()) {
+    if (!dynamic_cast<const AlwaysConstruct*>(mi) || (get_state(mi) == 0)) {
+      Monitor().init(mi);
+    }
+  }
+  // Wire up sensitivities for implicit event controls, other than the ones
+  // which belong to levelized always constructs
+  for (auto ec : l.implicit_) {
+    const auto tcs = static_cast<const TimingControlStatement*>(ec->get_parent());
+    const auto ac = dynamic_cast<const AlwaysConstruct*>(tcs->get_parent());
+    if ((ac != nullptr) && (get_state(ac) != 0)) {
+      continue;
+    }
+    for (auto i : ReadSet(tcs->get_stmt())) {
+      sensitize(i, ec, 0);
+    }
+  }
+  // Flag statements which can be run directly
+  for (auto mi : *src_->get_items()) {
+    if (auto ac = dynamic_cast<const AlwaysConstruct*>(mi)) {
+      find_direct(ac->get_stmt());
+    } else if (auto ic = dynamic_cast<const InitialConstruct*>(mi)) {
+      find_direct(ic->get_stmt());
+    }
+  }
+  // Initial provision for update_pool_ and the timing wheel:
   update_pool_.resize(1);
+  if (delays_) {
+    wheel_.resize(256);
+    occupied_.resize(wheel_.size() / 64, 0);
+  }
 }
 
 SwLogic::~SwLogic() {
@@ -72,6 +111,9 @@ SwLogic& SwLogic::set_read(const Identifier* id, VId vid) {
 
 SwLogic& SwLogic::set_write(const Identifier* id, VId vid) {
   writes_.push_back(make_pair(id, vid));
+  const auto f = get_fanout(id);
+  fanout_[f].write = writes_.size();
+  flag_changed(f);
   return *this;
 }
 
@@ -85,6 +127,9 @@ State* SwLogic::get_state() {
   for (const auto& sv : state_) {
     s->insert(sv.first, Evaluate().get_array_value(sv.second));
   }
+  if (delays_) {
+    save_processes(s);
+  }
   return s;
 }
 
@@ -95,6 +140,10 @@ void SwLogic::set_state(const State* s) {
       Evaluate().assign_array_value(sv.second, itr->second);
     }
   }
+  if (delays_) {
+    resume_processes(s);
+  }
+  flag_all_changed();
 }
 
 Input* SwLogic::get_input() {
@@ -120,37 +169,74 @@ void SwLogic::set_input(const Input* i) {
       Evaluate().assign_value(id, itr->second);
     }
   }
+  flag_all_changed();
 }
 
 void SwLogic::resync() {
-  // Schedule always constructs and continuous assigns.
+  // Schedule always constructs and continuous assigns. Levelized always
+  // constructs are marked along with the continuous assigns.
+  const auto resumed = [this](const Node* n) {
+    return find(resumed_.begin(), resumed_.end(), n) != resumed_.end();
+  };
   for (auto mi : *src_->get_items()) {
-    if (dynamic_cast<const AlwaysConstruct*>(mi)) {
+    if (dynamic_cast<const AlwaysConstruct*>(mi) && (get_state(mi) == 0) && !resumed(mi)) {
       schedule_now(mi);
-    } else if (auto ca = dynamic_cast<const ContinuousAssign*>(mi)) {
-      schedule_now(ca);
-    }
+    } 
+  }
+  for (size_t i = 0, ie = assigns_.size(); i < ie; ++i) {
+    mark(i);
   }
   for (auto l : ModuleInfo(src_).inputs()) {
     notify(l);
   } 
+  flag_all_changed();
 
   // Turn on silent mode and drain the active queue
   silent_ = true;
-  while (!active_.empty()) {
-    auto e = active_.back();
-    active_.pop_back();
-    const_cast<Node*>(e)->active_ = false;
-    schedule_now(e);
-  }
+  drain_active();
   silent_ = false;
 
   // Now that signals have been propagated, schedule initial constructs
   for (auto mi : *src_->get_items()) {
-    if (auto ic = dynamic_cast<const InitialConstruct*>(mi)) {
-      schedule_now(ic);
+    if (dynamic_cast<const InitialConstruct*>(mi) && !resumed(mi)) {
+      schedule_now(mi);
     }
   }
+  resumed_.clear();
+}
+
+bool SwLogic::is_thread_safe() const {
+  // Every core owns the isolated copy of the module it was compiled from
+  return true;
+}
+
+bool SwLogic::overrides_done_step() const {
+  return delays_;
+}
+
+void SwLogic::done_step() {
+  // Advance the timing wheel and wake up anything which has expired. The
+  // runtime will find these statements in the active queue on the next time
+  // step (see there_are_updates()). Note that open_loop() calls this method
+  // unconditionally.
+  if (!delays_) {
+    return;
+  }
+  ++now_;
+  const auto idx = now_ % wheel_.size();
+  auto& slot = wheel_[idx];
+  for (size_t i = 0; i < slot.size(); ) {
+    if (slot[i].first == now_) {
+      notify(slot[i].second);
+      slot[i] = slot.back();
+      slot.pop_back();
+    } else {
+      ++i;
+    }
+  }
+  if (slot.empty()) {
+    occupied_[idx / 64] &= ~(uint64_t(1) << (idx % 64));
+  }
 }
 
 void SwLogic::read(VId vid, const Bits* b) {
@@ -162,48 +248,260 @@ void SwLogic::read(VId vid, const Bits* b) {
 void SwLogic::evaluate() {
   // This is a while loop. Active events can generate new active events.
   there_were_tasks_ = false;
-  while (!active_.empty()) {
-    auto e = active_.back();
-    active_.pop_back();
-    const_cast<Node*>(e)->active_ = false;
-    schedule_now(e);
-  }
-  for (auto& o : writes_) {
-    interface()->write(o.second, &Evaluate().get_value(o.first));
-  }
+  drain_active();
+  publish();
 }
 
 bool SwLogic::there_are_updates() const {
-  return !updates_.empty();
+  // Continuous assigns which were dirtied by a read that arrived after our
+  // last evaluation count as well. Nothing else will settle them.
+  return !updates_.empty() || !pending_.empty() || !active_.empty() || (dirty_begin_ < dirty_.size());
 }
 
 void SwLogic::update() {
-  // This is a for loop. Updates happen simultaneously
-  for (size_t i = 0, ie = updates_.size(); i < ie; ++i) {
-    const auto& val = update_pool_[i];
-    Evaluate().assign_value(get<0>(updates_[i]), get<1>(updates_[i]), get<2>(updates_[i]), get<3>(updates_[i]), val);
-    notify(get<0>(updates_[i]));
-  }
-  updates_.clear();
+  latch();
 
   // This is while loop. Active events can generate new active events.
   there_were_tasks_ = false;
-  while (!active_.empty()) {
-    auto e = active_.back();
-    active_.pop_back();
-    const_cast<Node*>(e)->active_ = false;
-    schedule_now(e);
-  }
+  drain_active();
 
-  for (auto& o : writes_) {
-    interface()->write(o.second, &Evaluate().get_value(o.first));
-  }
+  publish();
 }
 
 bool SwLogic::there_were_tasks() const {
   return there_were_tasks_;
 }
 
+size_t SwLogic::open_loop(VId clk, bool val, size_t itr) {
+  // There are no outputs in open loop mode (see core.h), so there's nothing
+  // to publish. The clock is toggled in place, which only wakes up the
+  // events which are sensitive to it, and tasks are checked once per
+  // iteration. Modules which never read their clock don't have one.
+  const auto id = (clk < reads_.size()) ? reads_[clk] : nullptr;
+  const auto fold = (id != nullptr) && posedge_only(id);
+  const auto idle = (id == nullptr) || ignores(id);
+  Bits bits(1, val);
+  size_t res = 0;
+  for (auto tasks = false; (res < itr) && !tasks; ++res) {
+    // If nothing is sensitive to the clock and there's nothing left to do,
+    // every iteration up until the one where the next delay control expires
+    // is a no-op. We can jump straight to it.
+    if (idle && !there_are_updates()) {
+      const auto skip = min(itr-res, next_timer()-now_-1);
+      res += skip;
+      now_ += skip;
+      if (skip % 2) {
+        bits.flip(0);
+      }
+      if (res == itr) {
+        if (id != nullptr) {
+          Evaluate().assign_value(id, 0, -1, -1, bits);
+        }
+        break;
+      }
+    }
+    bits.flip(0);
+    if ((id != nullptr) && Evaluate().assign_value(id, 0, -1, -1, bits)) {
+      notify(id, 0, -1, -1);
+    }
+    there_were_tasks_ = false;
+    drain_active();
+    while (there_are_updates()) {
+      latch();
+      drain_active();
+    }
+    tasks = there_were_tasks_ || interface()->pending_interrupt();
+    done_step();
+
+    // If nothing can observe the falling edge of the clock, it's folded into
+    // the same iteration as the rising edge. We don't bother notifying
+    // anyone, since the only events which are sensitive to the clock would
+    // ignore it anyway.
+    if (fold && bits.to_bool() && !tasks && (res+1 < itr)) {
+      bits.flip(0);
+      Evaluate().assign_value(id, 0, -1, -1, bits);
+      ++res;
+    }
+  }
+  return res;
+}
+
+bool SwLogic::has_readers(const Identifier* id) {
+  // Returns true if a continuous assign, an always @* block, or the runtime
+  // reads this variable
+  const auto f = get_state(id);
+  if (f == 0) {
+    return false;
+  }
+  const auto& fo = fanout_[f-1];
+  return !fo.assigns.empty() || !fo.slices.empty() || (fo.write != 0);
+}
+
+bool SwLogic::ignores(const Identifier* id) {
+  // Nothing is sensitive to a variable if nothing reads or waits on it
+  return !has_readers(id) && id->monitor_.empty();
+}
+
+uint64_t SwLogic::next_timer() const {
+  // Returns the time at which the next delay control expires, or the end of
+  // time if there aren't any. Occupied slots are visited in the order that
+  // the wheel will reach them. A slot which is k steps away can't hold
+  // anything earlier than now_+k, so the first slot which holds an entry
+  // that expires on this revolution holds the answer. Otherwise everything
+  // expires on a later revolution and we settle for the minimum.
+  uint64_t res = -1;
+  const auto n = wheel_.size();
+  const auto start = (now_ + 1) % n;
+  for (size_t k = 0; k < n; ) {
+    const auto idx = (start + k) % n;
+    const auto bits = occupied_[idx / 64] >> (idx % 64);
+    if (bits == 0) {
+      k += 64 - (idx % 64);
+      continue;
+    }
+    k += __builtin_ctzll(bits);
+    if (k >= n) {
+      break;
+    }
+    const auto at = now_ + 1 + k;
+    for (const auto& t : wheel_[(start + k) % n]) {
+      res = min(res, t.first);
+    }
+    if (res == at) {
+      break;
+    }
+    ++k;
+  }
+  return res;
+}
+
+void SwLogic::save_processes(State* s) {
+  // Look up the statements which are waiting on timers
+  unordered_map<const Node*, uint64_t> timers;
+  for (const auto& slot : wheel_) {
+    for (const auto& t : slot) {
+      timers[t.second->get_parent()] = t.first - now_;
+    }
+  }
+  if (timers.empty()) {
+    return;
+  }
+  // Record the control state of every process which contains one of them.
+  // The low order bit of a case statement's control state is the only one
+  // which changes at runtime.
+  uint32_t idx = 0;
+  for (auto mi : *src_->get_items()) {
+    const auto stmt = get_process(mi);
+    if (stmt == nullptr) {
+      continue;
+    }
+    State::Process p;
+    p.idx = idx++;
+    Preorder po(stmt);
+    for (size_t i = 0, ie = po.stmts_.size(); i < ie; ++i) {
+      const auto n = po.stmts_[i];
+      p.ctrl.push_back(dynamic_cast<const CaseStatement*>(n) ? (get_state(n) & 1) : get_state(n));
+      const auto itr = timers.find(n);
+      if (itr != timers.end()) {
+        p.timers.push_back(make_pair(i, itr->second));
+      }
+    }
+    if (!p.timers.empty()) {
+      s->insert_process(p);
+    }
+  }
+}
+
+void SwLogic::resume_processes(const State* s) {
+  for (const auto& p : s->get_processes()) {
+    // Find the process with this index
+    uint32_t idx = 0;
+    const ModuleItem* proc = nullptr;
+    for (auto mi : *src_->get_items()) {
+      if ((get_process(mi) != nullptr) && (idx++ == p.idx)) {
+        proc = mi;
+        break;
+      }
+    }
+    if (proc == nullptr) {
+      continue;
+    }
+    // Nothing to do if its structure has changed out from under us
+    Preorder po(get_process(proc));
+    if (po.stmts_.size() != p.ctrl.size()) {
+      continue;
+    }
+    auto valid = true;
+    for (const auto& t : p.timers) {
+      const auto tcs = dynamic_cast<const TimingControlStatement*>(po.stmts_[t.first]);
+      valid = valid && (tcs != nullptr) && (dynamic_cast<const DelayControl*>(tcs->get_ctrl()) != nullptr);
+    }
+    if (!valid) {
+      continue;
+    }
+    // Restore control state and put the timers back on the wheel
+    for (size_t i = 0, ie = po.stmts_.size(); i < ie; ++i) {
+      const auto n = po.stmts_[i];
+      auto& state = get_state(n);
+      state = dynamic_cast<const CaseStatement*>(n) ? ((state & ~size_t(1)) | p.ctrl[i]) : p.ctrl[i];
+    }
+    for (const auto& t : p.timers) {
+      const auto tcs = static_cast<const TimingControlStatement*>(po.stmts_[t.first]);
+      schedule_timer(now_ + t.second, static_cast<const DelayControl*>(tcs->get_ctrl()));
+    }
+    resumed_.push_back(proc);
+  }
+}
+
+const Statement* SwLogic::get_process(const ModuleItem* mi) {
+  if (auto ac = dynamic_cast<const AlwaysConstruct*>(mi)) {
+    return ac->get_stmt();
+  } else if (auto ic = dynamic_cast<const InitialConstruct*>(mi)) {
+    return ic->get_stmt();
+  } 
+  return nullptr;
+}
+
+bool SwLogic::posedge_only(const Identifier* id) {
+  // Delay controls can wake up processes which observe the falling edge
+  if (delays_) {
+    return false;
+  }
+  // As can continuous assigns or always @* blocks which read the clock
+  if (has_readers(id)) {
+    return false;
+  }
+  // Otherwise, the only thing that matters is that every event which is
+  // sensitive to the clock is a posedge event
+  for (auto m : id->monitor_) {
+    const auto e = dynamic_cast<const Event*>(m);
+    if ((e == nullptr) || (e->get_type() != Event::POSEDGE)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void SwLogic::latch() {
+  // This is a for loop. Updates happen simultaneously
+  for (size_t i = 0, ie = updates_.size(); i < ie; ++i) {
+    const auto& val = update_pool_[i];
+    const auto& u = updates_[i];
+    if (Evaluate().assign_value(get<0>(u), get<1>(u), get<2>(u), get<3>(u), val)) {
+      notify(get<0>(u), get<1>(u), get<2>(u), get<3>(u));
+    }
+  }
+  updates_.clear();
+  for (auto i : pending_) {
+    auto& s = shadows_[i];
+    s.pending = false;
+    if (Evaluate().swap_value(s.target, 0, s.next)) {
+      notify(s.target, 0, -1, -1);
+    }
+  }
+  pending_.clear();
+}
+
 void SwLogic::schedule_now(const Node* n) {
   n->accept(this);
 }
@@ -221,25 +519,503 @@ void SwLogic::notify(const Node* n) {
   }
 }
 
+void SwLogic::notify(const Identifier* id) {
+  notify(id, -1, -1, -1);
+}
+
+void SwLogic::notify(const Identifier* id, size_t idx, int msb, int lsb) {
+  notify(static_cast<const Node*>(id));
+  const auto f = get_state(id);
+  if (f == 0) {
+    return;
+  }
+  // Only wake up the readers whose slices overlap the bits which were written.
+  // An index of -1 means that every element was written. Writes past the end
+  // of a variable are clamped to its last bit, and slices which contain the
+  // last bit extend to infinity, so there's no need to clamp here.
+  const size_t m = (msb == -1) ? -1 : msb;
+  const size_t l = (msb == -1) ? 0 : lsb;
+  const auto& fo = fanout_[f-1];
+  if (fo.write != 0) {
+    flag_changed(f-1);
+  }
+  for (auto i : fo.assigns) {
+    mark(i);
+  }
+  for (const auto& s : fo.slices) {
+    if ((s.idx != idx) && (s.idx != size_t(-1)) && (idx != size_t(-1))) {
+      continue;
+    }
+    if ((s.lsb > m) || (l > s.msb)) {
+      continue;
+    }
+    if (s.node != nullptr) {
+      schedule_active(s.node);
+    } else {
+      mark(s.assign);
+    }
+  }
+}
+
+void SwLogic::drain_active() {
+  // This is a while loop. Active events can generate new active events. We
+  // settle continuous assigns before running anything else, so that the
+  // statements in the active queue observe stable values.
+  while (true) {
+    settle();
+    if (active_.empty()) {
+      break;
+    }
+    auto e = active_.back();
+    active_.pop_back();
+    const_cast<Node*>(e)->active_ = false;
+    schedule_now(e);
+  }
+}
+
+void SwLogic::settle() {
+  while (dirty_begin_ < dirty_.size()) {
+    const auto i = next_dirty();
+    if (i == size_t(-1)) {
+      break;
+    }
+    schedule_now(assigns_[i]);
+  }
+}
+
+void SwLogic::schedule_delay(const DelayControl* dc) {
+  // Zero delays resume in the current time step
+  const auto d = Evaluate().get_value(dc->get_delay()).to_int();
+  if (d == 0) {
+    notify(dc);
+    return;
+  }
+  schedule_timer(now_ + d, dc);
+}
+
+void SwLogic::schedule_timer(uint64_t t, const DelayControl* dc) {
+  const auto idx = t % wheel_.size();
+  wheel_[idx].push_back(make_pair(t, dc));
+  occupied_[idx / 64] |= (uint64_t(1) << (idx % 64));
+}
+
+void SwLogic::levelize() {
+  // Collect continuous assigns (and combinational always constructs if we're
+  // in levelized mode) along with the variables they read and write
+  vector<const Node*> nodes;
+  vector<vector<const Identifier*>> reads;
+  vector<vector<const Identifier*>> slices;
+  vector<vector<const Identifier*>> writes;
+  for (auto mi : *src_->get_items()) {
+    if (auto ca = dynamic_cast<const ContinuousAssign*>(mi)) {
+      const auto r = Resolve().get_resolution(ca->get_assign()->get_lhs());
+      assert(r != nullptr);
+      nodes.push_back(ca);
+      writes.push_back({r});
+      reads.resize(nodes.size());
+      slices.resize(nodes.size());
+      for (auto i : ReadSet(ca->get_assign()->get_rhs())) {
+        const auto ri = Resolve().get_resolution(i);
+        assert(ri != nullptr);
+        reads.back().push_back(ri);
+        slices.back().push_back(i);
+      }
+    } else if (auto ac = dynamic_cast<const AlwaysConstruct*>(mi)) {
+      vector<const Identifier*> ws;
+      if (!levelized_ || !is_comb(ac, ws)) {
+        continue;
+      }
+      nodes.push_back(ac);
+      writes.push_back(ws);
+      reads.resize(nodes.size());
+      slices.resize(nodes.size());
+      for (auto i : ReadSet(ac->get_stmt())) {
+        const auto ri = Resolve().get_resolution(i);
+        assert(ri != nullptr);
+        reads.back().push_back(ri);
+        slices.back().push_back(i);
+      }
+    }
+  }
+
+  vector<size_t> level;
+  while (true) {
+    // Build the graph of nodes which drive each other
+    unordered_map<const Identifier*, vector<size_t>> writers;
+    for (size_t i = 0, ie = nodes.size(); i < ie; ++i) {
+      for (auto w : writes[i]) {
+        writers[w].push_back(i);
+      }
+    }
+    vector<vector<size_t>> succs(nodes.size());
+    vector<size_t> preds(nodes.size(), 0);
+    for (size_t i = 0, ie = nodes.size(); i < ie; ++i) {
+      for (auto r : reads[i]) {
+        const auto itr = writers.find(r);
+        if (itr == writers.end()) {
+          continue;
+        }
+        for (auto j : itr->second) {
+          succs[j].push_back(i);
+          ++preds[i];
+        }
+      }
+    }
+    // Assign levels in topological order. Anything left over is either part
+    // of or downstream of a combinational loop and is placed after everything
+    // else.
+    level.assign(nodes.size(), 0);
+    vector<size_t> work;
+    for (size_t i = 0, ie = nodes.size(); i < ie; ++i) {
+      if (preds[i] == 0) {
+        work.push_back(i);
+      }
+    }
+    size_t max_level = 0;
+    while (!work.empty()) {
+      const auto i = work.back();
+      work.pop_back();
+      max_level = max(max_level, level[i]);
+      for (auto j : succs[i]) {
+        level[j] = max(level[j], level[i]+1);
+        if (--preds[j] == 0) {
+          work.push_back(j);
+        }
+      }
+    }
+    for (size_t i = 0, ie = nodes.size(); i < ie; ++i) {
+      if (preds[i] != 0) {
+        level[i] = max_level+1;
+      }
+    }
+
+    // Continuous assigns can iterate around a loop until it settles, but
+    // always constructs which lie on a loop (including one which reads a
+    // variable it writes) fall back on being scheduled by events. If there
+    // aren't any, we're done.
+    vector<bool> demote(nodes.size(), false);
+    bool any = false;
+    for (size_t i = 0, ie = nodes.size(); i < ie; ++i) {
+      if ((preds[i] == 0) || dynamic_cast<const ContinuousAssign*>(nodes[i])) {
+        continue;
+      }
+      vector<bool> seen(nodes.size(), false);
+      vector<size_t> stack = succs[i];
+      while (!stack.empty() && !demote[i]) {
+        const auto j = stack.back();
+        stack.pop_back();
+        if (j == i) {
+          demote[i] = true;
+        } else if (!seen[j]) {
+          seen[j] = true;
+          stack.insert(stack.end(), succs[j].begin(), succs[j].end());
+        }
+      }
+      any = any || demote[i];
+    }
+    if (!any) {
+      break;
+    }
+    size_t n = 0;
+    for (size_t i = 0, ie = nodes.size(); i < ie; ++i) {
+      if (!demote[i]) {
+        nodes[n] = nodes[i];
+        reads[n] = reads[i];
+        slices[n] = slices[i];
+        writes[n] = writes[i];
+        ++n;
+      }
+    }
+    nodes.resize(n);
+    reads.resize(n);
+    slices.resize(n);
+    writes.resize(n);
+  }
+
+  // Sort nodes by level and record which ones read each variable. Always
+  // constructs use their control state to record that they've been
+  // levelized.
+  vector<size_t> order(nodes.size());
+  for (size_t i = 0, ie = nodes.size(); i < ie; ++i) {
+    order[i] = i;
+  }
+  stable_sort(order.begin(), order.end(), [&level](size_t a, size_t b) {
+    return level[a] < level[b];
+  });
+  for (size_t i = 0, ie = order.size(); i < ie; ++i) {
+    const auto n = nodes[order[i]];
+    assigns_.push_back(n);
+    if (dynamic_cast<const AlwaysConstruct*>(n)) {
+      get_state(n) = 1;
+    }
+    for (auto r : slices[order[i]]) {
+      sensitize(r, nullptr, i);
+    }
+  }
+  dirty_.resize((assigns_.size()+63)/64, 0);
+  dirty_begin_ = dirty_.size();
+}
+
+void SwLogic::sensitize(const Identifier* i, const Node* n, size_t assign) {
+  const auto r = Resolve().get_resolution(i);
+  assert(r != nullptr);
+  Sensitivity s = {n, assign, size_t(-1), size_t(-1), 0};
+
+  // Subscripts which are all constant select a fixed slice of r. Anything
+  // else (including a reference to an entire array) depends on all of r.
+  auto constant = i->get_dim()->size() >= r->get_dim()->size();
+  for (auto d : *i->get_dim()) {
+    if (!constant) {
+      break;
+    }
+    if (auto re = dynamic_cast<const RangeExpression*>(d)) {
+      constant = Constant().is_constant(re->get_upper()) && Constant().is_constant(re->get_lower());
+    } else {
+      constant = Constant().is_constant(d);
+    }
+  }
+  if (constant) {
+    const auto dres = Evaluate().dereference(r, i);
+    s.idx = r->get_dim()->empty() ? size_t(-1) : get<0>(dres);
+    if (get<1>(dres) != -1) {
+      const auto w = Evaluate().get_width(r);
+      s.msb = ((size_t) get<1>(dres) >= w-1) ? size_t(-1) : get<1>(dres);
+      s.lsb = min((size_t) get<2>(dres), w-1);
+    }
+  }
+
+  // Implicit event controls which depend on all of r wait on it directly
+  auto& m = const_cast<Identifier*>(r)->monitor_;
+  const auto whole = (s.idx == size_t(-1)) && (s.msb == size_t(-1)) && (s.lsb == 0);
+  if (whole && (n != nullptr)) {
+    if (find(m.begin(), m.end(), n) == m.end()) {
+      m.push_back(n);
+    }
+    return;
+  }
+  if ((n != nullptr) && (find(m.begin(), m.end(), n) != m.end())) {
+    return;
+  }
+
+  auto& fo = fanout_[get_fanout(r)];
+  const auto dep = find(fo.assigns.begin(), fo.assigns.end(), assign) != fo.assigns.end();
+  if (whole) {
+    if (!dep) {
+      fo.assigns.push_back(assign);
+    }
+    return;
+  }
+  if ((n == nullptr) && dep) {
+    return;
+  }
+  // Don't bother recording slices which this reader already depends on
+  for (const auto& t : fo.slices) {
+    if ((t.node != n) || (t.assign != assign)) {
+      continue;
+    }
+    if (((t.idx == size_t(-1)) || (t.idx == s.idx)) && (t.msb >= s.msb) && (t.lsb <= s.lsb)) {
+      return;
+    }
+  }
+  fo.slices.push_back(s);
+}
+
+size_t SwLogic::get_fanout(const Identifier* r) {
+  auto& f = get_state(r);
+  if (f == 0) {
+    fanout_.push_back({{}, {}, 0, false});
+    f = fanout_.size();
+  }
+  return f-1;
+}
+
+void SwLogic::flag_changed(size_t f) {
+  auto& fo = fanout_[f];
+  if (!fo.changed) {
+    fo.changed = true;
+    changed_.push_back(f);
+  }
+}
+
+void SwLogic::flag_all_changed() {
+  for (const auto& w : writes_) {
+    flag_changed(get_state(w.first)-1);
+  }
+}
+
+void SwLogic::publish() {
+  if (changed_.empty()) {
+    return;
+  }
+  batch_.clear();
+  for (auto f : changed_) {
+    auto& fo = fanout_[f];
+    fo.changed = false;
+    const auto& w = writes_[fo.write-1];
+    batch_.push_back(make_pair(w.second, &Evaluate().get_value(w.first)));
+  }
+  changed_.clear();
+  interface()->write(batch_);
+}
+
+bool SwLogic::is_comb(const AlwaysConstruct* ac, vector<const Identifier*>& writes) const {
+  // Only always @* blocks are eligible
+  const auto tcs = dynamic_cast<const TimingControlStatement*>(ac->get_stmt());
+  if (tcs == nullptr) {
+    return false;
+  }
+  const auto ec = dynamic_cast<const EventControl*>(tcs->get_ctrl());
+  if ((ec == nullptr) || !ec->get_events()->empty()) {
+    return false;
+  }
+  return is_comb(tcs->get_stmt(), writes);
+}
+
+bool SwLogic::is_comb(const Statement* s, vector<const Identifier*>& writes) const {
+  // Everything other than blocking assigns and branches (including system
+  // tasks, whose output depends on event ordering) is ineligible.
+  if (auto ba = dynamic_cast<const BlockingAssign*>(s)) {
+    if (!ba->get_ctrl()->null()) {
+      return false;
+    }
+    const auto r = Resolve().get_resolution(ba->get_assign()->get_lhs());
+    assert(r != nullptr);
+    writes.push_back(r);
+    return true;
+  } 
+  if (auto sb = dynamic_cast<const SeqBlock*>(s)) {
+    for (auto st : *sb->get_stmts()) {
+      if (!is_comb(st, writes)) {
+        return false;
+      }
+    }
+    return true;
+  } 
+  if (auto cs = dynamic_cast<const CaseStatement*>(s)) {
+    for (auto ci : *cs->get_items()) {
+      if (!is_comb(ci->get_stmt(), writes)) {
+        return false;
+      }
+    }
+    return true;
+  }
+  if (auto cs = dynamic_cast<const ConditionalStatement*>(s)) {
+    return is_comb(cs->get_then(), writes) && is_comb(cs->get_else(), writes);
+  }
+  return false;
+}
+
+void SwLogic::mark(size_t i) {
+  const auto w = i / 64;
+  dirty_[w] |= (uint64_t(1) << (i % 64));
+  dirty_begin_ = min(dirty_begin_, w);
+}
+
+size_t SwLogic::next_dirty() {
+  for (const auto de = dirty_.size(); dirty_begin_ < de; ++dirty_begin_) {
+    auto& w = dirty_[dirty_begin_];
+    if (w != 0) {
+      const auto b = __builtin_ctzll(w);
+      w &= (w-1);
+      return 64*dirty_begin_ + b;
+    }
+  }
+  return -1;
+}
+
+bool SwLogic::find_direct(const Statement* s) {
+  // Flags compound statements which can be run directly, and detaches their
+  // children from the monitors which would otherwise resume them.
+  vector<const Statement*> children;
+  auto direct = true;
+  if (auto pb = dynamic_cast<const ParBlock*>(s)) {
+    children.insert(children.end(), pb->get_stmts()->begin(), pb->get_stmts()->end());
+  } else if (auto sb = dynamic_cast<const SeqBlock*>(s)) {
+    children.insert(children.end(), sb->get_stmts()->begin(), sb->get_stmts()->end());
+  } else if (auto cs = dynamic_cast<const CaseStatement*>(s)) {
+    for (auto ci : *cs->get_items()) {
+      children.push_back(ci->get_stmt());
+    }
+  } else if (auto cs = dynamic_cast<const ConditionalStatement*>(s)) {
+    children.push_back(cs->get_then());
+    children.push_back(cs->get_else());
+  } else if (auto fs = dynamic_cast<const ForStatement*>(s)) {
+    children.push_back(fs->get_stmt());
+  } else if (auto rs = dynamic_cast<const RepeatStatement*>(s)) {
+    children.push_back(rs->get_stmt());
+  } else if (auto ws = dynamic_cast<const WhileStatement*>(s)) {
+    children.push_back(ws->get_stmt());
+  } else if (auto tcs = dynamic_cast<const TimingControlStatement*>(s)) {
+    find_direct(tcs->get_stmt());
+    return false;
+  } else if (auto ws = dynamic_cast<const WaitStatement*>(s)) {
+    find_direct(ws->get_stmt());
+    return false;
+  } else if (auto ba = dynamic_cast<const BlockingAssign*>(s)) {
+    return ba->get_ctrl()->null();
+  } else if (auto na = dynamic_cast<const NonblockingAssign*>(s)) {
+    return na->get_ctrl()->null();
+  } else {
+    return dynamic_cast<const DisplayStatement*>(s) || 
+      dynamic_cast<const FinishStatement*>(s) || 
+      dynamic_cast<const WriteStatement*>(s);
+  }
+
+  for (auto c : children) {
+    direct = find_direct(c) && direct;
+  }
+  if (direct) {
+    const_cast<Statement*>(s)->direct_ = true;
+    for (auto c : children) {
+      const_cast<Statement*>(c)->monitor_.clear();
+    }
+  }
+  return direct;
+}
+
+void SwLogic::run(const Statement* s) {
+  Run r(this, true);
+  s->accept(&r);
+  notify(s);
+}
+
 size_t& SwLogic::get_state(const Node* n) {
   return const_cast<Node*>(n)->ctrl_;
 }
 
+Bytecode& SwLogic::get_bytecode(const VariableAssign* va) {
+  // Variable assigns don't have any control state of their own, so we use it
+  // to record where we've stored their compiled versions.
+  auto& idx = get_state(va);
+  if (idx == 0) {
+    bytecode_.emplace_back(va);
+    idx = bytecode_.size();
+  }
+  return bytecode_[idx-1];
+}
+
 void SwLogic::visit(const Event* e) {
   // TODO: Support for complex expressions here
   const auto id = dynamic_cast<const Identifier*>(e->get_expr());
   assert(id != nullptr);
   const auto r = Resolve().get_resolution(id);
 
-  if (e->get_type() != Event::NEGEDGE && Evaluate().get_value(r).to_bool()) {
+  const auto val = Evaluate().get_value(r).to_bool();
+  if (e->get_type() != Event::NEGEDGE && val) {
     notify(e);
-  } else if (e->get_type() != Event::POSEDGE && !Evaluate().get_value(r).to_bool()) {
+  } else if (e->get_type() != Event::POSEDGE && !val) {
     notify(e);
   }
 }
 
 void SwLogic::visit(const AlwaysConstruct* ac) {
-  schedule_now(ac->get_stmt());
+  // Levelized always constructs are run to completion when they're settled
+  if (get_state(ac) != 0) {
+    Run r(this, false);
+    static_cast<const TimingControlStatement*>(ac->get_stmt())->get_stmt()->accept(&r);
+  } else {
+    schedule_now(ac->get_stmt());
+  }
 }
 
 void SwLogic::visit(const InitialConstruct* ic) {
@@ -268,23 +1044,47 @@ void SwLogic::visit(const NonblockingAssign* na) {
   assert(na->get_ctrl()->null());
   
   if (!silent_) {
-    const auto r = Resolve().get_resolution(na->get_assign()->get_lhs());
-    assert(r != nullptr);
-    const auto target = Evaluate().dereference(r, na->get_assign()->get_lhs());
-    const auto& res = Evaluate().get_value(na->get_assign()->get_rhs());
+    auto& bc = get_bytecode(na->get_assign());
+    const auto target = bc.get_index();
+    const auto& res = bc.get_value();
+
+    // Nonblocking assigns use their control state to record the index of
+    // their target's shadow register, if it has one.
+    const auto sh = get_state(na);
+    if (sh != 0) {
+      auto& s = shadows_[sh-1];
+      if (get<1>(target) == -1) {
+        s.next.assign(res);
+        if (!s.pending) {
+          s.pending = true;
+          pending_.push_back(sh-1);
+        }
+        notify(na);
+        return;
+      } else if (s.pending) {
+        const auto w = s.next.size();
+        s.next.assign(min((size_t) get<1>(target), w-1), min((size_t) get<2>(target), w-1), res);
+        notify(na);
+        return;
+      }
+    }
 
     const auto idx = updates_.size();
     if (idx >= update_pool_.size()) {
       update_pool_.resize(2*update_pool_.size());
     } 
 
-    updates_.push_back(make_tuple(r, get<0>(target), get<1>(target), get<2>(target)));
+    updates_.push_back(make_tuple(bc.get_target(), get<0>(target), get<1>(target), get<2>(target)));
     update_pool_[idx] = res;
   }
   notify(na);
 }
 
 void SwLogic::visit(const ParBlock* pb) {
+  if (pb->direct_) {
+    run(pb);
+    return;
+  }
   auto& state = get_state(pb);
   switch (state) {
     case 0:
@@ -302,6 +1102,10 @@ void SwLogic::visit(const ParBlock* pb) {
 }
 
 void SwLogic::visit(const SeqBlock* sb) { 
+  if (sb->direct_) {
+    run(sb);
+    return;
+  }
   auto& state = get_state(sb);
   if (state < sb->get_stmts()->size()) {
     auto item = sb->get_stmts()->get(state++);
@@ -313,32 +1117,31 @@ void SwLogic::visit(const SeqBlock* sb) {
 }
 
 void SwLogic::visit(const CaseStatement* cs) {
+  if (cs->direct_) {
+    run(cs);
+    return;
+  }
+  // Case statements use the low order bit of their control state to record
+  // whether they're running, and the remaining bits to record the index of
+  // their table. If no item matches, there's nothing to run.
   auto& state = get_state(cs);
-  if (state == 0) {
-    state = 1;
-    const auto s = Evaluate().get_value(cs->get_cond()).to_int();
-    for (auto ci : *cs->get_items()) {
-      for (auto e : *ci->get_exprs()) {
-        const auto c = Evaluate().get_value(e).to_int();
-        if (s == c) {
-          schedule_now(ci->get_stmt());
-          return;
-        }
-      } 
-      if (ci->get_exprs()->empty()) {
-        schedule_now(ci->get_stmt());
-        return;
-      }
+  if ((state & 1) == 0) {
+    const auto s = select(cs);
+    if (s != nullptr) {
+      state |= 1;
+      schedule_now(s);
+      return;
     }
-    // Control should never reach here
-    assert(false);
-  } else {
-    state = 0;
-    notify(cs);
-  }
+  } 
+  state &= ~size_t(1);
+  notify(cs);
 }
 
 void SwLogic::visit(const ConditionalStatement* cs) {
+  if (cs->direct_) {
+    run(cs);
+    return;
+  }
   auto& state = get_state(cs);
   if (state == 0) {
     state = 1;
@@ -354,6 +1157,10 @@ void SwLogic::visit(const ConditionalStatement* cs) {
 }
 
 void SwLogic::visit(const ForStatement* fs) {
+  if (fs->direct_) {
+    run(fs);
+    return;
+  }
   auto& state = get_state(fs);
   switch (state) {
     case 0:
@@ -378,6 +1185,10 @@ void SwLogic::visit(const ForStatement* fs) {
 }
 
 void SwLogic::visit(const RepeatStatement* rs) {
+  if (rs->direct_) {
+    run(rs);
+    return;
+  }
   auto& state = get_state(rs);
   switch (state) {
     case 0:
@@ -394,6 +1205,10 @@ void SwLogic::visit(const RepeatStatement* rs) {
 }
 
 void SwLogic::visit(const WhileStatement* ws) {
+  if (ws->direct_) {
+    run(ws);
+    return;
+  }
   if (!Evaluate().get_value(ws->get_cond()).to_bool()) {
     notify(ws);
     return;
@@ -407,7 +1222,12 @@ void SwLogic::visit(const TimingControlStatement* tcs) {
   switch (state) {
     case 0:
       state = 1;
-      // Wait on control 
+      // Wait on control. Delay controls have to be scheduled.
+      if (delays_) {
+        if (auto dc = dynamic_cast<const DelayControl*>(tcs->get_ctrl())) {
+          schedule_delay(dc);
+        }
+      }
       break;
     case 1:
       state = 2;
@@ -459,7 +1279,8 @@ void SwLogic::visit(const WaitStatement* ws) {
 }
 
 void SwLogic::visit(const DelayControl* dc) {
-  // NOTE: Unsynthesizable verilog
+  // Delay controls are never scheduled directly. Their statements are woken
+  // up by the timing wheel (see schedule_delay()).
   assert(false);
   (void) dc;
 }
@@ -469,9 +1290,283 @@ void SwLogic::visit(const EventControl* ec) {
 }
 
 void SwLogic::visit(const VariableAssign* va) {
-  const auto& res = Evaluate().get_value(va->get_rhs());
-  Evaluate().assign_value(va->get_lhs(), res);
-  notify(Resolve().get_resolution(va->get_lhs()));
+  auto& bc = get_bytecode(va);
+  const auto r = bc.get_target();
+  const auto target = bc.get_index();
+  if (Evaluate().assign_value(r, get<0>(target), get<1>(target), get<2>(target), bc.get_value())) {
+    notify(r, get<0>(target), get<1>(target), get<2>(target));
+  }
+}
+
+const Statement* SwLogic::select(const CaseStatement* cs) {
+  const auto& ct = cases_[(get_state(cs) >> 1) - 1];
+  const auto& s = Evaluate().get_value(cs->get_cond());
+  const auto items = cs->get_items();
+
+  // Look up the first constant item which matches the selector
+  auto c = items->size();
+  if (!ct.wide) {
+    const auto k = key(s, ct.ext);
+    if (!ct.dense.empty()) {
+      c = (k < ct.dense.size()) ? ct.dense[k] : c;
+    } else {
+      const auto itr = ct.sparse.find(k);
+      c = (itr != ct.sparse.end()) ? itr->second : c;
+    }
+  }
+  // Any non-constant item which comes before it takes priority
+  for (auto d : ct.dynamic) {
+    if (d > c) {
+      break;
+    }
+    for (auto e : *items->get(d)->get_exprs()) {
+      if (Evaluate::case_equal(s, Evaluate().get_value(e), ct.ext)) {
+        return items->get(d)->get_stmt();
+      }
+    }
+  }
+  // Fall back on the default item if there was no match
+  if (c < items->size()) {
+    return items->get(c)->get_stmt();
+  } 
+  if (ct.def < items->size()) {
+    return items->get(ct.def)->get_stmt();
+  }
+  return nullptr;
+}
+
+uint64_t SwLogic::key(const Bits& b, const pair<size_t, bool>& ext) {
+  return uint64_t(Evaluate::get_case_word(b, 0, ext)) | (uint64_t(Evaluate::get_case_word(b, 1, ext)) << 32);
+}
+
+SwLogic::Lower::Lower(SwLogic* sw) : Visitor() {
+  sw_ = sw;
+}
+
+void SwLogic::Lower::visit(const CaseStatement* cs) {
+  Visitor::visit(cs);
+
+  SwLogic::CaseTable ct;
+  const auto items = cs->get_items();
+  ct.ext = Evaluate().get_case_extension(cs);
+  ct.def = items->size();
+  ct.wide = ct.ext.first > 64;
+
+  // Collect the keys of constant items, keeping only the first item for each
+  // key.
+  vector<pair<uint64_t, size_t>> keys;
+  unordered_map<uint64_t, size_t> seen;
+  for (size_t i = 0, ie = items->size(); i < ie; ++i) {
+    const auto ci = items->get(i);
+    if (ci->get_exprs()->empty()) {
+      ct.def = min(ct.def, i);
+      continue;
+    }
+    auto dynamic = ct.wide;
+    for (auto e : *ci->get_exprs()) {
+      dynamic = dynamic || !Constant().is_constant(e);
+    }
+    if (dynamic) {
+      ct.dynamic.push_back(i);
+      continue;
+    }
+    for (auto e : *ci->get_exprs()) {
+      const auto k = key(Evaluate().get_value(e), ct.ext);
+      if (seen.insert(make_pair(k, i)).second) {
+        keys.push_back(make_pair(k, i));
+      }
+    }
+  }
+
+  // Use a dense table if the keys are small enough, a hash table otherwise 
+  uint64_t max_key = 0;
+  for (const auto& k : keys) {
+    max_key = max(max_key, k.first);
+  }
+  if (!keys.empty() && (max_key < 4*keys.size() + 64)) {
+    ct.dense.resize(max_key+1, items->size());
+    for (const auto& k : keys) {
+      ct.dense[k.first] = k.second;
+    }
+  } else {
+    ct.sparse.insert(keys.begin(), keys.end());
+  }
+
+  sw_->cases_.push_back(ct);
+  sw_->get_state(cs) = sw_->cases_.size() << 1;
+}
+
+void SwLogic::Lower::visit(const DelayControl* dc) {
+  (void) dc;
+  sw_->delays_ = true;
+}
+
+void SwLogic::Lower::visit(const EventControl* ec) {
+  // Implicit event controls are wired up once we know which always
+  // constructs have been levelized
+  if (ec->get_events()->empty()) {
+    implicit_.push_back(ec);
+  }
+  Visitor::visit(ec);
+}
+
+void SwLogic::Lower::visit(const NonblockingAssign* na) {
+  // Compile the assignment and allocate a shadow register for its target,
+  // unless it's an array
+  auto& bc = sw_->get_bytecode(na->get_assign());
+  const auto r = bc.get_target();
+  if (!r->get_dim()->empty()) {
+    return;
+  }
+  auto itr = shadows_.find(r);
+  if (itr == shadows_.end()) {
+    sw_->shadows_.push_back({r, Evaluate().get_value(r), false});
+    itr = shadows_.insert(make_pair(r, sw_->shadows_.size())).first;
+  }
+  sw_->get_state(na) = itr->second;
+}
+
+void SwLogic::Lower::visit(const VariableAssign* va) {
+  sw_->get_bytecode(va);
+}
+
+SwLogic::Preorder::Preorder(const Statement* s) : Visitor() {
+  s->accept(this);
+}
+
+void SwLogic::Preorder::visit(const ParBlock* pb) {
+  stmts_.push_back(pb);
+  Visitor::visit(pb);
+}
+
+void SwLogic::Preorder::visit(const SeqBlock* sb) {
+  stmts_.push_back(sb);
+  Visitor::visit(sb);
+}
+
+void SwLogic::Preorder::visit(const CaseStatement* cs) {
+  stmts_.push_back(cs);
+  Visitor::visit(cs);
+}
+
+void SwLogic::Preorder::visit(const ConditionalStatement* cs) {
+  stmts_.push_back(cs);
+  Visitor::visit(cs);
+}
+
+void SwLogic::Preorder::visit(const ForStatement* fs) {
+  stmts_.push_back(fs);
+  Visitor::visit(fs);
+}
+
+void SwLogic::Preorder::visit(const RepeatStatement* rs) {
+  stmts_.push_back(rs);
+  Visitor::visit(rs);
+}
+
+void SwLogic::Preorder::visit(const TimingControlStatement* tcs) {
+  stmts_.push_back(tcs);
+  Visitor::visit(tcs);
+}
+
+void SwLogic::Preorder::visit(const WaitStatement* ws) {
+  stmts_.push_back(ws);
+  Visitor::visit(ws);
+}
+
+SwLogic::Run::Run(SwLogic* sw, bool settle) : Visitor() {
+  sw_ = sw;
+  settle_ = settle;
+}
+
+void SwLogic::Run::visit(const BlockingAssign* ba) {
+  step();
+  sw_->schedule_now(ba->get_assign());
+}
+
+void SwLogic::Run::visit(const NonblockingAssign* na) {
+  step();
+  sw_->schedule_now(na);
+}
+
+void SwLogic::Run::visit(const ParBlock* pb) {
+  for (auto s : *pb->get_stmts()) {
+    s->accept(this);
+  }
+}
+
+void SwLogic::Run::visit(const SeqBlock* sb) {
+  for (auto s : *sb->get_stmts()) {
+    s->accept(this);
+  }
+}
+
+void SwLogic::Run::visit(const CaseStatement* cs) {
+  step();
+  if (auto s = sw_->select(cs)) {
+    s->accept(this);
+  }
+}
+
+void SwLogic::Run::visit(const ConditionalStatement* cs) {
+  step();
+  if (Evaluate().get_value(cs->get_if()).to_bool()) {
+    cs->get_then()->accept(this);
+  } else {
+    cs->get_else()->accept(this);
+  }
+}
+
+void SwLogic::Run::visit(const ForStatement* fs) {
+  step();
+  sw_->schedule_now(fs->get_init());
+  while (true) {
+    step();
+    if (!Evaluate().get_value(fs->get_cond()).to_bool()) {
+      break;
+    }
+    fs->get_stmt()->accept(this);
+    step();
+    sw_->schedule_now(fs->get_update());
+  }
+}
+
+void SwLogic::Run::visit(const RepeatStatement* rs) {
+  step();
+  for (auto i = Evaluate().get_value(rs->get_cond()).to_int(); i > 0; --i) {
+    rs->get_stmt()->accept(this);
+  }
+}
+
+void SwLogic::Run::visit(const WhileStatement* ws) {
+  while (true) {
+    step();
+    if (!Evaluate().get_value(ws->get_cond()).to_bool()) {
+      break;
+    }
+    ws->get_stmt()->accept(this);
+  }
+}
+
+void SwLogic::Run::visit(const DisplayStatement* ds) {
+  step();
+  sw_->schedule_now(ds);
+}
+
+void SwLogic::Run::visit(const FinishStatement* fs) {
+  step();
+  sw_->schedule_now(fs);
+}
+
+void SwLogic::Run::visit(const WriteStatement* ws) {
+  step();
+  sw_->schedule_now(ws);
+}
+
+void SwLogic::Run::step() {
+  if (settle_) {
+    sw_->settle();
+  }
 }
 
 void SwLogic::log(const string& op, const Node* n) {
@@ -31,6 +31,7 @@
 #ifndef CASCADE_SRC_TARGET_CORE_SW_SW_LOGIC_H
 #define CASCADE_SRC_TARGET_CORE_SW_SW_LOGIC_H
 
+#include <cstdint>
 #include <string>
 #include <tuple>
 #include <unordered_map>
@@ -39,13 +40,14 @@
 #include "src/target/core.h"
 #include "src/target/input.h"
 #include "src/target/state.h"
+#include "src/verilog/analyze/bytecode.h"
 #include "src/verilog/ast/visitors/visitor.h"
 
 namespace cascade {
 
 class SwLogic : public Logic, public Visitor {
   public:
-    SwLogic(Interface* interface, ModuleDeclaration* md);
+    SwLogic(Interface* interface, ModuleDeclaration* md, bool levelized);
     ~SwLogic() override;
 
     // Configuration Logic:
@@ -59,6 +61,10 @@ class SwLogic : public Logic, public Visitor {
     Input* get_input() override;
     void set_input(const Input* i) override;
     void resync() override; 
+    bool is_thread_safe() const override;
+
+    bool overrides_done_step() const override;
+    void done_step() override;
 
     void read(VId vid, const Bits* b) override;
     void evaluate() override;
@@ -66,13 +72,25 @@ class SwLogic : public Logic, public Visitor {
     void update() override;
     bool there_were_tasks() const override;
 
+    size_t open_loop(VId clk, bool val, size_t itr) override;
+
   private:
     // Source Management:
     ModuleDeclaration* src_;
+    bool levelized_;
     std::vector<const Identifier*> reads_;
     std::vector<std::pair<const Identifier*, VId>> writes_;
     std::unordered_map<VId, const Identifier*> state_;
 
+    // Output Publishing:
+    //
+    // Only outputs which have changed since the last time they were written
+    // back to the runtime are published at the end of evaluate() and update().
+    // Outputs use their entry in the sensitivity table (see below) to record
+    // their index in writes_ and whether they have already been flagged.
+    std::vector<size_t> changed_;
+    std::vector<std::pair<VId, const Bits*>> batch_;
+
     // Control State:
     bool silent_;
     bool there_were_tasks_;
@@ -80,13 +98,154 @@ class SwLogic : public Logic, public Visitor {
     std::vector<std::tuple<const Identifier*,size_t,int,int>> updates_;
     std::vector<Bits> update_pool_;
 
+    // Shadow Registers:
+    //
+    // Nonblocking assigns to scalar variables write into a next-state buffer
+    // rather than the update queue. A whole-register write starts a pending
+    // update, and any further writes in the same cycle modify the buffer in
+    // place. Partial writes which come before a whole-register write are
+    // queued as usual. Pending buffers are swapped into place after the
+    // queue is drained.
+    struct Shadow {
+      const Identifier* target;
+      Bits next;
+      bool pending;
+    };
+    std::vector<Shadow> shadows_;
+    std::vector<size_t> pending_;
+
+    // Timing Wheel:
+    //
+    // Delay controls are scheduled on a hashed timing wheel which advances by
+    // one slot at the end of every time step. Each slot holds the delay
+    // controls which expire at a time congruent to its index, and entries
+    // which expire on a later revolution are left in place. A bitmap records
+    // which slots are non-empty so that finding the next timer only touches
+    // occupied slots. Modules without delay controls don't ask to be notified
+    // of time steps at all.
+    bool delays_;
+    uint64_t now_;
+    std::vector<std::vector<std::pair<uint64_t, const DelayControl*>>> wheel_;
+    std::vector<uint64_t> occupied_;
+    // Processes which were waiting on a delay when the engine that this one
+    // replaced handed them off (see set_state()). These are already running,
+    // so resync() doesn't start them over.
+    std::vector<const Node*> resumed_;
+
+    // Case Statements:
+    //
+    // Case statements are compiled into tables on construction. Items whose
+    // expressions are all constant are entered into a dense jump table, or a
+    // hash table if their values are sparse, keyed on the first item which
+    // they match. Only the remaining items are evaluated when the statement
+    // is run, and only if they come before the item found in the table.
+    // Keys are taken after extending items to the width and sign that they're
+    // compared at (see Evaluate::get_case_extension()). Statements which are
+    // compared at more than 64 bits evaluate every item.
+    struct CaseTable {
+      std::vector<size_t> dense;
+      std::unordered_map<uint64_t, size_t> sparse;
+      std::vector<size_t> dynamic;
+      std::pair<size_t, bool> ext;
+      size_t def;
+      bool wide;
+    };
+    std::vector<CaseTable> cases_;
+
+    // Compiled Expressions:
+    std::vector<Bytecode> bytecode_;
+
+    // Continuous Assigns:
+    //
+    // Continuous assigns are scheduled separately from everything else. They
+    // are sorted by level, so that each one comes after the assigns which
+    // drive its inputs, and a bitset records which ones need to be
+    // re-evaluated. Settling them in order evaluates each one at most once
+    // per pass, barring combinational loops. In levelized mode, always @*
+    // blocks which contain only blocking assigns and branches are scheduled
+    // the same way, unless they're part of a combinational loop.
+    std::vector<const Node*> assigns_;
+    std::vector<uint64_t> dirty_;
+    size_t dirty_begin_;
+
+    // Sensitivities:
+    //
+    // Continuous assigns and always @* blocks are only woken up by changes to
+    // the parts of a variable which they read. Reads with constant subscripts
+    // are recorded as an array element and bit range, and anything else
+    // depends on the entire variable. Identifiers use their control state to
+    // record the index of their readers in this table. Readers are either
+    // continuous assigns (and levelized always constructs), which are marked
+    // dirty, or implicit event controls, which are notified. Readers which
+    // depend on an entire variable are kept apart from the ones which read
+    // slices, and implicit event controls of this sort simply wait on the
+    // variable.
+    struct Sensitivity {
+      const Node* node;
+      size_t assign;
+      size_t idx;
+      size_t msb;
+      size_t lsb;
+    };
+    struct Fanout {
+      std::vector<size_t> assigns;
+      std::vector<Sensitivity> slices;
+      size_t write;
+      bool changed;
+    };
+    std::vector<Fanout> fanout_;
+
     // Scheduling: 
     void schedule_now(const Node* n);
     void schedule_active(const Node* n);
     void notify(const Node* n);
+    void notify(const Identifier* id);
+    void notify(const Identifier* id, size_t idx, int msb, int lsb);
+    void drain_active();
+    void settle();
+    void latch();
+    bool posedge_only(const Identifier* id);
+    bool has_readers(const Identifier* id);
+    bool ignores(const Identifier* id);
+    uint64_t next_timer() const;
+    void schedule_delay(const DelayControl* dc);
+    void schedule_timer(uint64_t t, const DelayControl* dc);
+    void save_processes(State* s);
+    void resume_processes(const State* s);
+    static const Statement* get_process(const ModuleItem* mi);
+
+    // Continuous Assigns:
+    void levelize();
+    bool is_comb(const AlwaysConstruct* ac, std::vector<const Identifier*>& writes) const;
+    bool is_comb(const Statement* s, std::vector<const Identifier*>& writes) const;
+    void mark(size_t i);
+    size_t next_dirty();
+
+    // Sensitivities:
+    void sensitize(const Identifier* i, const Node* n, size_t assign);
+    size_t get_fanout(const Identifier* r);
+
+    // Output Publishing:
+    void flag_changed(size_t f);
+    void flag_all_changed();
+    void publish();
+
+    // Direct Execution:
+    //
+    // Statements which contain no timing controls or waits can't suspend,
+    // and are run to completion as straight-line code rather than as state
+    // machines. Only the outermost statement in such a subtree notifies its
+    // parent when it finishes.
+    bool find_direct(const Statement* s);
+    void run(const Statement* s);
 
     // Control State:
     size_t& get_state(const Node* n);
+    // Compiled Expressions:
+    Bytecode& get_bytecode(const VariableAssign* va);
+    // Case Statements:
+    const Statement* select(const CaseStatement* cs);
+    static uint64_t key(const Bits& b, const std::pair<size_t, bool>& ext);
 
     // Visitor Interface:
     void visit(const Event* e) override;
@@ -113,6 +272,58 @@ class SwLogic : public Logic, public Visitor {
 
     // Debug Printing:
     void log(const std::string& op, const Node* n);
+
+    // Compiles the variable assignments in a subtree
+    struct Lower : public Visitor {
+      explicit Lower(SwLogic* sw);
+      ~Lower() override = default;
+      void visit(const CaseStatement* cs) override;
+      void visit(const DelayControl* dc) override;
+      void visit(const EventControl* ec) override;
+      void visit(const NonblockingAssign* na) override;
+      void visit(const VariableAssign* va) override;
+      SwLogic* sw_;
+      std::unordered_map<const Identifier*, size_t> shadows_;
+      std::vector<const EventControl*> implicit_;
+    };
+
+    // Lists the statements in a process which have control state of their
+    // own, in preorder
+    struct Preorder : public Visitor {
+      explicit Preorder(const Statement* s);
+      ~Preorder() override = default;
+      void visit(const ParBlock* pb) override;
+      void visit(const SeqBlock* sb) override;
+      void visit(const CaseStatement* cs) override;
+      void visit(const ConditionalStatement* cs) override;
+      void visit(const ForStatement* fs) override;
+      void visit(const RepeatStatement* rs) override;
+      void visit(const TimingControlStatement* tcs) override;
+      void visit(const WaitStatement* ws) override;
+      std::vector<const Statement*> stmts_;
+    };
+
+    // Runs a statement to completion. Continuous assigns are settled before
+    // each step, unless this is the body of a levelized always construct.
+    struct Run : public Visitor {
+      Run(SwLogic* sw, bool settle);
+      ~Run() override = default;
+      void visit(const BlockingAssign* ba) override;
+      void visit(const NonblockingAssign* na) override;
+      void visit(const ParBlock* pb) override;
+      void visit(const SeqBlock* sb) override;
+      void visit(const CaseStatement* cs) override;
+      void visit(const ConditionalStatement* cs) override;
+      void visit(const ForStatement* fs) override;
+      void visit(const RepeatStatement* rs) override;
+      void visit(const WhileStatement* ws) override;
+      void visit(const DisplayStatement* ds) override;
+      void visit(const FinishStatement* fs) override;
+      void visit(const WriteStatement* ws) override;
+      void step();
+      SwLogic* sw_;
+      bool settle_;
+    };
 };
 
 } // namespace cascade
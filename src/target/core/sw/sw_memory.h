@@ -60,6 +60,7 @@ class SwMemory : public Memory {
     void set_state(const State* s) override;
     Input* get_input() override;
     void set_input(const Input* i) override;
+    bool is_thread_safe() const override;
 
     bool overrides_done_simulation() const override;
     void done_simulation() override;
@@ -218,6 +219,10 @@ inline void SwMemory::set_input(const Input* i) {
   wdata_ = i->find(wdata_id_)->second;
 }
 
+inline bool SwMemory::is_thread_safe() const {
+  return true;
+}
+
 inline bool SwMemory::overrides_done_simulation() const {
   return true;
 }
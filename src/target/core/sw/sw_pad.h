@@ -47,6 +47,7 @@ class SwPad : public Pad {
     void set_state(const State* s) override;
     Input* get_input() override;
     void set_input(const Input* i) override;
+    bool is_thread_safe() const override;
 
     bool overrides_done_step() const override;
     void done_step() override;
@@ -95,6 +96,10 @@ inline void SwPad::set_input(const Input* i) {
   (void) i;
 }
 
+inline bool SwPad::is_thread_safe() const {
+  return true;
+}
+
 inline bool SwPad::overrides_done_step() const {
   return true;
 }
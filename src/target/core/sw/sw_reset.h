@@ -47,6 +47,7 @@ class SwReset : public Reset {
     void set_state(const State* s) override;
     Input* get_input() override;
     void set_input(const Input* i) override;
+    bool is_thread_safe() const override;
 
     bool overrides_done_step() const override;
     void done_step() override;
@@ -92,6 +93,10 @@ inline void SwReset::set_input(const Input* i) {
   (void) i;
 }
 
+inline bool SwReset::is_thread_safe() const {
+  return true;
+}
+
 inline bool SwReset::overrides_done_step() const {
   return true;
 }
@@ -32,6 +32,7 @@
 #define CASCADE_SRC_TARGET_ENGINE_H
 
 #include <cassert>
+#include "src/base/container/worklist.h"
 #include "src/runtime/ids.h"
 #include "src/target/core/stub/stub_core.h"
 #include "src/target/core/sw/sw_clock.h"
@@ -53,6 +54,7 @@ class Engine {
     bool is_clock() const;
     bool is_logic() const;
     bool is_stub() const;
+    bool is_thread_safe() const;
 
     // Scheduling Interface:
     bool overrides_done_step() const;
@@ -90,23 +92,40 @@ class Engine {
     // Compiler Interface:
     void replace_with(Engine* e);
 
+    // Worklist Interface:
+    // 
+    // Attaches this engine to a pair of worklists where it is identified by
+    // idx. From then on, the engine marks itself in reads whenever it is sent
+    // a value, and in updates whenever it does something that might result
+    // in an update. Passing nullptr for both detaches it.
+    void set_worklists(Worklist* reads, Worklist* updates, size_t idx);
+
   private:
     Core* core_;
     Interface* interface_;
 
     bool there_are_reads_;
+
+    Worklist* reads_;
+    Worklist* updates_;
+    size_t idx_;
+
+    void mark_reads();
+    void mark_updates();
 };
 
 inline Engine::Engine() {
   interface_ = new StubInterface();
   core_ = new StubCore(interface_);
   there_are_reads_ = false;
+  set_worklists(nullptr, nullptr, 0);
 }
 
 inline Engine::Engine(Core* core, Interface* interface) {
   core_ = core;
   interface_ = interface;
   there_are_reads_ = false;
+  set_worklists(nullptr, nullptr, 0);
 }
 
 inline Engine::~Engine() {
@@ -130,12 +149,17 @@ inline bool Engine::is_stub() const {
   return dynamic_cast<StubCore*>(core_) != nullptr;
 }
 
+inline bool Engine::is_thread_safe() const {
+  return core_->is_thread_safe();
+}
+
 inline bool Engine::overrides_done_step() const {
   return core_->overrides_done_step();
 }
 
 inline void Engine::done_step() {
   core_->done_step();
+  mark_updates();
 }
 
 inline bool Engine::overrides_done_simulation() const {
@@ -153,6 +177,7 @@ inline bool Engine::there_are_reads() const {
 inline void Engine::evaluate() {
   core_->evaluate();
   there_are_reads_ = false;
+  mark_updates();
 }
 
 inline bool Engine::there_are_updates() const {
@@ -162,6 +187,7 @@ inline bool Engine::there_are_updates() const {
 inline void Engine::update() {
   core_->update();
   there_are_reads_ = false;
+  mark_updates();
 }
 
 inline bool Engine::there_were_tasks() const {
@@ -189,6 +215,8 @@ inline size_t Engine::open_loop(VId clk, bool val, size_t itr) {
 inline void Engine::read(VId id, const Bits* b) {
   core_->read(id, b);
   there_are_reads_ = true;
+  mark_reads();
+  mark_updates();
 }
 
 inline State* Engine::get_state() {
@@ -197,6 +225,7 @@ inline State* Engine::get_state() {
 
 inline void Engine::set_state(const State* s) {
   core_->set_state(s);
+  mark_updates();
 }
 
 inline Input* Engine::get_input() {
@@ -205,10 +234,12 @@ inline Input* Engine::get_input() {
 
 inline void Engine::set_input(const Input* i) {
   core_->set_input(i);
+  mark_updates();
 }
 
 inline void Engine::resync() {
   core_->resync();
+  mark_updates();
 }
 
 inline bool Engine::get_bit(VId id) {
@@ -250,6 +281,29 @@ inline void Engine::replace_with(Engine* e) {
 
   there_are_reads_ = e->there_are_reads_;
   delete e;
+
+  if (there_are_reads_) {
+    mark_reads();
+  }
+  mark_updates();
+}
+
+inline void Engine::set_worklists(Worklist* reads, Worklist* updates, size_t idx) {
+  reads_ = reads;
+  updates_ = updates;
+  idx_ = idx;
+}
+
+inline void Engine::mark_reads() {
+  if (reads_ != nullptr) {
+    reads_->mark(idx_);
+  }
+}
+
+inline void Engine::mark_updates() {
+  if (updates_ != nullptr) {
+    updates_->mark(idx_);
+  }
 }
 
 } // namespace cascade
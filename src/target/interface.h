@@ -32,6 +32,8 @@
 #define CASCADE_SRC_TARGET_INTERFACE_H
 
 #include <string>
+#include <utility>
+#include <vector>
 #include "src/base/bits/bits.h"
 #include "src/runtime/ids.h"
 
@@ -63,6 +65,15 @@ class Interface {
     // performance-specific advantage to doing so. This method may be invoked
     // whenever a write of a single-bit variable is required.
     virtual void write(VId id, bool b);
+    // Target-specific implementations may override this method if there is a
+    // performance-specific advantage to doing so. This method may be invoked
+    // whenever the values of several logic elements are written at once.
+    virtual void write(const std::vector<std::pair<VId, const Bits*>>& ws);
+
+    // Target-specific implementations may override this method if they can
+    // cheaply determine whether the runtime has an interrupt waiting to be
+    // handled. Cores running in open loop may use it to return control early.
+    virtual bool pending_interrupt();
 
   private:
     Bits temp_;
@@ -75,6 +86,16 @@ inline void Interface::write(VId id, bool b) {
   write(id, &temp_);
 }
 
+inline void Interface::write(const std::vector<std::pair<VId, const Bits*>>& ws) {
+  for (const auto& w : ws) {
+    write(w.first, w.second);
+  }
+}
+
+inline bool Interface::pending_interrupt() {
+  return false;
+}
+
 } // namespace cascade
 
 #endif
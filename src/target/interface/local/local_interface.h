@@ -52,6 +52,9 @@ class LocalInterface : public Interface {
 
     void write(VId id, const Bits* b) override;
     void write(VId id, bool b) override;
+    void write(const std::vector<std::pair<VId, const Bits*>>& ws) override;
+
+    bool pending_interrupt() override;
 
   private:
     Runtime* rt_;
@@ -97,6 +100,16 @@ inline void LocalInterface::write(VId id, bool b) {
   rt_->write(id, b);
 }
 
+inline void LocalInterface::write(const std::vector<std::pair<VId, const Bits*>>& ws) {
+  for (const auto& w : ws) {
+    rt_->write(w.first, w.second);
+  }
+}
+
+inline bool LocalInterface::pending_interrupt() {
+  return rt_->pending_interrupt();
+}
+
 } // namespace cascade
 
 #endif
@@ -36,6 +36,7 @@ namespace cascade {
 
 size_t State::deserialize(istream& is) {
   state_.clear();
+  procs_.clear();
 
   // How many elements are in this state?
   uint32_t n = 0;
@@ -58,6 +59,33 @@ size_t State::deserialize(istream& is) {
       state_[id].push_back(bits);
     }
   }
+
+  // How many suspended processes are there?
+  uint32_t np = 0;
+  is.read((char*)&np, 4);
+  res += 4;
+
+  // Read that many processes
+  procs_.resize(np);
+  for (auto& p : procs_) {
+    uint32_t nc = 0;
+    uint32_t nt = 0;
+    is.read((char*)&p.idx, 4);
+    is.read((char*)&nc, 4);
+    is.read((char*)&nt, 4);
+    res += 12;
+    p.ctrl.resize(nc);
+    for (auto& c : p.ctrl) {
+      is.read((char*)&c, 8);
+      res += 8;
+    }
+    p.timers.resize(nt);
+    for (auto& t : p.timers) {
+      is.read((char*)&t.first, 4);
+      is.read((char*)&t.second, 8);
+      res += 12;
+    }
+  }
   return res;
 }
 
@@ -80,6 +108,30 @@ size_t State::serialize(ostream& os) const {
       res += b.serialize(os);
     }
   }
+
+  // How many suspended processes are there?
+  const uint32_t np = procs_.size();
+  os.write((char*)&np, 4);
+  res += 4;
+
+  // Write that many processes
+  for (const auto& p : procs_) {
+    const uint32_t nc = p.ctrl.size();
+    const uint32_t nt = p.timers.size();
+    os.write((char*)&p.idx, 4);
+    os.write((char*)&nc, 4);
+    os.write((char*)&nt, 4);
+    res += 12;
+    for (const auto& c : p.ctrl) {
+      os.write((char*)&c, 8);
+      res += 8;
+    }
+    for (const auto& t : p.timers) {
+      os.write((char*)&t.first, 4);
+      os.write((char*)&t.second, 8);
+      res += 12;
+    }
+  }
   return res;
 }
 
@@ -31,7 +31,9 @@
 #ifndef CASCADE_SRC_TARGET_CORE_STATE_H
 #define CASCADE_SRC_TARGET_CORE_STATE_H
 
+#include <stdint.h>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 #include "src/base/bits/bits.h"
 #include "src/base/serial/serializable.h"
@@ -47,6 +49,18 @@ class State : public Serializable {
   public:
     typedef std::unordered_map<VId, std::vector<Bits>>::const_iterator const_iterator;
 
+    // Suspended processes: Cores which support delay controls record the
+    // processes which are waiting on a delay, so that the core which replaces
+    // them can resume them. A process is identified by the index of its
+    // initial or always construct, and its statements by their index in a
+    // preorder walk of that construct. Timers record how many time steps are
+    // left before the statement they belong to resumes.
+    struct Process {
+      uint32_t idx;
+      std::vector<uint64_t> ctrl;
+      std::vector<std::pair<uint32_t, uint64_t>> timers;
+    };
+
     State() = default;
     ~State() override = default;
 
@@ -57,11 +71,15 @@ class State : public Serializable {
     const_iterator begin() const;
     const_iterator end() const;
 
+    void insert_process(const Process& p);
+    const std::vector<Process>& get_processes() const;
+
     size_t deserialize(std::istream& is) override;
     size_t serialize(std::ostream& os) const override;
 
   private:
     std::unordered_map<VId, std::vector<Bits>> state_; 
+    std::vector<Process> procs_;
 };
 
 inline void State::insert(VId id, const Bits& b) {
@@ -86,6 +104,14 @@ inline State::const_iterator State::end() const {
   return state_.end();
 }
 
+inline void State::insert_process(const Process& p) {
+  procs_.push_back(p);
+}
+
+inline const std::vector<State::Process>& State::get_processes() const {
+  return procs_;
+}
+
 } // namespace cascade
 
 #endif
@@ -0,0 +1,548 @@
+// Copyright 2017-2018 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "src/verilog/analyze/bytecode.h"
+
+#include <algorithm>
+#include <cassert>
+#include <tuple>
+#include "src/verilog/analyze/constant.h"
+#include "src/verilog/analyze/evaluate.h"
+#include "src/verilog/analyze/resolve.h"
+
+using namespace std;
+
+namespace cascade {
+
+Bytecode::Bytecode(const Expression* e) : Visitor() {
+  // Make sure bits, sizes, and signs have been allocated for this subtree
+  root_ = e;
+  Evaluate().get_width(e);
+  res_ = compile(e);
+
+  split_ = code_.size();
+  target_ = -1;
+}
+
+Bytecode::Bytecode(const VariableAssign* va) : Visitor() {
+  // Make sure bits, sizes, and signs have been allocated for this subtree
+  root_ = va->get_rhs();
+  Evaluate().get_width(root_);
+  const auto res = compile(root_);
+
+  // Subscripts on the left-hand side are evaluated separately 
+  split_ = code_.size();
+  target_ = lower(va->get_lhs());
+  res_ = res;
+}
+
+const Bits* Bytecode::compile(const Expression* e) {
+  e->accept(this);
+  return res_;
+}
+
+size_t Bytecode::lower(const Identifier* id) {
+  const auto r = Resolve().get_resolution(id);
+  assert(r != nullptr);
+  Evaluate().get_width(r);
+
+  Slot s;
+  s.r = r;
+  s.base = 0;
+  s.range = NONE;
+  s.msb = -1;
+  s.lsb = -1;
+  s.upper = nullptr;
+  s.lower = nullptr;
+
+  // Walk along array subscripts, folding constants into the base index. This
+  // mirrors the arithmetic in Evaluate::dereference(). Subscripts can contain
+  // array references of their own, so we hold off on recording them in subs_
+  // until we're done compiling.
+  vector<pair<const Bits*, size_t>> subs;
+  auto iitr = id->get_dim()->begin();
+  const auto iend = id->get_dim()->end();
+  size_t mul = r->bit_val_.size();
+  for (auto ritr = r->get_dim()->begin(), rend = r->get_dim()->end(); ritr != rend; ++ritr, ++iitr) {
+    assert(iitr != iend);
+    const auto rval = Evaluate().get_range(*ritr);
+    mul /= (rval.first-rval.second+1);
+    if (Constant().is_constant(*iitr)) {
+      s.base += mul * Evaluate().get_value(*iitr).to_int();
+    } else {
+      Evaluate().get_width(*iitr);
+      subs.push_back(make_pair(compile(*iitr), mul));
+    }
+  }
+
+  // Anything left over is a bit range
+  if (iitr != iend) {
+    const auto re = dynamic_cast<const RangeExpression*>(*iitr);
+    if (Constant().is_constant(*iitr)) {
+      const auto w = Evaluate().get_width(r);
+      const auto rng = Evaluate().get_range(*iitr);
+      s.range = FIXED;
+      s.msb = min(rng.first, w-1);
+      s.lsb = min(rng.second, w-1);
+    } else if (re == nullptr) {
+      Evaluate().get_width(*iitr);
+      s.range = BIT;
+      s.upper = compile(*iitr);
+    } else {
+      Evaluate().get_width(re->get_upper());
+      Evaluate().get_width(re->get_lower());
+      switch (re->get_type()) {
+        case RangeExpression::CONSTANT:
+          s.range = CONSTANT;
+          break;
+        case RangeExpression::PLUS:
+          s.range = PLUS;
+          break;
+        case RangeExpression::MINUS:
+          s.range = MINUS;
+          break;
+        default:
+          assert(false);
+          break;
+      }
+      s.upper = compile(re->get_upper());
+      s.lower = compile(re->get_lower());
+    }
+  }
+
+  s.sb = subs_.size();
+  subs_.insert(subs_.end(), subs.begin(), subs.end());
+  s.se = subs_.size();
+
+  slots_.push_back(s);
+  return slots_.size()-1;
+}
+
+size_t Bytecode::emit(Op op, const Expression* e, const Bits* lhs, const Bits* rhs) {
+  Instr i;
+  i.op = op;
+  i.e = const_cast<Expression*>(e);
+  i.dst = (e == nullptr) ? nullptr : &i.e->bit_val_[0];
+  i.lhs = lhs;
+  i.rhs = rhs;
+  i.x = nullptr;
+  i.a = 0;
+  i.b = 0;
+  code_.push_back(i);
+  return code_.size()-1;
+}
+
+void Bytecode::execute(size_t begin, size_t end) {
+  for (size_t pc = begin; pc < end; ) {
+    const auto& i = code_[pc++];
+    if (i.e != nullptr) {
+      if (!i.e->needs_update_) {
+        continue;
+      }
+      i.e->needs_update_ = false;
+    }
+    switch (i.op) {
+      case ADD:
+        i.lhs->arithmetic_plus(*i.rhs, *i.dst);
+        break;
+      case SUB:
+        i.lhs->arithmetic_minus(*i.rhs, *i.dst);
+        break;
+      case MUL:
+        i.lhs->arithmetic_multiply(*i.rhs, *i.dst);
+        break;
+      case DIV:
+        i.lhs->arithmetic_divide(*i.rhs, *i.dst);
+        break;
+      case MOD:
+        i.lhs->arithmetic_mod(*i.rhs, *i.dst);
+        break;
+      case EQ:
+        i.lhs->logical_eq(*i.rhs, *i.dst);
+        break;
+      case NE:
+        i.lhs->logical_ne(*i.rhs, *i.dst);
+        break;
+      case LAND:
+        i.lhs->logical_and(*i.rhs, *i.dst);
+        break;
+      case LOR:
+        i.lhs->logical_or(*i.rhs, *i.dst);
+        break;
+      case POW:
+        i.lhs->arithmetic_pow(*i.rhs, *i.dst);
+        break;
+      case LT:
+        i.lhs->logical_lt(*i.rhs, *i.dst);
+        break;
+      case LTE:
+        i.lhs->logical_lte(*i.rhs, *i.dst);
+        break;
+      case GT:
+        i.lhs->logical_gt(*i.rhs, *i.dst);
+        break;
+      case GTE:
+        i.lhs->logical_gte(*i.rhs, *i.dst);
+        break;
+      case AND:
+        i.lhs->bitwise_and(*i.rhs, *i.dst);
+        break;
+      case OR:
+        i.lhs->bitwise_or(*i.rhs, *i.dst);
+        break;
+      case XOR:
+        i.lhs->bitwise_xor(*i.rhs, *i.dst);
+        break;
+      case XNOR:
+        i.lhs->bitwise_xnor(*i.rhs, *i.dst);
+        break;
+      case SLL:
+        i.lhs->bitwise_sll(*i.rhs, *i.dst);
+        break;
+      case SAL:
+        i.lhs->bitwise_sal(*i.rhs, *i.dst);
+        break;
+      case SLR:
+        i.lhs->bitwise_slr(*i.rhs, *i.dst);
+        break;
+      case SAR:
+        i.lhs->bitwise_sar(*i.rhs, *i.dst);
+        break;
+
+      case UPLUS:
+        i.lhs->arithmetic_plus(*i.dst);
+        break;
+      case UMINUS:
+        i.lhs->arithmetic_minus(*i.dst);
+        break;
+      case LNOT:
+        i.lhs->logical_not(*i.dst);
+        break;
+      case NOT:
+        i.lhs->bitwise_not(*i.dst);
+        break;
+      case RAND:
+        i.lhs->reduce_and(*i.dst);
+        break;
+      case RNAND:
+        i.lhs->reduce_nand(*i.dst);
+        break;
+      case ROR:
+        i.lhs->reduce_or(*i.dst);
+        break;
+      case RNOR:
+        i.lhs->reduce_nor(*i.dst);
+        break;
+      case RXOR:
+        i.lhs->reduce_xor(*i.dst);
+        break;
+      case RXNOR:
+        i.lhs->reduce_xnor(*i.dst);
+        break;
+
+      case COPY:
+        i.dst->assign(*i.lhs);
+        break;
+      case SLICE:
+        i.dst->assign(*i.lhs, i.a, i.b);
+        break;
+      case LOAD: {
+        const auto& s = slots_[i.a];
+        const auto dres = dereference(s);
+        const auto& src = s.r->bit_val_[get<0>(dres)];
+        if (get<1>(dres) == -1) {
+          i.dst->assign(src);
+        } else {
+          i.dst->assign(src, get<1>(dres), get<2>(dres));
+        }
+        break;
+      }
+      case CONCAT:
+        i.dst->assign(*args_[i.a]);
+        for (auto j = i.a+1; j < i.b; ++j) {
+          i.dst->concat(*args_[j]);
+        }
+        break;
+      case REPEAT:
+        i.dst->assign(*i.lhs);
+        for (size_t j = 1; j < i.a; ++j) {
+          i.dst->concat(*i.lhs);
+        }
+        break;
+
+      case SKIP:
+        if (!i.x->needs_update_) {
+          pc = i.a;
+        }
+        break;
+      case BRANCH:
+        if (!i.lhs->to_bool()) {
+          pc = i.a;
+        }
+        break;
+      case JUMP:
+        pc = i.a;
+        break;
+
+      case EVAL:
+        Evaluate().get_value(i.x);
+        break;
+
+      default:
+        assert(false);
+        break;
+    }
+  }
+}
+
+void Bytecode::visit(const BinaryExpression* be) {
+  const auto lhs = compile(be->get_lhs());
+  const auto rhs = compile(be->get_rhs());
+
+  auto op = ADD;
+  switch (be->get_op()) {
+    case BinaryExpression::PLUS:
+      op = ADD;
+      break;
+    case BinaryExpression::MINUS:
+      op = SUB;
+      break;
+    case BinaryExpression::TIMES:
+      op = MUL;
+      break;
+    case BinaryExpression::DIV:
+      op = DIV;
+      break;
+    case BinaryExpression::MOD:
+      op = MOD;
+      break;
+    // NOTE: These are equivalent because we don't support x and z
+    case BinaryExpression::EEEQ:
+    case BinaryExpression::EEQ:
+      op = EQ;
+      break;
+    // NOTE: These are equivalent because we don't support x and z
+    case BinaryExpression::BEEQ:
+    case BinaryExpression::BEQ:
+      op = NE;
+      break;
+    case BinaryExpression::AAMP:
+      op = LAND;
+      break;
+    case BinaryExpression::PPIPE:
+      op = LOR;
+      break;
+    case BinaryExpression::TTIMES:
+      op = POW;
+      break;
+    case BinaryExpression::LT:
+      op = LT;
+      break;
+    case BinaryExpression::LEQ:
+      op = LTE;
+      break;
+    case BinaryExpression::GT:
+      op = GT;
+      break;
+    case BinaryExpression::GEQ:
+      op = GTE;
+      break;
+    case BinaryExpression::AMP:
+      op = AND;
+      break;
+    case BinaryExpression::PIPE:
+      op = OR;
+      break;
+    case BinaryExpression::CARAT:
+      op = XOR;
+      break;
+    case BinaryExpression::TCARAT:
+      op = XNOR;
+      break;
+    case BinaryExpression::LLT:
+      op = SLL;
+      break;
+    case BinaryExpression::LLLT:
+      op = SAL;
+      break;
+    case BinaryExpression::GGT:
+      op = SLR;
+      break;
+    case BinaryExpression::GGGT:
+      op = SAR;
+      break;
+    default:
+      assert(false);
+      break;
+  }
+  emit(op, be, lhs, rhs);
+  res_ = &be->bit_val_[0];
+}
+
+void Bytecode::visit(const ConditionalExpression* ce) {
+  // Skip both branches if nothing has changed. Otherwise, only the branch
+  // which is selected by the condition is evaluated.
+  const auto skip = emit(SKIP, nullptr);
+  code_[skip].x = ce;
+
+  const auto cond = compile(ce->get_cond());
+  const auto branch = emit(BRANCH, nullptr, cond);
+  const auto lhs = compile(ce->get_lhs());
+  emit(COPY, ce, lhs);
+  const auto jump = emit(JUMP, nullptr);
+  code_[branch].a = code_.size();
+  const auto rhs = compile(ce->get_rhs());
+  emit(COPY, ce, rhs);
+  code_[jump].a = code_.size();
+  code_[skip].a = code_.size();
+
+  res_ = &ce->bit_val_[0];
+}
+
+void Bytecode::visit(const NestedExpression* ne) {
+  const auto val = compile(ne->get_expr());
+  // Parentheses are free unless they change width or sign
+  const auto& dst = ne->bit_val_[0];
+  if ((ne != root_) && (val->size() == dst.size()) && (val->is_signed() == dst.is_signed())) {
+    return;
+  }
+  emit(COPY, ne, val);
+  res_ = &dst;
+}
+
+void Bytecode::visit(const Concatenation* c) {
+  // Compile all of the operands first, nested concatenations use args_ too
+  vector<const Bits*> args;
+  for (auto e : *c->get_exprs()) {
+    args.push_back(compile(e));
+  }
+  const auto i = emit(CONCAT, c);
+  code_[i].a = args_.size();
+  args_.insert(args_.end(), args.begin(), args.end());
+  code_[i].b = args_.size();
+
+  res_ = &c->bit_val_[0];
+}
+
+void Bytecode::visit(const Identifier* id) {
+  const auto idx = lower(id);
+  const auto& s = slots_[idx];
+  const auto& dst = id->bit_val_[0];
+  res_ = &dst;
+
+  // Dynamic subscripts have to be dereferenced at run time
+  if ((s.sb != s.se) || (s.range > FIXED)) {
+    const auto i = emit(LOAD, id);
+    code_[i].a = idx;
+    return;
+  }
+  // Everything else was resolved once and for all
+  const auto& src = s.r->bit_val_[s.base >= s.r->bit_val_.size() ? 0 : s.base];
+  if (s.range == FIXED) {
+    const auto i = emit(SLICE, id, &src);
+    code_[i].a = s.msb;
+    code_[i].b = s.lsb;
+    return;
+  }
+  // Read the declaration in place if no conversion is necessary. We don't do
+  // this at the root so that the result of an assignment never aliases the
+  // variable that it's written to.
+  if ((id != root_) && (src.size() == dst.size()) && (src.is_signed() == dst.is_signed())) {
+    res_ = &src;
+    return;
+  }
+  emit(COPY, id, &src);
+}
+
+void Bytecode::visit(const MultipleConcatenation* mc) {
+  // The multiplier is a separate subtree and must be a constant
+  const auto n = Evaluate().get_value(mc->get_expr()).to_int();
+  const auto val = compile(mc->get_concat());
+  const auto i = emit(REPEAT, mc, val);
+  code_[i].a = n;
+
+  res_ = &mc->bit_val_[0];
+}
+
+void Bytecode::visit(const Number* n) {
+  // Numbers are assigned their values when bits are allocated
+  res_ = &n->bit_val_[0];
+}
+
+void Bytecode::visit(const String* s) {
+  const auto i = emit(EVAL, nullptr);
+  code_[i].x = s;
+  res_ = &s->bit_val_[0];
+}
+
+void Bytecode::visit(const UnaryExpression* ue) {
+  const auto lhs = compile(ue->get_lhs());
+
+  auto op = UPLUS;
+  switch (ue->get_op()) {
+    case UnaryExpression::PLUS:
+      op = UPLUS;
+      break;
+    case UnaryExpression::MINUS:
+      op = UMINUS;
+      break;
+    case UnaryExpression::BANG:
+      op = LNOT;
+      break;
+    case UnaryExpression::TILDE:
+      op = NOT;
+      break;
+    case UnaryExpression::AMP:
+      op = RAND;
+      break;
+    case UnaryExpression::TAMP:
+      op = RNAND;
+      break;
+    case UnaryExpression::PIPE:
+      op = ROR;
+      break;
+    case UnaryExpression::TPIPE:
+      op = RNOR;
+      break;
+    case UnaryExpression::CARAT:
+      op = RXOR;
+      break;
+    case UnaryExpression::TCARAT:
+      op = RXNOR;
+      break;
+    default:
+      assert(false);
+      break;
+  }
+  emit(op, ue, lhs);
+  res_ = &ue->bit_val_[0];
+}
+
+} // namespace cascade
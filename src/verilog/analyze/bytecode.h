@@ -0,0 +1,260 @@
+// Copyright 2017-2018 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef CASCADE_SRC_VERILOG_ANALYZE_BYTECODE_H
+#define CASCADE_SRC_VERILOG_ANALYZE_BYTECODE_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include "src/base/bits/bits.h"
+#include "src/verilog/ast/ast.h"
+#include "src/verilog/ast/visitors/visitor.h"
+
+namespace cascade {
+
+// This class compiles an expression tree into a flat sequence of instructions
+// and provides a small virtual machine for executing them. It is intended for
+// expressions which are evaluated repeatedly, such as the right-hand sides of
+// continuous assignments, and produces the same results as Evaluate (see
+// evaluate.h), which it relies on for bit-width and sign information.
+
+// The register file for the virtual machine is the set of bit values which
+// Evaluate allocates for each subexpression. Instructions hold pointers
+// directly to these values. Every variable reference is lowered to a slot: a
+// pointer to the storage of its declaration, along with whatever part of its
+// array index and bit range can be computed ahead of time. Only subscripts
+// which aren't compile-time constants are evaluated at run time. Where the
+// width and sign of a reference match its declaration, the declaration is
+// read in place without an intermediate copy. Instructions are guarded by the
+// needs_update_ flags of the expressions they compute, so unchanged
+// subexpressions are skipped just as they would be by Evaluate.
+
+class Bytecode : public Visitor {
+  public:
+    // Constructors:
+    explicit Bytecode(const Expression* e);
+    explicit Bytecode(const VariableAssign* va);
+    ~Bytecode() override = default;
+
+    // Returns the value of the expression, recomputing it if necessary.
+    const Bits& get_value();
+    // Returns the declaration of the variable written by an assignment.
+    // Returns nullptr for programs which were compiled from expressions.
+    const Identifier* get_target() const;
+    // Returns the index into the target's underlying array and the bit range
+    // written by an assignment, using the same conventions as
+    // Evaluate::dereference().
+    std::tuple<size_t,int,int> get_index();
+
+  private:
+    // Opcodes:
+    enum Op : uint8_t {
+      // Binary Operators: dst = lhs op rhs
+      ADD = 0,
+      SUB,
+      MUL,
+      DIV,
+      MOD,
+      EQ,
+      NE,
+      LAND,
+      LOR,
+      POW,
+      LT,
+      LTE,
+      GT,
+      GTE,
+      AND,
+      OR,
+      XOR,
+      XNOR,
+      SLL,
+      SAL,
+      SLR,
+      SAR,
+      // Unary Operators: dst = op lhs
+      UPLUS,
+      UMINUS,
+      LNOT,
+      NOT,
+      RAND,
+      RNAND,
+      ROR,
+      RNOR,
+      RXOR,
+      RXNOR,
+      // Data Movement: 
+      COPY,      // dst = lhs
+      SLICE,     // dst = lhs[a:b]
+      LOAD,      // dst = slots_[a]
+      CONCAT,    // dst = {args_[a], ..., args_[b-1]}
+      REPEAT,    // dst = {a{lhs}}
+      // Control Flow:
+      SKIP,      // if (!x->needs_update_) goto a
+      BRANCH,    // if (!lhs) goto a
+      JUMP,      // goto a
+      // Fallback:
+      EVAL       // Evaluate().get_value(x)
+    };
+    // Instructions:
+    struct Instr {
+      Op op;
+      // The expression which this instruction computes. If this expression is
+      // up to date, the instruction is skipped. Null for instructions which
+      // always execute.
+      Expression* e;
+      Bits* dst;
+      const Bits* lhs;
+      const Bits* rhs;
+      const Expression* x;
+      size_t a;
+      size_t b;
+    };
+
+    // Slots:
+    enum Range : uint8_t {
+      NONE = 0,  // No bit range
+      FIXED,     // msb:lsb
+      BIT,       // [upper]
+      CONSTANT,  // [upper:lower]
+      PLUS,      // [upper+:lower]
+      MINUS      // [upper-:lower]
+    };
+    struct Slot {
+      // The declaration this slot refers to
+      const Identifier* r;
+      // The array index: base + the sum of subs_[sb, se) times their strides
+      size_t base;
+      size_t sb;
+      size_t se;
+      // The bit range: either fixed or computed from upper and lower
+      Range range;
+      int msb;
+      int lsb;
+      const Bits* upper;
+      const Bits* lower;
+    };
+
+    // Program State:
+    const Expression* root_;
+    const Bits* res_;
+    std::vector<Instr> code_;
+    std::vector<const Bits*> args_;
+    std::vector<Slot> slots_;
+    std::vector<std::pair<const Bits*, size_t>> subs_;
+    // Assignments only: the split between code for the right-hand side and
+    // code for the subscripts of the left-hand side, and the target slot.
+    size_t split_;
+    size_t target_;
+
+    // Compilation Helpers:
+    const Bits* compile(const Expression* e);
+    size_t lower(const Identifier* id);
+    size_t emit(Op op, const Expression* e, const Bits* lhs = nullptr, const Bits* rhs = nullptr);
+
+    // Execution Helpers:
+    void execute(size_t begin, size_t end);
+    std::tuple<size_t,int,int> dereference(const Slot& s) const;
+
+    // Visitor Interface:
+    void visit(const BinaryExpression* be) override;
+    void visit(const ConditionalExpression* ce) override;
+    void visit(const NestedExpression* ne) override;
+    void visit(const Concatenation* c) override;
+    void visit(const Identifier* id) override;
+    void visit(const MultipleConcatenation* mc) override;
+    void visit(const Number* n) override;
+    void visit(const String* s) override;
+    void visit(const UnaryExpression* ue) override;
+};
+
+inline const Bits& Bytecode::get_value() {
+  if (root_->needs_update_) {
+    execute(0, split_);
+  }
+  return *res_;
+}
+
+inline const Identifier* Bytecode::get_target() const {
+  return (target_ < slots_.size()) ? slots_[target_].r : nullptr;
+}
+
+inline std::tuple<size_t,int,int> Bytecode::get_index() {
+  assert(target_ < slots_.size());
+  execute(split_, code_.size());
+  return dereference(slots_[target_]);
+}
+
+inline std::tuple<size_t,int,int> Bytecode::dereference(const Slot& s) const {
+  // Out of bounds accesses are undefined, so we'll map them to a safe value
+  auto idx = s.base;
+  for (auto i = s.sb; i < s.se; ++i) {
+    idx += subs_[i].second * subs_[i].first->to_int();
+  }
+  if (idx >= s.r->bit_val_.size()) {
+    idx = 0;
+  }
+
+  if (s.range <= FIXED) {
+    return std::make_tuple(idx, s.msb, s.lsb);
+  }
+  size_t msb = 0;
+  size_t lsb = 0;
+  switch (s.range) {
+    case BIT:
+      msb = lsb = s.upper->to_int();
+      break;
+    case CONSTANT:
+      msb = s.upper->to_int();
+      lsb = s.lower->to_int();
+      break;
+    case PLUS:
+      lsb = s.upper->to_int();
+      msb = lsb + s.lower->to_int() - 1;
+      break;
+    case MINUS:
+      msb = s.upper->to_int();
+      lsb = msb - s.lower->to_int() + 1;
+      break;
+    default:
+      assert(false);
+      break;
+  }
+  const auto w = s.r->bit_val_[0].size();
+  return std::make_tuple(idx, (int) std::min(msb, w-1), (int) std::min(lsb, w-1));
+}
+
+} // namespace cascade
+
+#endif
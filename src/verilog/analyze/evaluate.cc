@@ -30,7 +30,8 @@
 
 #include "src/verilog/analyze/evaluate.h"
 
-
+#include <algorithm>
+#include <utility>
 #include "src/verilog/print/term/term_printer.h"
 
 
@@ -113,6 +114,53 @@ pair<size_t, size_t> Evaluate::get_range(const Expression* e) {
   return make_pair(idx, idx);
 }
 
+pair<size_t, bool> Evaluate::get_case_extension(const CaseStatement* cs) {
+  auto w = get_width(cs->get_cond());
+  auto s = get_signed(cs->get_cond());
+  for (auto ci : *cs->get_items()) {
+    for (auto e : *ci->get_exprs()) {
+      w = max(w, get_width(e));
+      s = s && get_signed(e);
+    }
+  }
+  return make_pair(w, s);
+}
+
+uint32_t Evaluate::get_case_word(const Bits& b, size_t n, const pair<size_t, bool>& ext) {
+  // Nothing to do past the extended width
+  const auto en = (ext.first + 31) / 32;
+  if (n >= en) {
+    return 0;
+  }
+  // Words which are past the end of b are filled with its sign bit, as are
+  // the unused bits in its last word
+  const auto bn = (b.size() + 31) / 32;
+  const auto neg = ext.second && b.get(b.size()-1);
+  uint32_t res = neg ? uint32_t(-1) : 0;
+  if (n < bn) {
+    res = b.read_word<uint32_t>(n);
+    const auto trailing = b.size() % 32;
+    if (neg && (n+1 == bn) && (trailing != 0)) {
+      res |= (uint32_t(-1) << trailing);
+    }
+  }
+  // And anything past the extended width is masked off
+  const auto trailing = ext.first % 32;
+  if ((n+1 == en) && (trailing != 0)) {
+    res &= (uint32_t(1) << trailing) - 1;
+  }
+  return res;
+}
+
+bool Evaluate::case_equal(const Bits& x, const Bits& y, const pair<size_t, bool>& ext) {
+  for (size_t i = 0, ie = (ext.first + 31) / 32; i < ie; ++i) {
+    if (get_case_word(x, i, ext) != get_case_word(y, i, ext)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 void Evaluate::assign_value(const Identifier* id, const Bits& val) {
   // Find the variable that we're referring to. 
   const auto r = Resolve().get_resolution(id);
@@ -189,7 +237,7 @@ tuple<size_t,int,int> Evaluate::dereference(const Identifier* r, const Identifie
   return make_tuple(idx >= r->bit_val_.size() ? 0 : idx, rng.first, rng.second);
 }
 
-void Evaluate::assign_value(const Identifier* id, size_t idx, int msb, int lsb, const Bits& val) {
+bool Evaluate::assign_value(const Identifier* id, size_t idx, int msb, int lsb, const Bits& val) {
   init(const_cast<Identifier*>(id));
   assert(idx < id->bit_val_.size());
 
@@ -197,6 +245,7 @@ void Evaluate::assign_value(const Identifier* id, size_t idx, int msb, int lsb,
     if (!id->bit_val_[idx].eq(val)) {
       const_cast<Identifier*>(id)->bit_val_[idx].assign(val);
       flag_changed(id);
+      return true;
     }
   } else {
     const auto m = min((size_t) msb, get_width(id)-1);
@@ -204,8 +253,23 @@ void Evaluate::assign_value(const Identifier* id, size_t idx, int msb, int lsb,
     if (!id->bit_val_[idx].eq(m, l, val)) {
       const_cast<Identifier*>(id)->bit_val_[idx].assign(m, l, val);
       flag_changed(id);
+      return true;
     }
   }
+  return false;
+}
+
+bool Evaluate::swap_value(const Identifier* id, size_t idx, Bits& val) {
+  init(const_cast<Identifier*>(id));
+  assert(idx < id->bit_val_.size());
+  assert(id->bit_val_[idx].size() == val.size());
+
+  if (!id->bit_val_[idx].eq(val)) {
+    swap(const_cast<Identifier*>(id)->bit_val_[idx], val);
+    flag_changed(id);
+    return true;
+  }
+  return false;
 }
 
 void Evaluate::invalidate(const Expression* e) {
@@ -86,6 +86,19 @@ class Evaluate : public Editor {
     // Returns upper and lower values for ranges, get_value() twice otherwise.
     std::pair<size_t, size_t> get_range(const Expression* e);
 
+    // Case statement interface: Returns the width and sign that the condition
+    // and item expressions of a case statement are extended to before they're
+    // compared: the largest of their widths, and signed only if every one of
+    // them is signed.
+    std::pair<size_t, bool> get_case_extension(const CaseStatement* cs);
+    // Case statement interface: Returns the n'th 32-bit word of b once it's
+    // been extended as described by ext. Words past the extended width are
+    // zero.
+    static uint32_t get_case_word(const Bits& b, size_t n, const std::pair<size_t, bool>& ext);
+    // Case statement interface: Returns true if x and y are equal once they've
+    // both been extended as described by ext.
+    static bool case_equal(const Bits& x, const Bits& y, const std::pair<size_t, bool>& ext);
+
     // High-level interface: Resolves id and sets the value of its target val.
     // Invoking this method on an unresolvable id or one which refers to an
     // array is undefined.
@@ -103,12 +116,17 @@ class Evaluate : public Editor {
     // Low-level interface: Sets the value of the ss'th element in id's
     // underlying array. Note that this value is set *in place*. This method
     // DOES NOT resolve id and then update the value which it finds there.
-    void assign_value(const Identifier* id, size_t idx, int msb, int lsb, const Bits& val);
+    // Returns true if the value of any of the bits in the range changed.
+    bool assign_value(const Identifier* id, size_t idx, int msb, int lsb, const Bits& val);
     // Low-level interface: Sets the value of the idx'th element in id's
     // underlying array. Note that this value is set *in place*. This method
     // DOES NOT resolve id and then update the value which it finds there.
     template <typename B>
     void assign_word(const Identifier* id, size_t idx, size_t n, B b);
+    // Low-level interface: Exchanges the value of the idx'th element in id's
+    // underlying array with val, which must have the same width and sign.
+    // This method DOES NOT resolve id. Returns true if the value changed.
+    bool swap_value(const Identifier* id, size_t idx, Bits& val);
 
     // Invalidates bits, size, and type for this expression and the
     // sub-expressions that it consists of.
@@ -53,6 +53,7 @@ class Expression : public Node {
 
   protected:
     // Decorations used by Evaluate
+    friend class Bytecode;
     friend class Evaluate;
     // A vector of bitstring values, a variable array being the most general
     // instance of an expression
@@ -65,6 +65,7 @@ class Node {
     friend class SwLogic;
     DECORATION(size_t, ctrl);
     DECORATION(bool, active);
+    DECORATION(bool, direct);
 
     friend class Elaborate;
     friend class Inline;
@@ -78,6 +79,7 @@ class Node {
 inline Node::Node() {
   ctrl_ = 0;
   active_ = false;
+  direct_ = false;
   source_ = "<unknown location --- please submit bug report>";
   line_ = 0;
 }
@@ -614,27 +614,36 @@ void TypeCheck::visit(const NonblockingAssign* na) {
 }
 
 void TypeCheck::visit(const ForStatement* fs) {
-  error("Cascade does not currently support the use of for statements", fs);
+  // RECURSE:
+  Visitor::visit(fs);
+  // CHECK: Loop variable must be register or integer
+  for (auto va : {fs->get_init(), fs->get_update()}) {
+    const auto r = Resolve().get_resolution(va->get_lhs());
+    if ((r != nullptr) && 
+        (dynamic_cast<const RegDeclaration*>(r->get_parent()) == nullptr) && 
+        (dynamic_cast<const IntegerDeclaration*>(r->get_parent()) == nullptr)) {
+      error("Found a for statement with a loop variable of type other than reg or integer", fs);
+      return;
+    }
+  }
 }
 
 void TypeCheck::visit(const ForeverStatement* fs) {
   error("Cascade does not currently support the use of forever statements", fs);
 }
 
-void TypeCheck::visit(const RepeatStatement* rs) {
-  error("Cascade does not currently support the use of repeat statements", rs);
-}
-
-void TypeCheck::visit(const WhileStatement* ws) {
-  error("Cascade does not currently support the use of while statements", ws);
-}
-
 void TypeCheck::visit(const WaitStatement* ws) {
   error("Cascade does not currently support the use of wait statements", ws);
 }
 
 void TypeCheck::visit(const DelayControl* dc) {
-  error("Cascade does not currently support the use of delay controls", dc);
+  // CHECK: Delay controls are only supported on statements
+  if (dynamic_cast<const TimingControlStatement*>(dc->get_parent()) == nullptr) {
+    error("Cascade does not currently support the use of delay controls outside of timing control statements", dc);
+    return;
+  }
+  // RECURSE: delay
+  Visitor::visit(dc);
 }
 
 void TypeCheck::check_width(const Maybe<RangeExpression>* re) {
@@ -105,8 +105,6 @@ class TypeCheck : public Visitor {
     void visit(const SeqBlock* sb) override;
     void visit(const ForStatement* fs) override;
     void visit(const ForeverStatement* fs) override;
-    void visit(const RepeatStatement* rs) override;
-    void visit(const WhileStatement* ws) override;
     void visit(const WaitStatement* ws) override;
     void visit(const DelayControl* dc) override;
 
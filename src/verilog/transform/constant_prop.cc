@@ -30,6 +30,7 @@
 
 #include "src/verilog/transform/constant_prop.h"
 
+#include <algorithm>
 #include "src/verilog/analyze/constant.h"
 #include "src/verilog/analyze/evaluate.h"
 #include "src/verilog/analyze/resolve.h"
@@ -37,20 +38,219 @@
 
 namespace cascade {
 
-ConstantProp::ConstantProp() : Rewriter() { }
+ConstantProp::ConstantProp() : Rewriter() {
+}
 
 void ConstantProp::run(ModuleDeclaration* md) {
   md->accept(this);
 }
 
+Expression* ConstantProp::fold(Expression* e) {
+  auto res = new Number(Evaluate().get_value(e), Number::HEX);
+  Evaluate().invalidate(e);
+  Resolve().invalidate(e);
+  return res;
+}
+
+Statement* ConstantProp::collapse(Statement* s, Statement* res) {
+  // Whatever we return will replace s, so make sure that it isn't deleted
+  // along with it.
+  auto sb = new SeqBlock(new Maybe<Identifier>(), new Many<Declaration>(), new Many<Statement>());
+  if (res == nullptr) {
+    res = sb;
+  } else if (res->get_parent() != nullptr) {
+    auto ci = dynamic_cast<CaseItem*>(res->get_parent());
+    auto cs = dynamic_cast<ConditionalStatement*>(res->get_parent());
+    if (ci != nullptr) {
+      ci->set_stmt(sb);
+    } else if ((cs != nullptr) && (cs->get_then() == res)) {
+      cs->set_then(sb);
+    } else if (cs != nullptr) {
+      cs->set_else(sb);
+    } else {
+      delete sb;
+    }
+  } else {
+    delete sb;
+  }
+  Resolve().invalidate(s);
+  return res;
+}
+
+Expression* ConstantProp::reduce(BinaryExpression* be) {
+  // We only handle the case where exactly one operand is constant. If both
+  // were constant, this expression would have been folded.
+  const auto ln = dynamic_cast<Number*>(be->get_lhs());
+  const auto rn = dynamic_cast<Number*>(be->get_rhs());
+  if ((ln == nullptr) == (rn == nullptr)) {
+    return be;
+  }
+  const auto lhs = (rn != nullptr);
+  const auto& c = lhs ? rn->get_val() : ln->get_val();
+  const auto k = log2(c);
+
+  // Most of these rewrites are only safe if they leave the self-determined
+  // width and sign of this expression unchanged.
+  size_t w = 0;
+  bool s = false;
+  const auto known = self_determine(lhs ? be->get_lhs() : be->get_rhs(), &w, &s);
+  const auto fits = known && (w >= c.size()) && (!s || c.is_signed());
+
+  switch (be->get_op()) {
+    case BinaryExpression::TIMES:
+      if (fits && (k == 0)) {
+        return forward(be, lhs);
+      } else if (fits && (k > 0)) {
+        return replace(be, lhs, BinaryExpression::LLT, new Number(Bits(32, k)));
+      }
+      break;
+    case BinaryExpression::DIV:
+      if (lhs && fits && !s && (k == 0)) {
+        return forward(be, lhs);
+      } else if (lhs && fits && !s && (k > 0)) {
+        return replace(be, lhs, BinaryExpression::GGT, new Number(Bits(32, k)));
+      }
+      break;
+    case BinaryExpression::MOD:
+      // Mod and bitwise and share width and sign rules, so we only need to
+      // know that the result is unsigned.
+      if (lhs && (k >= 0) && (!c.is_signed() || (known && !s))) {
+        Bits mask(c.size(), 0);
+        for (auto i = 0; i < k; ++i) {
+          mask.set(i, true);
+        }
+        mask.set_signed(c.is_signed());
+        return replace(be, lhs, BinaryExpression::AMP, new Number(mask, Number::HEX));
+      }
+      break;
+    case BinaryExpression::AMP:
+      if (fits && (w == c.size()) && is_ones(c)) {
+        return forward(be, lhs);
+      }
+      break;
+    case BinaryExpression::PIPE:
+    case BinaryExpression::CARAT:
+    case BinaryExpression::PLUS:
+      if (fits && is_zero(c)) {
+        return forward(be, lhs);
+      }
+      break;
+    case BinaryExpression::MINUS:
+      if (lhs && fits && is_zero(c)) {
+        return forward(be, lhs);
+      }
+      break;
+    case BinaryExpression::LLT:
+    case BinaryExpression::LLLT:
+    case BinaryExpression::GGT:
+    case BinaryExpression::GGGT:
+      // The rhs of a shift is self-determined, so this is always safe.
+      if (lhs && is_zero(c)) {
+        return forward(be, lhs);
+      }
+      break;
+    default:
+      break;
+  }
+  return be;
+}
+
+Expression* ConstantProp::replace(BinaryExpression* be, bool lhs, BinaryExpression::Op op, Number* n) {
+  Evaluate().invalidate(be);
+  Resolve().invalidate(be);
+
+  auto x = lhs ? be->get_lhs() : be->get_rhs();
+  if (lhs) {
+    be->set_lhs(new Identifier("ignore"));
+  } else {
+    be->set_rhs(new Identifier("ignore"));
+  }
+  Expression* res = new BinaryExpression(x, op, n);
+  // The operators we introduce bind more loosely than the ones they replace
+  if (dynamic_cast<Expression*>(be->get_parent()) != nullptr) {
+    res = new NestedExpression(res);
+  }
+  return res;
+}
+
+Expression* ConstantProp::forward(BinaryExpression* be, bool lhs) {
+  Evaluate().invalidate(be);
+  Resolve().invalidate(be);
+
+  auto res = lhs ? be->get_lhs() : be->get_rhs();
+  if (lhs) {
+    be->set_lhs(new Identifier("ignore"));
+  } else {
+    be->set_rhs(new Identifier("ignore"));
+  }
+  return res;
+}
+
+bool ConstantProp::self_determine(const Expression* e, size_t* w, bool* s) {
+  if (auto n = dynamic_cast<const Number*>(e)) {
+    *w = n->get_val().size();
+    *s = n->get_val().is_signed();
+    return true;
+  }
+  if (auto ne = dynamic_cast<const NestedExpression*>(e)) {
+    return self_determine(ne->get_expr(), w, s);
+  }
+  const auto id = dynamic_cast<const Identifier*>(e);
+  if (id == nullptr) {
+    return false;
+  }
+  const auto r = Resolve().get_resolution(id);
+  if (r == nullptr) {
+    return false;
+  }
+  if (id->get_dim()->size() == r->get_dim()->size()) {
+    *w = Evaluate().get_width(r);
+    *s = Evaluate().get_signed(r);
+    return true;
+  }
+  if ((id->get_dim()->size() == r->get_dim()->size()+1) && (dynamic_cast<const RangeExpression*>(id->get_dim()->back()) == nullptr)) {
+    *w = 1;
+    *s = false;
+    return true;
+  }
+  return false;
+}
+
+int ConstantProp::log2(const Bits& b) {
+  // Negative numbers aren't powers of two
+  if (b.is_signed() && b.get(b.size()-1)) {
+    return -1;
+  }
+  auto res = -1;
+  for (size_t i = 0, ie = b.size(); i < ie; ++i) {
+    if (b.get(i) && (res != -1)) {
+      return -1;
+    } else if (b.get(i)) {
+      res = i;
+    }
+  }
+  return res;
+}
+
+bool ConstantProp::is_zero(const Bits& b) {
+  return !b.to_bool();
+}
+
+bool ConstantProp::is_ones(const Bits& b) {
+  for (size_t i = 0, ie = b.size(); i < ie; ++i) {
+    if (!b.get(i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 Expression* ConstantProp::rewrite(BinaryExpression* be) {
   if (Constant().is_constant_genvar(be)) {
-    auto res = new Number(Evaluate().get_value(be), Number::HEX);
-    Evaluate().invalidate(be);
-    Resolve().invalidate(be);
-    return res;
+    return fold(be);
   }
-  return Rewriter::rewrite(be);
+  Rewriter::rewrite(be);
+  return reduce(be);
 }
 
 Expression* ConstantProp::rewrite(ConditionalExpression* ce) {
@@ -76,20 +276,14 @@ Expression* ConstantProp::rewrite(ConditionalExpression* ce) {
 
 Expression* ConstantProp::rewrite(NestedExpression* ne) {
   if (Constant().is_constant_genvar(ne)) {
-    auto res = new Number(Evaluate().get_value(ne), Number::HEX);
-    Evaluate().invalidate(ne);
-    Resolve().invalidate(ne);
-    return res;
+    return fold(ne);
   }
   return Rewriter::rewrite(ne);
 }
 
 Expression* ConstantProp::rewrite(Concatenation* c) {
   if (Constant().is_constant_genvar(c)) {
-    auto res = new Number(Evaluate().get_value(c), Number::HEX);
-    Evaluate().invalidate(c);
-    Resolve().invalidate(c);
-    return res;
+    return fold(c);
   }
   return Rewriter::rewrite(c);
 }
@@ -99,20 +293,14 @@ Expression* ConstantProp::rewrite(Identifier* i) {
     return Rewriter::rewrite(i);
   }
   if (Constant().is_constant_genvar(i)) {
-    auto res = new Number(Evaluate().get_value(i), Number::HEX);
-    Evaluate().invalidate(i);
-    Resolve().invalidate(i);
-    return res;
+    return fold(i);
   }
   return Rewriter::rewrite(i);
 }
 
 Expression* ConstantProp::rewrite(MultipleConcatenation* mc) {
   if (Constant().is_constant_genvar(mc)) {
-    auto res = new Number(Evaluate().get_value(mc), Number::HEX);
-    Evaluate().invalidate(mc);
-    Resolve().invalidate(mc);
-    return res;
+    return fold(mc);
   }
   return Rewriter::rewrite(mc);
 }
@@ -130,30 +318,59 @@ Expression* ConstantProp::rewrite(RangeExpression* re) {
 
 Expression* ConstantProp::rewrite(UnaryExpression* ue) {
   if (Constant().is_constant_genvar(ue)) {
-    auto res = new Number(Evaluate().get_value(ue), Number::HEX);
-    Evaluate().invalidate(ue);
-    Resolve().invalidate(ue);
-    return res;
+    return fold(ue);
   }
   return Rewriter::rewrite(ue);
 }
 
+Statement* ConstantProp::rewrite(CaseStatement* cs) {
+  // We don't attempt to fold casex or casez statements.
+  if ((cs->get_type() != CaseStatement::CASE) || !Constant().is_constant_genvar(cs->get_cond())) {
+    return Rewriter::rewrite(cs);
+  }
+  // Case item expressions are compared against the condition in order, after
+  // extending all of them to a common width and sign. We can only fold this
+  // statement if every expression we'd need to evaluate on the way to a match
+  // is constant.
+  const auto ext = Evaluate().get_case_extension(cs);
+  const auto& cond = Evaluate().get_value(cs->get_cond());
+  CaseItem* match = nullptr;
+  CaseItem* def = nullptr;
+  for (auto ci : *cs->get_items()) {
+    if (ci->get_exprs()->empty()) {
+      def = ci;
+      continue;
+    }
+    for (auto e : *ci->get_exprs()) {
+      if (!Constant().is_constant_genvar(e)) {
+        return Rewriter::rewrite(cs);
+      }
+      if (Evaluate::case_equal(cond, Evaluate().get_value(e), ext)) {
+        match = ci;
+        break;
+      }
+    }
+    if (match != nullptr) {
+      break;
+    }
+  }
+  if (match == nullptr) {
+    match = def;
+  }
+
+  if (match == nullptr) {
+    return collapse(cs, nullptr);
+  }
+  return collapse(cs, match->get_stmt()->accept(this));
+}
+
 Statement* ConstantProp::rewrite(ConditionalStatement* cs) {
   if (Constant().is_constant_genvar(cs->get_if())) {
-    Statement* res = nullptr;
     if (Evaluate().get_value(cs->get_if()).to_bool()) {
-      res = cs->get_then()->accept(this);
-      if (res == cs->get_then()) {
-        cs->set_then(new SeqBlock(new Maybe<Identifier>(), new Many<Declaration>(), new Many<Statement>()));  
-      }
+      return collapse(cs, cs->get_then()->accept(this));
     } else {
-      res = cs->get_else()->accept(this);
-      if (res == cs->get_else()) {
-        cs->set_else(new SeqBlock(new Maybe<Identifier>(), new Many<Declaration>(), new Many<Statement>()));  
-      }
+      return collapse(cs, cs->get_else()->accept(this));
     }
-    Resolve().invalidate(cs);
-    return res;
   }
   return Rewriter::rewrite(cs);
 }
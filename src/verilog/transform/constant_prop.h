@@ -31,10 +31,18 @@
 #ifndef CASCADE_SRC_VERILOG_TRANSFORM_CONSTANT_PROP_H
 #define CASCADE_SRC_VERILOG_TRANSFORM_CONSTANT_PROP_H
 
+#include <cstddef>
+#include "src/verilog/ast/ast.h"
 #include "src/verilog/ast/visitors/rewriter.h"
+#include "src/verilog/ast/visitors/visitor.h"
 
 namespace cascade {
 
+// This class folds constant expressions and branches, and strength reduces
+// arithmetic on powers of two (multiplies and divides become shifts, mods
+// become masks). Rewrites which would change the self-determined width or
+// sign of an expression are never performed.
+
 class ConstantProp : public Rewriter {
   public:
     ConstantProp();
@@ -43,6 +51,19 @@ class ConstantProp : public Rewriter {
     void run(ModuleDeclaration* md);
 
   private:
+    // Folding Helpers:
+    Expression* fold(Expression* e);
+    Statement* collapse(Statement* s, Statement* res);
+
+    // Strength Reduction Helpers:
+    Expression* reduce(BinaryExpression* be);
+    Expression* replace(BinaryExpression* be, bool lhs, BinaryExpression::Op op, Number* n);
+    Expression* forward(BinaryExpression* be, bool lhs);
+    bool self_determine(const Expression* e, size_t* w, bool* s);
+    int log2(const Bits& b);
+    bool is_zero(const Bits& b);
+    bool is_ones(const Bits& b);
+
     Expression* rewrite(BinaryExpression* be) override;
     Expression* rewrite(ConditionalExpression* ce) override;
     Expression* rewrite(NestedExpression* ne) override;
@@ -51,7 +72,7 @@ class ConstantProp : public Rewriter {
     Expression* rewrite(MultipleConcatenation* mc) override;
     Expression* rewrite(RangeExpression* re) override;
     Expression* rewrite(UnaryExpression* ue) override;
-    // TODO: Add support for constexpr evaluating case statements
+    Statement* rewrite(CaseStatement* cs) override;
     Statement* rewrite(ConditionalStatement* cs) override;
 };
 
@@ -0,0 +1,262 @@
+// Copyright 2017-2018 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "src/base/bits/bits.h"
+#include "src/base/bits/fixed_bits.h"
+
+using namespace cascade;
+using namespace std;
+
+namespace {
+
+// Returns a fixed set of values of width n: the corner cases for signed and
+// unsigned arithmetic, single bits on either side of each word boundary, and
+// a few pseudo-random values.
+vector<Bits> values(size_t n, bool s) {
+  vector<Bits> res;
+  const auto bit = [n, s](size_t i) {
+    Bits b(n, 0);
+    b.set_signed(s);
+    return b.set(i, true);
+  };
+
+  Bits zero(n, 0);
+  zero.set_signed(s);
+  res.push_back(zero);
+  res.push_back(bit(0));
+
+  auto ones = zero;
+  for (size_t i = 0; i < n; ++i) {
+    ones.set(i, true);
+  }
+  res.push_back(ones);
+  res.push_back(bit(n-1));
+  auto max = ones;
+  res.push_back(max.set(n-1, false));
+
+  for (auto i : {31, 32, 63, 64}) {
+    if (size_t(i) < n) {
+      res.push_back(bit(i));
+    }
+  }
+
+  mt19937 gen(n);
+  for (size_t i = 0; i < 8; ++i) {
+    auto r = zero;
+    for (size_t j = 0; j < n; ++j) {
+      r.set(j, gen() & 1);
+    }
+    res.push_back(r);
+  }
+  return res;
+}
+
+string str(const Bits& b) {
+  stringstream ss;
+  b.write(ss, 16);
+  return ss.str();
+}
+
+template <size_t W, bool S>
+void check_arithmetic() {
+  const auto vs = values(W, S);
+  for (const auto& a : vs) {
+    for (const auto& b : vs) {
+      const FixedBits<W, S> fa(a);
+      const FixedBits<W, S> fb(b);
+      FixedBits<W, S> fr;
+      Bits br(W, 0);
+      br.set_signed(S);
+
+      fa.arithmetic_plus(fb, fr);
+      a.arithmetic_plus(b, br);
+      EXPECT_EQ(str(fr.to_bits()), str(br)) << str(a) << " + " << str(b);
+      fa.arithmetic_minus(fb, fr);
+      a.arithmetic_minus(b, br);
+      EXPECT_EQ(str(fr.to_bits()), str(br)) << str(a) << " - " << str(b);
+      fa.arithmetic_multiply(fb, fr);
+      a.arithmetic_multiply(b, br);
+      EXPECT_EQ(str(fr.to_bits()), str(br)) << str(a) << " * " << str(b);
+      fa.arithmetic_divide(fb, fr);
+      a.arithmetic_divide(b, br);
+      EXPECT_EQ(str(fr.to_bits()), str(br)) << str(a) << " / " << str(b);
+      fa.arithmetic_mod(fb, fr);
+      a.arithmetic_mod(b, br);
+      EXPECT_EQ(str(fr.to_bits()), str(br)) << str(a) << " % " << str(b);
+
+      EXPECT_EQ(fa < fb, a < b) << str(a) << " < " << str(b);
+      EXPECT_EQ(fa == fb, a == b) << str(a) << " == " << str(b);
+    }
+
+    const FixedBits<W, S> fa(a);
+    FixedBits<W, S> fr;
+    Bits br(W, 0);
+    br.set_signed(S);
+    fa.arithmetic_minus(fr);
+    a.arithmetic_minus(br);
+    EXPECT_EQ(str(fr.to_bits()), str(br)) << "-" << str(a);
+
+    // Exponents are kept small so that Bits doesn't spend all day on them
+    for (size_t e = 0; e < 4; ++e) {
+      Bits be(W, e);
+      be.set_signed(S);
+      fa.arithmetic_pow(FixedBits<W, S>(be), fr);
+      a.arithmetic_pow(be, br);
+      EXPECT_EQ(str(fr.to_bits()), str(br)) << str(a) << " ** " << e;
+    }
+  }
+}
+
+template <size_t W, bool S>
+void check_shifts() {
+  for (const auto& a : values(W, S)) {
+    const FixedBits<W, S> fa(a);
+    for (auto samt : {size_t(0), size_t(1), W-1, W, W+1, size_t(31), size_t(32), size_t(33), size_t(63), size_t(64), size_t(65)}) {
+      const Bits bs(32, samt);
+      FixedBits<W, S> fr;
+      Bits br(W, 0);
+      br.set_signed(S);
+
+      fa.bitwise_sll(samt, fr);
+      a.bitwise_sll(bs, br);
+      EXPECT_EQ(str(fr.to_bits()), str(br)) << str(a) << " << " << samt;
+      fa.bitwise_sal(samt, fr);
+      a.bitwise_sal(bs, br);
+      EXPECT_EQ(str(fr.to_bits()), str(br)) << str(a) << " <<< " << samt;
+      fa.bitwise_slr(samt, fr);
+      a.bitwise_slr(bs, br);
+      EXPECT_EQ(str(fr.to_bits()), str(br)) << str(a) << " >> " << samt;
+      fa.bitwise_sar(samt, fr);
+      a.bitwise_sar(bs, br);
+      EXPECT_EQ(str(fr.to_bits()), str(br)) << str(a) << " >>> " << samt;
+    }
+  }
+}
+
+// Assigns values of width W to values of width W2 (extending or truncating)
+// both by converting from Bits and by assigning from another FixedBits.
+template <size_t W, size_t W2, bool S>
+void check_resize() {
+  for (const auto& a : values(W, S)) {
+    Bits br(W2, 0);
+    br.assign(a);
+
+    const FixedBits<W2, false> fr1(a);
+    EXPECT_EQ(str(fr1.to_bits()), str(br)) << str(a);
+
+    FixedBits<W2, false> fr2;
+    fr2.assign(FixedBits<W, S>(a));
+    EXPECT_EQ(str(fr2.to_bits()), str(br)) << str(a);
+
+    Bits bw(1, 0);
+    FixedBits<W, S>(a).write(bw);
+    EXPECT_EQ(bw.size(), W);
+    EXPECT_EQ(bw.is_signed(), S);
+    EXPECT_EQ(str(bw), str(a));
+  }
+}
+
+} // namespace
+
+TEST(bits, fixed_arithmetic_unsigned) {
+  check_arithmetic<1, false>();
+  check_arithmetic<31, false>();
+  check_arithmetic<32, false>();
+  check_arithmetic<33, false>();
+  check_arithmetic<63, false>();
+  check_arithmetic<64, false>();
+  check_arithmetic<65, false>();
+  check_arithmetic<128, false>();
+}
+TEST(bits, fixed_arithmetic_signed) {
+  check_arithmetic<1, true>();
+  check_arithmetic<31, true>();
+  check_arithmetic<32, true>();
+  check_arithmetic<33, true>();
+  check_arithmetic<63, true>();
+  check_arithmetic<64, true>();
+  check_arithmetic<65, true>();
+  check_arithmetic<128, true>();
+}
+TEST(bits, fixed_shift_unsigned) {
+  check_shifts<1, false>();
+  check_shifts<31, false>();
+  check_shifts<32, false>();
+  check_shifts<33, false>();
+  check_shifts<63, false>();
+  check_shifts<64, false>();
+  check_shifts<65, false>();
+  check_shifts<128, false>();
+}
+TEST(bits, fixed_shift_signed) {
+  check_shifts<1, true>();
+  check_shifts<31, true>();
+  check_shifts<32, true>();
+  check_shifts<33, true>();
+  check_shifts<63, true>();
+  check_shifts<64, true>();
+  check_shifts<65, true>();
+  check_shifts<128, true>();
+}
+TEST(bits, fixed_sign_extend) {
+  check_resize<1, 32, true>();
+  check_resize<31, 32, true>();
+  check_resize<32, 33, true>();
+  check_resize<33, 64, true>();
+  check_resize<63, 64, true>();
+  check_resize<64, 65, true>();
+  check_resize<65, 128, true>();
+  check_resize<32, 128, true>();
+}
+TEST(bits, fixed_zero_extend) {
+  check_resize<1, 32, false>();
+  check_resize<31, 32, false>();
+  check_resize<32, 33, false>();
+  check_resize<33, 64, false>();
+  check_resize<63, 64, false>();
+  check_resize<64, 65, false>();
+  check_resize<65, 128, false>();
+  check_resize<32, 128, false>();
+}
+TEST(bits, fixed_truncate) {
+  check_resize<32, 31, false>();
+  check_resize<33, 32, true>();
+  check_resize<64, 63, false>();
+  check_resize<65, 64, true>();
+  check_resize<65, 33, false>();
+  check_resize<128, 65, true>();
+  check_resize<128, 64, false>();
+  check_resize<128, 1, true>();
+}
@@ -0,0 +1,59 @@
+// Copyright 2017-2018 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "gtest/gtest.h"
+#include "test/harness.h"
+
+using namespace cascade;
+
+TEST(de10, pass_loops_1) {
+  run_synth_check("data/test/de10/pass/loops_1.v", false);
+}
+TEST(de10, fail_delay_1) {
+  run_synth_check("data/test/de10/fail/delay_1.v", true);
+}
+TEST(de10, fail_for_1) {
+  run_synth_check("data/test/de10/fail/for_1.v", true);
+}
+TEST(de10, fail_for_2) {
+  run_synth_check("data/test/de10/fail/for_2.v", true);
+}
+TEST(de10, fail_for_3) {
+  run_synth_check("data/test/de10/fail/for_3.v", true);
+}
+TEST(de10, fail_repeat_1) {
+  run_synth_check("data/test/de10/fail/repeat_1.v", true);
+}
+TEST(de10, fail_repeat_2) {
+  run_synth_check("data/test/de10/fail/repeat_2.v", true);
+}
+TEST(de10, fail_while_1) {
+  run_synth_check("data/test/de10/fail/while_1.v", true);
+}
@@ -36,6 +36,8 @@
 #include "src/base/system/system.h"
 #include "src/runtime/runtime.h"
 #include "src/target/compiler.h"
+#include "src/target/core/de10/de10_compiler.h"
+#include "src/target/core/native/native_compiler.h"
 #include "src/target/core/proxy/proxy_compiler.h"
 #include "src/target/core/sw/sw_compiler.h"
 #include "src/target/interface/local/local_compiler.h"
@@ -81,11 +83,13 @@ void run_parse(const string& path, bool expected) {
 void run_typecheck(const string& march, const string& path, bool expected) {
   EView view;
   Runtime runtime(&view);
+  auto nc = new NativeCompiler();
   auto pc = new ProxyCompiler();
   auto sc = new SwCompiler();
   auto lc = new LocalCompiler();
     lc->set_runtime(&runtime);
   auto c = new Compiler();
+    c->set_native_compiler(nc);
     c->set_proxy_compiler(pc);
     c->set_sw_compiler(sc);
     c->set_local_compiler(lc);
@@ -109,15 +113,24 @@ void run_typecheck(const string& march, const string& path, bool expected) {
   EXPECT_EQ(view.error(), expected);
 }
 
-void run_code(const string& march, const string& path, const string& expected) {
+// Runs a program to completion and captures everything that it prints. This
+// is the body shared by the harnesses below, which differ only in how the
+// runtime is configured. If stats is non-null, the native compiler's
+// statistics are copied there once the program is done.
+static void run_sim(const string& march, const string& path, size_t sim_threads, bool levelized, bool inline_all, string* res, NativeCompiler::Stats* stats) {
   stringstream ss;
   PView view(ss);
   Runtime runtime(&view);
+    runtime.set_sim_threads(sim_threads);
+    runtime.disable_inlining(!inline_all);
+  auto nc = new NativeCompiler();
   auto pc = new ProxyCompiler();
   auto sc = new SwCompiler();
+    sc->set_levelized(levelized);
   auto lc = new LocalCompiler();
     lc->set_runtime(&runtime);
   auto c = new Compiler();
+    c->set_native_compiler(nc);
     c->set_proxy_compiler(pc);
     c->set_sw_compiler(sc);
     c->set_local_compiler(lc);
@@ -133,7 +146,69 @@ void run_code(const string& march, const string& path, const string& expected) {
   StreamController(&runtime, ifs).run_to_completion();
 
   runtime.wait_for_stop();
-  EXPECT_EQ(ss.str(), expected);
+  *res = ss.str();
+  if (stats != nullptr) {
+    *stats = nc->get_stats();
+  }
+}
+
+void run_code(const string& march, const string& path, const string& expected) {
+  string res;
+  run_sim(march, path, 1, false, true, &res, nullptr);
+  EXPECT_EQ(res, expected);
+}
+
+void run_native(const string& march, const string& path, const string& expected) {
+  // Compilation errors fall back to software, which produces the same output.
+  // Make sure that native code actually ran.
+  string res;
+  NativeCompiler::Stats stats;
+  run_sim(march, path, 1, false, true, &res, &stats);
+  EXPECT_EQ(res, expected);
+  EXPECT_GT(stats.native, 0u);
+  EXPECT_EQ(stats.fallback, 0u);
+}
+
+void run_native_jit(const string& march, const string& path, const string& expected) {
+  // Same as above, except that the program may finish before the native
+  // code is ready. It still mustn't fall back to software.
+  string res;
+  NativeCompiler::Stats stats;
+  run_sim(march, path, 1, false, true, &res, &stats);
+  EXPECT_EQ(res, expected);
+  EXPECT_EQ(stats.fallback, 0u);
+}
+
+void run_levelized(const string& march, const string& path, const string& expected) {
+  string res;
+  run_sim(march, path, 1, true, true, &res, nullptr);
+  EXPECT_EQ(res, expected);
+}
+
+void run_threaded(const string& march, const string& path, const string& expected) {
+  // Run once serially and once with a pool of simulation threads. Inlining is
+  // disabled so that every module gets its own engine, otherwise there's
+  // nothing to evaluate in parallel. Both runs have to agree byte for byte.
+  string serial;
+  run_sim(march, path, 1, false, false, &serial, nullptr);
+  EXPECT_EQ(serial, expected);
+  string threaded;
+  run_sim(march, path, 4, false, false, &threaded, nullptr);
+  EXPECT_EQ(threaded, serial);
+}
+
+void run_synth_check(const string& path, bool expected) {
+  ifstream ifs(path);
+  ASSERT_TRUE(ifs.is_open());
+
+  Parser p;
+  auto res = p.parse(ifs);
+  ASSERT_FALSE(p.get_log().error());
+  auto md = dynamic_cast<ModuleDeclaration*>(res.first);
+  ASSERT_TRUE(md != nullptr);
+
+  EXPECT_EQ(!De10Compiler::SynthCheck().check(md), expected);
+  delete md;
 }
 
 void run_bitcoin(const string& march, const string& path, const string& expected) {
@@ -146,11 +221,13 @@ void run_mips(const string& march, const string& path, const string& expected) {
   stringstream ss;
   PView view(ss);
   Runtime runtime(&view);
+  auto nc = new NativeCompiler();
   auto pc = new ProxyCompiler();
   auto sc = new SwCompiler();
   auto lc = new LocalCompiler();
     lc->set_runtime(&runtime);
   auto c = new Compiler();
+    c->set_native_compiler(nc);
     c->set_proxy_compiler(pc);
     c->set_sw_compiler(sc);
     c->set_local_compiler(lc);
@@ -177,11 +254,13 @@ void run_regex(const string& march, const string& regex, const string& input, co
   stringstream ss;
   PView view(ss);
   Runtime runtime(&view);
+  auto nc = new NativeCompiler();
   auto pc = new ProxyCompiler();
   auto sc = new SwCompiler();
   auto lc = new LocalCompiler();
     lc->set_runtime(&runtime);
   auto c = new Compiler();
+    c->set_native_compiler(nc);
     c->set_proxy_compiler(pc);
     c->set_sw_compiler(sc);
     c->set_local_compiler(lc);
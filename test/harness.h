@@ -66,6 +66,11 @@ class EView : public View {
 void run_parse(const std::string& path, bool expected);
 void run_typecheck(const std::string& march, const std::string& path, bool expected);
 void run_code(const std::string& march, const std::string& path, const std::string& expected);
+void run_native(const std::string& march, const std::string& path, const std::string& expected);
+void run_native_jit(const std::string& march, const std::string& path, const std::string& expected);
+void run_levelized(const std::string& march, const std::string& path, const std::string& expected);
+void run_threaded(const std::string& march, const std::string& path, const std::string& expected);
+void run_synth_check(const std::string& path, bool expected);
 
 // Benchmark harnesses:
 void run_bitcoin(const std::string& march, const std::string& path, const std::string& expected);
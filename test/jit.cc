@@ -36,6 +36,9 @@ using namespace cascade;
 TEST(jit, initial) {
   run_code("minimal_jit", "data/test/jit/initial.v", "once");
 }
+TEST(jit, delay_1) {
+  run_code("minimal_jit", "data/test/jit/delay_1.v", "1000");
+}
 TEST(jit, pipeline_1) {
   run_code("minimal_jit", "data/test/simple/pipeline_1.v", "0123456789");
 }
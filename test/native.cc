@@ -0,0 +1,68 @@
+// Copyright 2017-2018 VMware, Inc.
+// SPDX-License-Identifier: BSD-2-Clause
+//
+// The BSD-2 license (the License) set forth below applies to all parts of the
+// Cascade project.  You may not use this file except in compliance with the
+// License.
+//
+// BSD-2 License
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+// list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+// this list of conditions and the following disclaimer in the documentation
+// and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS AS IS AND
+// ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+// WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include "gtest/gtest.h"
+#include "test/harness.h"
+
+using namespace cascade;
+
+TEST(native, initial) {
+  run_native("native", "data/test/jit/initial.v", "once");
+}
+TEST(native, arithmetic_wide_1) {
+  run_native("native", "data/test/simple/arithmetic_wide_1.v", "77b6166d089f54ea5df49945e86e73dc02e8dfe8012b66b2f29af440c983ee20");
+}
+TEST(native, array_3) {
+  run_native("native", "data/test/simple/array_3.v", "10");
+}
+TEST(native, case_3) {
+  run_native("native", "data/test/simple/case_3.v", "123");
+}
+TEST(native, case_4) {
+  run_native("native", "data/test/simple/case_4.v", "beik");
+}
+TEST(native, case_5) {
+  run_native("native", "data/test/simple/case_5.v", "acfilmp");
+}
+TEST(native, pipeline_1) {
+  run_native("native", "data/test/simple/pipeline_1.v", "0123456789");
+}
+TEST(native, pipeline_2) {
+  run_native("native", "data/test/simple/pipeline_2.v", "0123456789");
+}
+TEST(native, bitcoin_1) {
+  run_native("native", "data/test/bitcoin/bitcoin_1.v", "44420006\nccca888e\n999abbb8\ndddefffc\n");
+}
+TEST(native, jit_pipeline_1) {
+  run_native_jit("native_jit", "data/test/simple/pipeline_1.v", "0123456789");
+}
+TEST(native, jit_bitcoin) {
+  run_native_jit("native_jit", "data/test/bitcoin/bitcoin_9.v", "f 93");
+}
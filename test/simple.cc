@@ -51,6 +51,18 @@ TEST(simple, arithmetic_plus) {
 TEST(simple, arithmetic_pow) {
   run_code("minimal","data/test/simple/arithmetic_pow.v", "16"); 
 }
+TEST(simple, arithmetic_wide_1) {
+  run_code("minimal","data/test/simple/arithmetic_wide_1.v", "77b6166d089f54ea5df49945e86e73dc02e8dfe8012b66b2f29af440c983ee20"); 
+}
+TEST(simple, arithmetic_wide_2) {
+  run_code("minimal","data/test/simple/arithmetic_wide_2.v", "4fdd5a52fed0b0c211f71a8b5606e22"); 
+}
+TEST(simple, arithmetic_wide_3) {
+  run_code("minimal","data/test/simple/arithmetic_wide_3.v", "2f7832dd5da28afe417cd9865b7dfc7da"); 
+}
+TEST(simple, arithmetic_wide_4) {
+  run_code("minimal","data/test/simple/arithmetic_wide_4.v", "c21a937a76f3432ffd73d97e447606b683ecf6f6e4a7ae225bfaff1eaaf8b0a1"); 
+}
 TEST(simple, array_1) {
   run_code("minimal","data/test/simple/array_1.v", "0123");
 }
@@ -84,6 +96,12 @@ TEST(simple, assign_6) {
 TEST(simple, assign_7) {
   run_code("minimal","data/test/simple/assign_7.v", "170");
 }
+TEST(simple, assign_8) {
+  run_code("minimal","data/test/simple/assign_8.v", "f30 3c 6 0 1 1e20 3c 9 0 0 3c10 2d 0 0 0 7800 78 e 3 1 f0f0 f b 4 0 e0e0 e 6 5 0 ");
+}
+TEST(simple, assign_9) {
+  run_code("minimal","data/test/simple/assign_9.v", "12 23 34 45 ");
+}
 TEST(simple, bitwise_and) {
   run_code("minimal","data/test/simple/bitwise_and.v", "1");
 }
@@ -105,6 +123,9 @@ TEST(simple, bitwise_not) {
 TEST(simple, bitwise_xor) {
   run_code("minimal","data/test/simple/bitwise_xor.v", "6");
 }
+TEST(simple, bitwise_wide_1) {
+  run_code("minimal","data/test/simple/bitwise_wide_1.v", "33661768a5aa88ae00000091f13171310e3d685bc2f1a49773c4aa46e280ded1 b72e8261d950c843c78b4f12d69a5e21e5a96d30f4b87c000000000000000000 37ab6fbbf2bfaeaf8048d159e26af37b 0");
+}
 TEST(simple, case_1) {
   run_code("minimal","data/test/simple/case_1.v", "yes");
 }
@@ -114,6 +135,12 @@ TEST(simple, case_2) {
 TEST(simple, case_3) {
   run_code("minimal","data/test/simple/case_3.v", "123");
 }
+TEST(simple, case_4) {
+  run_code("minimal","data/test/simple/case_4.v", "beik");
+}
+TEST(simple, case_5) {
+  run_code("minimal","data/test/simple/case_5.v", "acfilmp");
+}
 TEST(simple, concat_1) {
   run_code("minimal","data/test/simple/concat_1.v", "170");
 }
@@ -126,6 +153,21 @@ TEST(simple, concat_3) {
 TEST(simple, cond_1) {
   run_code("minimal","data/test/simple/cond_1.v", "123");
 }
+TEST(simple, constant_1) {
+  run_code("minimal","data/test/simple/constant_1.v", "4c 24c 12 3 fe 93 fd f4 2");
+}
+TEST(simple, delay_1) {
+  run_code("minimal","data/test/simple/delay_1.v", "1234");
+}
+TEST(simple, delay_2) {
+  run_code("minimal","data/test/simple/delay_2.v", "2456");
+}
+TEST(simple, delay_3) {
+  run_code("minimal","data/test/simple/delay_3.v", "12");
+}
+TEST(simple, delay_4) {
+  run_code("minimal","data/test/simple/delay_4.v", "1234");
+}
 TEST(simple, fifo_1) {
   run_code("minimal","data/test/simple/fifo_1.v", "1000000001100200300410");
 }
@@ -144,9 +186,12 @@ TEST(simple, fifo_5) {
 TEST(simple, finish_1) {
   run_code("minimal","data/test/simple/finish_1.v", "Hello World");
 }
-//TEST(simple, for_1) {
-//  run_code("minimal","data/test/simple/for_1.v", "333");
-//}
+TEST(simple, for_1) {
+  run_code("minimal","data/test/simple/for_1.v", "333");
+}
+TEST(simple, for_2) {
+  run_code("minimal","data/test/simple/for_2.v", "120012");
+}
 TEST(simple, generate_1) {
   run_code("minimal","data/test/simple/generate_1.v", "01234567");
 }
@@ -180,6 +225,15 @@ TEST(simple, issue_20a) {
 TEST(simple, issue_228) {
   run_code("minimal","data/test/simple/issue_228.v", "");
 }
+TEST(simple, levelize_1) {
+  run_code("minimal","data/test/simple/levelize_1.v", "989496");
+}
+TEST(simple, levelize_2) {
+  run_levelized("minimal","data/test/simple/levelize_1.v", "989496");
+}
+TEST(simple, levelize_3) {
+  run_levelized("minimal","data/test/simple/pipeline_1.v", "0123456789");
+}
 TEST(simple, logical_and) {
   run_code("minimal","data/test/simple/logical_and.v", "011");
 }
@@ -213,6 +267,12 @@ TEST(simple, mem_1) {
 TEST(simple, mem_2) {
   run_code("minimal","data/test/simple/mem_2.v", "01234567");
 }
+TEST(simple, negedge_1) {
+  run_code("minimal","data/test/simple/negedge_1.v", "43");
+}
+TEST(simple, negedge_2) {
+  run_code("minimal","data/test/simple/negedge_2.v", "3");
+}
 TEST(simple, nested_1) {
   run_code("minimal","data/test/simple/nested_1.v", "8");
 }
@@ -225,6 +285,52 @@ TEST(simple, nonblock_2) {
 TEST(simple, nonblock_3) {
   run_code("minimal","data/test/simple/nonblock_3.v", "0 1 2 4 8 ");
 }
+TEST(simple, nonblock_4) {
+  run_code("minimal","data/test/simple/nonblock_4.v", "0 0 8 0 9 8 10 9 ");
+}
+TEST(simple, parallel_1) {
+  run_threaded("minimal","data/test/simple/parallel_1.v", "|00102030|01112131|02122232|03132333|04142434|05152535|06162636|");
+}
+TEST(simple, parallel_2) {
+  run_threaded("minimal","data/test/simple/mem_1.v", "0011223344556677");
+}
+TEST(simple, parallel_3) {
+  run_threaded("minimal","data/test/simple/mem_2.v", "01234567");
+}
+TEST(simple, parallel_4) {
+  run_threaded("minimal","data/test/simple/fifo_1.v", "1000000001100200300410");
+}
+TEST(simple, parallel_5) {
+  run_threaded("minimal","data/test/simple/fifo_2.v", "1001110");
+}
+TEST(simple, parallel_6) {
+  run_threaded("minimal","data/test/simple/fifo_3.v", "1001101201301410");
+}
+TEST(simple, parallel_7) {
+  run_threaded("minimal","data/test/simple/fifo_4.v", "45");
+}
+TEST(simple, parallel_8) {
+  run_threaded("minimal","data/test/simple/fifo_5.v", "90");
+}
+TEST(simple, parallel_9) {
+  std::string expected;
+  for (size_t i = 0; i < 10000; ++i) {
+    expected += "0123456789";
+  }
+  run_threaded("minimal","data/test/simple/write_1.v", expected + "done");
+}
+TEST(simple, parallel_10) {
+  run_threaded("minimal","data/test/simple/pipeline_1.v", "0123456789");
+}
+TEST(simple, parallel_11) {
+  run_threaded("minimal","data/test/simple/pipeline_2.v", "0123456789");
+}
+TEST(simple, parallel_12) {
+  run_threaded("minimal","data/test/simple/assign_9.v", "00 01 11 12 22 23 33 34 44 45 ");
+}
+TEST(simple, parallel_13) {
+  run_threaded("minimal","data/test/simple/parallel_2.v", "000 011 012 112 122 123 b 223 233 234 a b 334 344 345 a b 445 455 456 b ");
+}
 TEST(simple, pipeline_1) {
   run_code("minimal","data/test/simple/pipeline_1.v", "0123456789");
 }
@@ -261,12 +367,18 @@ TEST(simple, reduce_xor) {
 TEST(simple, reduce_xnor) {
   run_code("minimal","data/test/simple/reduce_xnor.v", "01");
 }
-//TEST(simple, repeat_1) {
-//  run_code("minimal","data/test/simple/repeat_1.v", "122");
-//}
-//TEST(simple, repeat_2) {
-//  run_code("minimal","data/test/simple/repeat_2.v", "666666");
-//}
+TEST(simple, repeat_1) {
+  run_code("minimal","data/test/simple/repeat_1.v", "122");
+}
+TEST(simple, repeat_2) {
+  run_code("minimal","data/test/simple/repeat_2.v", "666666");
+}
+TEST(simple, sensitivity_1) {
+  run_code("minimal","data/test/simple/sensitivity_1.v", "756");
+}
+TEST(simple, sensitivity_2) {
+  run_levelized("minimal","data/test/simple/sensitivity_1.v", "756");
+}
 TEST(simple, sign_1) {
   run_code("minimal","data/test/simple/sign_1.v", "-41431655761-416553221841143165576165532-41");
 }
@@ -276,6 +388,13 @@ TEST(simple, sign_2) {
 //TEST(simple, wait_1) {
 //  run_code("minimal","data/test/simple/wait_1.v", "Hello World");
 //}
-//TEST(simple, while_1) {
-//  run_code("minimal","data/test/simple/while_1.v", "333");
-//}
+TEST(simple, while_1) {
+  run_code("minimal","data/test/simple/while_1.v", "333");
+}
+TEST(simple, write_1) {
+  std::string expected;
+  for (size_t i = 0; i < 10000; ++i) {
+    expected += "0123456789";
+  }
+  run_code("minimal","data/test/simple/write_1.v", expected + "done");
+}
@@ -40,6 +40,7 @@
 #include "src/runtime/runtime.h"
 #include "src/target/compiler.h"
 #include "src/target/core/de10/de10_compiler.h"
+#include "src/target/core/native/native_compiler.h"
 #include "src/target/core/proxy/proxy_compiler.h"
 #include "src/target/core/sw/sw_compiler.h"
 #include "src/target/interface/local/local_compiler.h"
@@ -60,7 +61,7 @@ auto& input_path = StrArg<string>::create("-e")
   .usage("path/to/file.v")
   .description("Read input from file");
 auto& march = StrArg<string>::create("--march")
-  .usage("minimal|minimal_jit|sw|de10|de10_jit")
+  .usage("minimal|minimal_jit|native|native_jit|sw|de10|de10_jit")
   .description("Target architecture")
   .initial("minimal");
 auto& ui = StrArg<string>::create("--ui")
@@ -98,7 +99,13 @@ auto& quartus_port = StrArg<uint32_t>::create("--quartus_port")
   .description("Location of quartus server")
   .initial(9900);
 
-__attribute__((unused)) auto& g4 = Group::create("Logging Options");
+__attribute__((unused)) auto& g4 = Group::create("Native Compiler Options");
+auto& native_cxx = StrArg<string>::create("--native_cxx")
+  .usage("<path>")
+  .description("Host c++ compiler to use for native code generation")
+  .initial("c++");
+
+__attribute__((unused)) auto& g5 = Group::create("Logging Options");
 auto& profile_interval = StrArg<int>::create("--profile_interval")
   .usage("<n>")
   .description("Number of seconds to wait between profiling events; setting n to zero disables profiling")
@@ -108,13 +115,19 @@ auto& batch = FlagArg::create("--batch")
 auto& enable_logging = FlagArg::create("--enable_logging")
   .description("Turns on UI logging");
 
-__attribute__((unused)) auto& g5 = Group::create("Optimization Options");
+__attribute__((unused)) auto& g6 = Group::create("Optimization Options");
 auto& open_loop_target = StrArg<size_t>::create("--open_loop_target")
   .usage("<n>")
-  .description("Maximum number of seconds to run in open loop for before transferring control back to runtime")
+  .description("Target number of microseconds to run in open loop for before transferring control back to runtime")
+  .initial(1000);
+auto& sim_threads = StrArg<size_t>::create("--sim_threads")
+  .usage("<n>")
+  .description("Number of threads to use when evaluating independent engines in parallel")
   .initial(1);
+auto& sw_levelized = FlagArg::create("--sw_levelized")
+  .description("Schedule combinational logic in software by level rather than by events");
 
-__attribute__((unused)) auto& g6 = Group::create("Warnings and Errors");
+__attribute__((unused)) auto& g7 = Group::create("Warnings and Errors");
 auto& disable_warnings = FlagArg::create("--disable_warnings")
   .description("Turn of warnings");
 
@@ -195,13 +208,17 @@ int main(int argc, char** argv) {
   auto dc = new De10Compiler();
     dc->set_host(quartus_host.value());
     dc->set_port(quartus_port.value());
+  auto nc = new NativeCompiler();
+    nc->set_cxx(native_cxx.value());
   auto pc = new ProxyCompiler();
   auto sc = new SwCompiler();
     sc->set_include_dirs(inc_dirs.value() + ":" + System::src_root());
+    sc->set_levelized(sw_levelized.value());
   auto lc = new LocalCompiler();
     lc->set_runtime(runtime);
   auto c = new Compiler();
     c->set_de10_compiler(dc);
+    c->set_native_compiler(nc);
     c->set_proxy_compiler(pc);
     c->set_sw_compiler(sc);
     c->set_local_compiler(lc);
@@ -210,6 +227,7 @@ int main(int argc, char** argv) {
   runtime->set_compiler(c);
     runtime->set_include_dirs(inc_dirs.value() + ":" + System::src_root());
     runtime->set_open_loop_target(open_loop_target.value());
+    runtime->set_sim_threads(sim_threads.value());
     //runtime->disable_inlining(disable_inlining.value());
     runtime->disable_warnings(disable_warnings.value());
   runtime->run();